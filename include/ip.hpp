@@ -6,11 +6,22 @@
 #pragma once
 
 #include "ip/net/common.hpp"
+#include "ip/net/bufferpool.hpp"
+#include "ip/net/runtime.hpp"
+#include "ip/net/sendqueue.hpp"
+#include "ip/net/timerwheel.hpp"
+#include "ip/net/framing.hpp"
+#include "ip/net/registry.hpp"
+#include "ip/net/admission.hpp"
+#include "ip/net/resolver.hpp"
+#include "ip/net/connector.hpp"
+#include "ip/net/handoff.hpp"
 
 #include "ip/udp/udpclient.hpp"
 #include "ip/udp/udpserver.hpp"
 
 #include "ip/tcp/tcpclient.hpp"
+#include "ip/tcp/tcpclientpool.hpp"
 #include "ip/tcp/tcpserver.hpp"
 #include "ip/tcp/tcpremote.hpp"
 
@@ -12,9 +12,41 @@ namespace internetprotocol {
     class http_client_c {
     public:
         http_client_c() {
-            idle_timer = std::make_unique<asio::steady_timer>(net.context);
         }
 
+        /**
+         * Construct the client on a shared io_context instead of a private one.
+         * No runtime thread is reserved for this client, the owner of 'io_context' is responsible
+         * for running it, so many clients can be multiplexed over a few threads. Handlers of the
+         * client are serialized on its own strand.
+         * Keep the client alive until 'io_context' has run the handlers cancelled by 'close()'.
+         *
+         * @param io_context Shared io_context used by the socket, resolver and timers.
+         *
+         * @par Example
+         * @code
+         * asio::io_context io_context;
+         * http_client_c client(io_context);
+         * client.set_host({"localhost", "8080", v4});
+         * io_context.run();
+         * @endcode
+         */
+        explicit http_client_c(asio::io_context &io_context): net(io_context) {
+        }
+
+        /**
+         * Construct the client on the io_context of a runtime, see the io_context constructor.
+         *
+         * @param runtime Runtime whose threads run the client handlers. Must outlive the client.
+         *
+         * @par Example
+         * @code
+         * runtime_c runtime({ 2, "client" });
+         * http_client_c client(runtime);
+         * @endcode
+         */
+        explicit http_client_c(runtime_c &runtime): http_client_c(runtime.context()) {}
+
         ~http_client_c() {
             if (net.socket.is_open())
                 close();
@@ -87,14 +119,22 @@ namespace internetprotocol {
          */
         void request(const http_request_t &req,
                      const std::function<void(const asio::error_code &, const http_response_t &)> &response_cb) {
+            // Shared io_contexts never run out of work, so end the exchange here as run_context_thread would
+            const std::function<void(const asio::error_code &, const http_response_t &)> callback =
+                net.owned_context ? response_cb : [&, response_cb](const asio::error_code &ec, const http_response_t &res) {
+                    close();
+                    response_cb(ec, res);
+                };
+
             if (!net.socket.is_open()) {
-                net.resolver.async_resolve(bind_options.protocol == v4 ? tcp::v4() : tcp::v6(),
-                                           bind_options.address, bind_options.port,
-                                           [&, req, response_cb](const asio::error_code &ec,
-                                                                 const tcp::resolver::results_type &results) {
-                                               resolve(ec, results, req, response_cb);
-                                           });
-                asio::post(thread_pool, [&] { run_context_thread(); });
+                resolver_cache().async_resolve(net.resolver, resolve_protocol(bind_options.protocol),
+                                               bind_options.address, bind_options.port,
+                                               [&, req, callback](const asio::error_code &ec,
+                                                                  const tcp::resolver::results_type &results) {
+                                                   resolve(ec, results, req, callback);
+                                               }, bind_options.use_resolver_cache);
+                if (net.owned_context)
+                    asio::post(default_runtime().get_executor(), [&]{ run_context_thread(); });
                 return;
             }
 
@@ -104,11 +144,53 @@ namespace internetprotocol {
                 reset_idle_timer();
             asio::async_write(net.socket,
                               asio::buffer(payload.data(), payload.size()),
-                              [&, response_cb](const asio::error_code &ec, const size_t bytes_sent) {
-                                  write_cb(ec, bytes_sent, response_cb);
+                              [&, callback](const asio::error_code &ec, const size_t bytes_sent) {
+                                  write_cb(ec, bytes_sent, callback);
                               });
         }
 
+#ifdef ASIO_HAS_CO_AWAIT
+        /**
+         * Awaitable version of 'request()'.
+         *
+         * @param req Request data.
+         *
+         * @return A tuple with the error code and the response.
+         *
+         * @par Example
+         * @code
+         * http_client_c client;
+         * client.set_host({});
+         *
+         * auto [ec, res] = co_await client.async_request(req);
+         * if (!ec)
+         *      std::cout << res.status_code << " " << res.status_message << std::endl;
+         * @endcode
+         */
+        asio::awaitable<std::tuple<asio::error_code, http_response_t>> async_request(const http_request_t req) {
+            asio::error_code ec;
+            auto token = asio::redirect_error(asio::use_awaitable, ec);
+            http_response_t response = co_await asio::async_initiate<decltype(token), void(asio::error_code, http_response_t)>(
+                [this](auto handler, const http_request_t &request_data) {
+                    using handler_t = decltype(handler);
+                    std::shared_ptr<handler_t> shared_handler = std::make_shared<handler_t>(std::move(handler));
+                    std::shared_ptr<std::atomic<bool>> completed = std::make_shared<std::atomic<bool>>(false);
+                    request(request_data, [shared_handler, completed](const asio::error_code &error, const http_response_t &res) {
+                        // The response callback may fire again after a cancellation, resume the coroutine once
+                        if (completed->exchange(true))
+                            return;
+                        asio::post(asio::get_associated_executor(*shared_handler),
+                                   [shared_handler, error, res]() mutable {
+                                       std::move(*shared_handler)(error, std::move(res));
+                                   });
+                    });
+                },
+                token, req);
+            co_return std::make_tuple(ec, std::move(response));
+        }
+#endif
+
+
         /**
          * Close the underlying socket and stop listening for data on it. Also can be used to force cancel the request process.
          *
@@ -120,13 +202,16 @@ namespace internetprotocol {
          */
         void close() {
             is_closing.store(true);
+            connector.cancel();
             asio::error_code ec;
             if (net.socket.is_open()) {
                 net.socket.shutdown(tcp::socket::shutdown_both, ec);
                 net.socket.close(ec);
             }
-            net.context.stop();
-            net.context.restart();
+            if (net.owned_context) {
+                net.context.stop();
+                net.context.restart();
+            }
             net.endpoint = tcp::endpoint();
             is_closing.store(false);
         }
@@ -134,20 +219,17 @@ namespace internetprotocol {
     private:
         std::mutex mutex_io;
         std::atomic<bool> is_closing = false;
-        std::unique_ptr<asio::steady_timer> idle_timer;
         client_bind_options_t bind_options;
         tcp_client_t net;
-        asio::streambuf recv_buffer;
+        tcp_connector_c connector;
+        wheel_timer_c idle_timer{net.context, net.resolver.get_executor()};
+        pooled_streambuf_c recv_buffer{buffer_pool_c::get(net.socket.get_executor())};
 
         void start_idle_timer() {
             if (idle_timeout_seconds == 0)
                 return;
 
-            idle_timer->expires_after(std::chrono::seconds(idle_timeout_seconds));
-            idle_timer->async_wait([&](const asio::error_code &ec) {
-                if (ec == asio::error::operation_aborted)
-                    return;
-
+            idle_timer.start(std::chrono::seconds(idle_timeout_seconds), [&]() {
                 if (is_closing.load())
                     return;
 
@@ -159,13 +241,12 @@ namespace internetprotocol {
             if (is_closing.load() || idle_timeout_seconds == 0)
                 return;
 
-            idle_timer->cancel();
-            start_idle_timer();
+            idle_timer.refresh();
         }
 
         void run_context_thread() {
             std::lock_guard guard(mutex_io);
-            net.context.run();
+            run_context(net.context, bind_options.busy_poll_us);
             if (!is_closing.load())
                 close();
         }
@@ -179,11 +260,10 @@ namespace internetprotocol {
             }
 
             net.endpoint = results.begin()->endpoint();
-            asio::async_connect(net.socket,
-                                results,
-                                [&, req, response_cb](const asio::error_code &ec, const tcp::endpoint &ep) {
-                                    conn(ec, req, response_cb);
-                                });
+            connector.async_connect(net.socket, results, std::chrono::milliseconds(bind_options.connect_attempt_delay_ms),
+                                    [&, req, response_cb](const asio::error_code &ec, const tcp::endpoint &ep) {
+                                        conn(ec, req, response_cb);
+                                    });
         }
 
         void conn(const asio::error_code &error, const http_request_t &req,
@@ -193,6 +273,9 @@ namespace internetprotocol {
                 return;
             }
 
+            set_busy_poll(net.socket, bind_options.so_busy_poll_us);
+            set_socket_options(net.socket, bind_options.socket_options);
+
             std::string payload = prepare_request(req, net.socket.remote_endpoint().address().to_string(),
                                                   net.socket.remote_endpoint().port());
             if (idle_timeout_seconds > 0)
@@ -216,7 +299,7 @@ namespace internetprotocol {
             if (idle_timeout_seconds > 0)
                 reset_idle_timer();
             asio::async_read_until(net.socket,
-                                   recv_buffer, "\r\n",
+                                   recv_buffer.dynamic(), "\r\n",
                                    [&, response_cb](const asio::error_code &ec, const size_t bytes_received) {
                                        read_cb(ec, bytes_received, response_cb);
                                    });
@@ -262,7 +345,7 @@ namespace internetprotocol {
             }
 
             asio::async_read_until(net.socket,
-                                   recv_buffer, "\r\n\r\n",
+                                   recv_buffer.dynamic(), "\r\n\r\n",
                                    std::bind(&http_client_c::read_headers,
                                              this, asio::placeholders::error,
                                              response,
@@ -296,48 +379,43 @@ namespace internetprotocol {
     class http_client_ssl_c {
     public:
         explicit http_client_ssl_c(const security_context_opts &sec_opts = {}) {
-            idle_timer = std::make_unique<asio::steady_timer>(net.context);
-            if (!sec_opts.private_key.empty()) {
-                const asio::const_buffer buffer(sec_opts.private_key.data(), sec_opts.private_key.size());
-                net.ssl_context.use_private_key(buffer, sec_opts.file_format);
-            }
-
-            if (!sec_opts.cert.empty()) {
-                const asio::const_buffer buffer(sec_opts.cert.data(), sec_opts.cert.size());
-                net.ssl_context.use_certificate(buffer, sec_opts.file_format);
-            }
-
-            if (!sec_opts.cert_chain.empty()) {
-                const asio::const_buffer buffer(sec_opts.cert_chain.data(), sec_opts.cert_chain.size());
-                net.ssl_context.use_certificate_chain(buffer);
-            }
-
-            if (!sec_opts.rsa_private_key.empty()) {
-                const asio::const_buffer buffer(sec_opts.rsa_private_key.data(), sec_opts.rsa_private_key.size());
-                net.ssl_context.use_rsa_private_key(buffer, sec_opts.file_format);
-            }
-
-            if (!sec_opts.host_name_verification.empty()) {
-                net.ssl_context.set_verify_callback(asio::ssl::host_name_verification(sec_opts.host_name_verification));
-            }
-
-            switch (sec_opts.verify_mode) {
-                case none:
-                    net.ssl_context.set_verify_mode(asio::ssl::verify_none);
-                    break;
-                case verify_peer:
-                    net.ssl_context.set_verify_mode(asio::ssl::verify_peer);
-                    break;
-                case verify_fail_if_no_peer_cert:
-                    net.ssl_context.set_verify_mode(asio::ssl::verify_fail_if_no_peer_cert);
-                    break;
-                default:
-                    break;
-            }
+            init(sec_opts);
+        }
 
-            net.ssl_socket = asio::ssl::stream<tcp::socket>(net.context, net.ssl_context);
+        /**
+         * Construct the client on a shared io_context instead of a private one.
+         * No runtime thread is reserved for this client, the owner of 'io_context' is responsible
+         * for running it, so many clients can be multiplexed over a few threads. Handlers of the
+         * client are serialized on its own strand.
+         * Keep the client alive until 'io_context' has run the handlers cancelled by 'close()'.
+         *
+         * @param io_context Shared io_context used by the socket, resolver and timers.
+         *
+         * @par Example
+         * @code
+         * asio::io_context io_context;
+         * http_client_ssl_c client(io_context, {});
+         * client.set_host({"localhost", "8080", v4});
+         * io_context.run();
+         * @endcode
+         */
+        http_client_ssl_c(asio::io_context &io_context, const security_context_opts &sec_opts = {}): net(io_context) {
+            init(sec_opts);
         }
 
+        /**
+         * Construct the client on the io_context of a runtime, see the io_context constructor.
+         *
+         * @param runtime Runtime whose threads run the client handlers. Must outlive the client.
+         *
+         * @par Example
+         * @code
+         * runtime_c runtime({ 2, "client" });
+         * http_client_ssl_c client(runtime, {});
+         * @endcode
+         */
+        http_client_ssl_c(runtime_c &runtime, const security_context_opts &sec_opts = {}): http_client_ssl_c(runtime.context(), sec_opts) {}
+
         ~http_client_ssl_c() {
             if (net.ssl_socket.next_layer().is_open())
                 close();
@@ -410,14 +488,22 @@ namespace internetprotocol {
          */
         void request(const http_request_t &req,
                      const std::function<void(const asio::error_code &, const http_response_t &)> &response_cb) {
+            // Shared io_contexts never run out of work, so end the exchange here as run_context_thread would
+            const std::function<void(const asio::error_code &, const http_response_t &)> callback =
+                net.owned_context ? response_cb : [&, response_cb](const asio::error_code &ec, const http_response_t &res) {
+                    close();
+                    response_cb(ec, res);
+                };
+
             if (!net.ssl_socket.next_layer().is_open()) {
-                net.resolver.async_resolve(bind_options.protocol == v4 ? tcp::v4() : tcp::v6(),
-                                           bind_options.address, bind_options.port,
-                                           [&, req, response_cb](const asio::error_code &ec,
-                                                                 const tcp::resolver::results_type &results) {
-                                               resolve(ec, results, req, response_cb);
-                                           });
-                asio::post(thread_pool, [&] { run_context_thread(); });
+                resolver_cache().async_resolve(net.resolver, resolve_protocol(bind_options.protocol),
+                                               bind_options.address, bind_options.port,
+                                               [&, req, callback](const asio::error_code &ec,
+                                                                  const tcp::resolver::results_type &results) {
+                                                   resolve(ec, results, req, callback);
+                                               }, bind_options.use_resolver_cache);
+                if (net.owned_context)
+                    asio::post(default_runtime().get_executor(), [&]{ run_context_thread(); });
                 return;
             }
 
@@ -428,11 +514,53 @@ namespace internetprotocol {
                 reset_idle_timer();
             asio::async_write(net.ssl_socket,
                               asio::buffer(payload.data(), payload.size()),
-                              [&, response_cb](const asio::error_code &ec, const size_t bytes_sent) {
-                                  write_cb(ec, bytes_sent, response_cb);
+                              [&, callback](const asio::error_code &ec, const size_t bytes_sent) {
+                                  write_cb(ec, bytes_sent, callback);
                               });
         }
 
+#ifdef ASIO_HAS_CO_AWAIT
+        /**
+         * Awaitable version of 'request()'.
+         *
+         * @param req Request data.
+         *
+         * @return A tuple with the error code and the response.
+         *
+         * @par Example
+         * @code
+         * http_client_ssl_c client({});
+         * client.set_host({});
+         *
+         * auto [ec, res] = co_await client.async_request(req);
+         * if (!ec)
+         *      std::cout << res.status_code << " " << res.status_message << std::endl;
+         * @endcode
+         */
+        asio::awaitable<std::tuple<asio::error_code, http_response_t>> async_request(const http_request_t req) {
+            asio::error_code ec;
+            auto token = asio::redirect_error(asio::use_awaitable, ec);
+            http_response_t response = co_await asio::async_initiate<decltype(token), void(asio::error_code, http_response_t)>(
+                [this](auto handler, const http_request_t &request_data) {
+                    using handler_t = decltype(handler);
+                    std::shared_ptr<handler_t> shared_handler = std::make_shared<handler_t>(std::move(handler));
+                    std::shared_ptr<std::atomic<bool>> completed = std::make_shared<std::atomic<bool>>(false);
+                    request(request_data, [shared_handler, completed](const asio::error_code &error, const http_response_t &res) {
+                        // The response callback may fire again after a cancellation, resume the coroutine once
+                        if (completed->exchange(true))
+                            return;
+                        asio::post(asio::get_associated_executor(*shared_handler),
+                                   [shared_handler, error, res]() mutable {
+                                       std::move(*shared_handler)(error, std::move(res));
+                                   });
+                    });
+                },
+                token, req);
+            co_return std::make_tuple(ec, std::move(response));
+        }
+#endif
+
+
         /**
          * Close the underlying socket and stop listening for data on it. Also can be used to force cancel the request process.
          *
@@ -444,6 +572,7 @@ namespace internetprotocol {
          */
         void close() {
             is_closing.store(true);
+            connector.cancel();
             asio::error_code ec;
             if (net.ssl_socket.next_layer().is_open()) {
                 net.ssl_socket.lowest_layer().shutdown(asio::socket_base::shutdown_both, ec);
@@ -452,8 +581,10 @@ namespace internetprotocol {
                 net.ssl_socket.shutdown(ec);
                 net.ssl_socket.next_layer().close(ec);
             }
-            net.context.stop();
-            net.context.restart();
+            if (net.owned_context) {
+                net.context.stop();
+                net.context.restart();
+            }
             net.endpoint = tcp::endpoint();
             is_closing.store(false);
         }
@@ -461,20 +592,17 @@ namespace internetprotocol {
     private:
         std::mutex mutex_io;
         std::atomic<bool> is_closing = false;
-        std::unique_ptr<asio::steady_timer> idle_timer;
         client_bind_options_t bind_options;
         tcp_client_ssl_t net;
-        asio::streambuf recv_buffer;
+        tcp_connector_c connector;
+        wheel_timer_c idle_timer{net.context, net.resolver.get_executor()};
+        pooled_streambuf_c recv_buffer{buffer_pool_c::get(net.ssl_socket.get_executor())};
 
         void start_idle_timer() {
             if (idle_timeout_seconds == 0)
                 return;
 
-            idle_timer->expires_after(std::chrono::seconds(idle_timeout_seconds));
-            idle_timer->async_wait([&](const asio::error_code &ec) {
-                if (ec == asio::error::operation_aborted)
-                    return;
-
+            idle_timer.start(std::chrono::seconds(idle_timeout_seconds), [&]() {
                 if (is_closing.load())
                     return;
 
@@ -486,13 +614,54 @@ namespace internetprotocol {
             if (is_closing.load() || idle_timeout_seconds == 0)
                 return;
 
-            idle_timer->cancel();
-            start_idle_timer();
+            idle_timer.refresh();
+        }
+
+        void init(const security_context_opts &sec_opts) {
+            if (!sec_opts.private_key.empty()) {
+                const asio::const_buffer buffer(sec_opts.private_key.data(), sec_opts.private_key.size());
+                net.ssl_context.use_private_key(buffer, sec_opts.file_format);
+            }
+
+            if (!sec_opts.cert.empty()) {
+                const asio::const_buffer buffer(sec_opts.cert.data(), sec_opts.cert.size());
+                net.ssl_context.use_certificate(buffer, sec_opts.file_format);
+            }
+
+            if (!sec_opts.cert_chain.empty()) {
+                const asio::const_buffer buffer(sec_opts.cert_chain.data(), sec_opts.cert_chain.size());
+                net.ssl_context.use_certificate_chain(buffer);
+            }
+
+            if (!sec_opts.rsa_private_key.empty()) {
+                const asio::const_buffer buffer(sec_opts.rsa_private_key.data(), sec_opts.rsa_private_key.size());
+                net.ssl_context.use_rsa_private_key(buffer, sec_opts.file_format);
+            }
+
+            if (!sec_opts.host_name_verification.empty()) {
+                net.ssl_context.set_verify_callback(asio::ssl::host_name_verification(sec_opts.host_name_verification));
+            }
+
+            switch (sec_opts.verify_mode) {
+                case none:
+                    net.ssl_context.set_verify_mode(asio::ssl::verify_none);
+                    break;
+                case verify_peer:
+                    net.ssl_context.set_verify_mode(asio::ssl::verify_peer);
+                    break;
+                case verify_fail_if_no_peer_cert:
+                    net.ssl_context.set_verify_mode(asio::ssl::verify_fail_if_no_peer_cert);
+                    break;
+                default:
+                    break;
+            }
+
+            net.ssl_socket = asio::ssl::stream<tcp::socket>(net.resolver.get_executor(), net.ssl_context);
         }
 
         void run_context_thread() {
             std::lock_guard guard(mutex_io);
-            net.context.run();
+            run_context(net.context, bind_options.busy_poll_us);
             if (!is_closing.load())
                 close();
         }
@@ -506,11 +675,10 @@ namespace internetprotocol {
             }
 
             net.endpoint = results.begin()->endpoint();
-            asio::async_connect(net.ssl_socket.lowest_layer(),
-                                results,
-                                [&, req, response_cb](const asio::error_code &ec, const tcp::endpoint &ep) {
-                                    conn(ec, req, response_cb);
-                                });
+            connector.async_connect(net.ssl_socket.next_layer(), results, std::chrono::milliseconds(bind_options.connect_attempt_delay_ms),
+                                    [&, req, response_cb](const asio::error_code &ec, const tcp::endpoint &ep) {
+                                        conn(ec, req, response_cb);
+                                    });
         }
 
         void conn(const asio::error_code &error,
@@ -521,6 +689,9 @@ namespace internetprotocol {
                 return;
             }
 
+            set_busy_poll(net.ssl_socket.lowest_layer(), bind_options.so_busy_poll_us);
+            set_socket_options(net.ssl_socket.lowest_layer(), bind_options.socket_options);
+
             net.ssl_socket.async_handshake(asio::ssl::stream_base::client,
                                            [&, req, response_cb](const asio::error_code &ec) {
                                                ssl_handshake(ec, req, response_cb);
@@ -557,7 +728,7 @@ namespace internetprotocol {
             if (idle_timeout_seconds > 0)
                 reset_idle_timer();
             asio::async_read_until(net.ssl_socket,
-                             recv_buffer, "\r\n",
+                             recv_buffer.dynamic(), "\r\n",
                              [&, response_cb](const asio::error_code &ec, const size_t bytes_received) {
                                  read_cb(ec, bytes_received, response_cb);
                              });
@@ -603,7 +774,7 @@ namespace internetprotocol {
             }
 
             asio::async_read_until(net.ssl_socket,
-                                   recv_buffer, "\r\n\r\n",
+                                   recv_buffer.dynamic(), "\r\n\r\n",
                                    std::bind(&http_client_ssl_c::read_headers,
                                              this, asio::placeholders::error,
                                              response,
@@ -13,8 +13,8 @@ using namespace asio::ip;
 namespace internetprotocol {
     class http_remote_c {
     public:
-        http_remote_c(asio::io_context &io_context, const uint16_t timeout = 0): socket(io_context),
-            idle_timer(io_context) { idle_timeout_seconds = timeout; }
+        http_remote_c(asio::io_context &io_context, const uint16_t timeout = 0): socket(asio::make_strand(io_context)),
+            idle_timer(io_context, socket.get_executor()) { idle_timeout_seconds = timeout; }
 
         ~http_remote_c() {
             if (socket.is_open())
@@ -68,6 +68,21 @@ namespace internetprotocol {
         /// Just ignore this function
         tcp::socket &get_socket() { return socket; }
 
+        /**
+         * Return the connection id the server gave this client, 0 until it has been accepted.
+         * Unlike the shared_ptr it can be stored anywhere, 'server.find(id)' returns the client while it is connected.
+         *
+         * @par Example
+         * @code
+         * http_remote_c client;
+         * connection_id_t id = client.get_id();
+         * @endcode
+         */
+        connection_id_t get_id() const { return id; }
+
+        /// Set by the server when the connection is accepted.
+        void set_id(const connection_id_t connection_id) { id = connection_id; }
+
         /**
          * Send response to client. Return false if socket is closed.
          *
@@ -86,20 +101,78 @@ namespace internetprotocol {
                 return false;
 
             reset_idle_timer();
+            if (draining.load())
+                headers.headers.insert_or_assign("Connection", "close");
+
+            const std::string payload = prepare_response(headers);
+            send_queue.push(payload.data(), payload.size(),
+                            [&, callback](const asio::error_code &ec, const size_t bytes_sent) {
+                                write_cb(ec, bytes_sent, callback);
+                            });
+            return true;
+        }
+
+#ifndef _WIN32
+        /**
+         * Send response to client with the content of a file as body. Return false if socket is closed or if the file cannot be opened.
+         * If the file shrinks before it is queued, 'callback' gets an error and the connection is closed.
+         * The 'Content-Length' header is set to the file size and the 'body' field is ignored.
+         * On Linux plain sockets the file goes from the page cache to the socket with sendfile(2) and never enters user space.
+         *
+         * @param path Path of the file to be send.
+         *
+         * @param callback This callback is triggered when the file has been sent, with the number of file bytes sent.
+         *
+         * @par Example
+         * @code
+         * http_remote_c client;
+         * client.headers.headers["Content-Type"] = "application/octet-stream";
+         * client.write_file("artifact.tar.gz");
+         * @endcode
+         */
+        bool write_file(const std::string &path, const std::function<void(const asio::error_code &, const size_t bytes_sent)> &callback = nullptr) {
+            if (!socket.is_open())
+                return false;
 
-            std::string payload = prepare_response(headers);
-            asio::async_write(socket,
-                              asio::buffer(payload.data(), payload.size()),
-                              [&, callback](const asio::error_code &ec, const size_t bytes_sent) {
-                                  write_cb(ec, bytes_sent, callback);
-                              });
+            const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0)
+                return false;
+
+            struct stat info{};
+            if (::fstat(fd, &info) != 0) {
+                ::close(fd);
+                return false;
+            }
+
+            reset_idle_timer();
+
+            http_response_t head = headers;
+            head.body.clear();
+            head.headers.insert_or_assign("Content-Length", std::to_string(info.st_size));
+            if (draining.load())
+                head.headers.insert_or_assign("Connection", "close");
+            const std::string payload = prepare_response(head);
+            send_queue.push(payload.data(), payload.size());
+            const bool queued = send_queue.push_file(fd, 0, static_cast<uint64_t>(info.st_size),
+                                                     [&, fd, callback](const asio::error_code &ec, const size_t bytes_sent) {
+                                                         ::close(fd);
+                                                         write_cb(ec, bytes_sent, callback);
+                                                     });
+            if (!queued) {
+                // Shrunk since fstat(): the head already promised more bytes than there are, so the connection ends here
+                ::close(fd);
+                will_close = true;
+                write_cb(asio::error::invalid_argument, 0, callback);
+                return false;
+            }
             return true;
         }
+#endif
 
         /// Just ignore this function
         void connect() {
             start_idle_timer();
-            asio::async_read_until(socket, recv_buffer, "\r\n",
+            asio::async_read_until(socket, recv_buffer.dynamic(), "\r\n",
                                    [&](const asio::error_code &ec, const size_t bytes_received) {
                                        read_cb(ec, bytes_received);
                                    });
@@ -108,12 +181,10 @@ namespace internetprotocol {
         /**
          * Close the underlying socket and stop listening for data on it. 'on_close' event will be triggered.
          *
-         * @param force Cancel all asynchronous operations associated with the client sockets if true.
-         *
          * @par Example
          * @code
          * http_remote_c client;
-         * client.close(false);
+         * client.close();
          * @endcode
          */
         void close() {
@@ -130,6 +201,26 @@ namespace internetprotocol {
             is_closing.store(false);
         }
 
+        /**
+         * Close the connection once the response to the request being handled has been sent, or at once if there is none.
+         * The response is sent with 'Connection: close'. 'on_close' event will be triggered.
+         *
+         * @par Example
+         * @code
+         * http_remote_c client;
+         * client.close_after_response();
+         * @endcode
+         */
+        void close_after_response() {
+            draining.store(true);
+            if (in_flight) {
+                will_close = true;
+                return;
+            }
+            close();
+            if (on_close) on_close();
+        }
+
         /// Just ignore this event listener
         std::function<void(const http_request_t &)> on_request;
 
@@ -162,24 +253,25 @@ namespace internetprotocol {
         std::function<void(const asio::error_code &)> on_error;
 
     private:
+        connection_id_t id = 0;
         std::mutex mutex_error;
         std::atomic<bool> is_closing = false;
         tcp::socket socket;
-        asio::steady_timer idle_timer;
+        send_queue_c<tcp::socket> send_queue{socket};
+        wheel_timer_c idle_timer;
         uint16_t idle_timeout_seconds;
         asio::error_code error_code;
         bool will_close = false;
-        asio::streambuf recv_buffer;
+        // Set from the request line until its response has been sent
+        bool in_flight = false;
+        std::atomic<bool> draining = false;
+        pooled_streambuf_c recv_buffer{buffer_pool_c::get(socket.get_executor())};
 
         void start_idle_timer() {
             if (idle_timeout_seconds == 0)
                 return;
 
-            idle_timer.expires_after(std::chrono::seconds(idle_timeout_seconds));
-            idle_timer.async_wait([&](const asio::error_code &ec) {
-                if (ec == asio::error::operation_aborted)
-                    return;
-
+            idle_timer.start(std::chrono::seconds(idle_timeout_seconds), [&]() {
                 if (is_closing.load())
                     return;
 
@@ -192,8 +284,7 @@ namespace internetprotocol {
             if (is_closing.load() || idle_timeout_seconds == 0)
                 return;
 
-            idle_timer.cancel();
-            start_idle_timer();
+            idle_timer.refresh();
         }
 
         void consume_recv_buffer() {
@@ -204,6 +295,7 @@ namespace internetprotocol {
 
         void write_cb(const asio::error_code &error, const size_t bytes_sent,
                       const std::function<void(const asio::error_code &ec, const size_t bytes_sent)> &callback) {
+            in_flight = false;
             if (!will_close)
                 reset_idle_timer();
             if (callback) callback(error, bytes_sent);
@@ -228,6 +320,7 @@ namespace internetprotocol {
                 return;
             }
             reset_idle_timer();
+            in_flight = true;
 
             std::istream request_stream(&recv_buffer);
             std::string method;
@@ -264,7 +357,7 @@ namespace internetprotocol {
             version.erase(0, 5);
             recv_buffer.consume(2);
             asio::async_read_until(socket,
-                                   recv_buffer, "\r\n\r\n",
+                                   recv_buffer.dynamic(), "\r\n\r\n",
                                    [&, path, version](const asio::error_code &ec, const size_t bytes_received) {
                                        read_headers(ec, path, version);
                                    });
@@ -305,6 +398,8 @@ namespace internetprotocol {
             will_close = req.headers.find("Connection") != req.headers.end() ? req.headers.at("Connection") != "keep-alive" : true;
             if (!will_close)
                 will_close = req.headers.find("connection") != req.headers.end() ? req.headers.at("connection") != "keep-alive" : true;
+            if (draining.load())
+                will_close = true;
 
             consume_recv_buffer();
             if (on_request) on_request(req);
@@ -315,7 +410,7 @@ namespace internetprotocol {
     class http_remote_ssl_c {
     public:
         http_remote_ssl_c(asio::io_context &io_context, asio::ssl::context &ssl_context, const uint16_t timeout = 0)
-        : ssl_socket(io_context, ssl_context), idle_timer(io_context) { idle_timeout_seconds = timeout; }
+        : ssl_socket(asio::make_strand(io_context), ssl_context), idle_timer(io_context, ssl_socket.get_executor()) { idle_timeout_seconds = timeout; }
 
         ~http_remote_ssl_c() {
             if (ssl_socket.next_layer().is_open())
@@ -369,6 +464,21 @@ namespace internetprotocol {
         /// Just ignore this function
         asio::ssl::stream<tcp::socket> &get_socket() { return ssl_socket; }
 
+        /**
+         * Return the connection id the server gave this client, 0 until it has been accepted.
+         * Unlike the shared_ptr it can be stored anywhere, 'server.find(id)' returns the client while it is connected.
+         *
+         * @par Example
+         * @code
+         * http_remote_ssl_c client;
+         * connection_id_t id = client.get_id();
+         * @endcode
+         */
+        connection_id_t get_id() const { return id; }
+
+        /// Set by the server when the connection is accepted.
+        void set_id(const connection_id_t connection_id) { id = connection_id; }
+
         /**
          * Send response to client. Return false if socket is closed.
          *
@@ -387,15 +497,73 @@ namespace internetprotocol {
                 return false;
 
             reset_idle_timer();
+            if (draining.load())
+                response.headers.insert_or_assign("Connection", "close");
+
+            const std::string payload = prepare_response(response);
+            send_queue.push(payload.data(), payload.size(),
+                            [&, callback](const asio::error_code &ec, const size_t bytes_sent) {
+                                write_cb(ec, bytes_sent, callback);
+                            });
+            return true;
+        }
+
+#ifndef _WIN32
+        /**
+         * Send response to client with the content of a file as body. Return false if socket is closed or if the file cannot be opened.
+         * If the file shrinks before it is queued, 'callback' gets an error and the connection is closed.
+         * The 'Content-Length' header is set to the file size and the 'body' field is ignored.
+         * On Linux plain sockets the file goes from the page cache to the socket with sendfile(2) and never enters user space.
+         *
+         * @param path Path of the file to be send.
+         *
+         * @param callback This callback is triggered when the file has been sent, with the number of file bytes sent.
+         *
+         * @par Example
+         * @code
+         * http_remote_ssl_c client;
+         * client.response.headers["Content-Type"] = "application/octet-stream";
+         * client.write_file("artifact.tar.gz");
+         * @endcode
+         */
+        bool write_file(const std::string &path, const std::function<void(const asio::error_code &, const size_t bytes_sent)> &callback = nullptr) {
+            if (!ssl_socket.next_layer().is_open())
+                return false;
 
-            std::string payload = prepare_response(response);
-            asio::async_write(ssl_socket,
-                              asio::buffer(payload.data(), payload.size()),
-                              [&, callback](const asio::error_code &ec, const size_t bytes_sent) {
-                                  write_cb(ec, bytes_sent, callback);
-                              });
+            const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0)
+                return false;
+
+            struct stat info{};
+            if (::fstat(fd, &info) != 0) {
+                ::close(fd);
+                return false;
+            }
+
+            reset_idle_timer();
+
+            http_response_t head = response;
+            head.body.clear();
+            head.headers.insert_or_assign("Content-Length", std::to_string(info.st_size));
+            if (draining.load())
+                head.headers.insert_or_assign("Connection", "close");
+            const std::string payload = prepare_response(head);
+            send_queue.push(payload.data(), payload.size());
+            const bool queued = send_queue.push_file(fd, 0, static_cast<uint64_t>(info.st_size),
+                                                     [&, fd, callback](const asio::error_code &ec, const size_t bytes_sent) {
+                                                         ::close(fd);
+                                                         write_cb(ec, bytes_sent, callback);
+                                                     });
+            if (!queued) {
+                // Shrunk since fstat(): the head already promised more bytes than there are, so the connection ends here
+                ::close(fd);
+                will_close = true;
+                write_cb(asio::error::invalid_argument, 0, callback);
+                return false;
+            }
             return true;
         }
+#endif
 
         /// Just ignore this function
         void connect() {
@@ -409,12 +577,10 @@ namespace internetprotocol {
         /**
          * Close the underlying socket and stop listening for data on it. 'on_close' event will be triggered.
          *
-         * @param force Cancel all asynchronous operations associated with the client sockets if true.
-         *
          * @par Example
          * @code
          * http_remote_ssl_c client;
-         * client.close(false);
+         * client.close();
          * @endcode
          */
         void close() {
@@ -438,6 +604,26 @@ namespace internetprotocol {
             is_closing.store(false);
         }
 
+        /**
+         * Close the connection once the response to the request being handled has been sent, or at once if there is none.
+         * The response is sent with 'Connection: close'. 'on_close' event will be triggered.
+         *
+         * @par Example
+         * @code
+         * http_remote_ssl_c client;
+         * client.close_after_response();
+         * @endcode
+         */
+        void close_after_response() {
+            draining.store(true);
+            if (in_flight) {
+                will_close = true;
+                return;
+            }
+            close();
+            if (on_close) on_close();
+        }
+
         std::function<void(const http_request_t &)> on_request;
 
         /**
@@ -469,24 +655,25 @@ namespace internetprotocol {
         std::function<void(const asio::error_code &)> on_error;
 
     private:
+        connection_id_t id = 0;
         std::mutex mutex_error;
         std::atomic<bool> is_closing = false;
         asio::ssl::stream<tcp::socket> ssl_socket;
-        asio::steady_timer idle_timer;
+        send_queue_c<asio::ssl::stream<tcp::socket>> send_queue{ssl_socket, true};
+        wheel_timer_c idle_timer;
         uint16_t idle_timeout_seconds = 0;
         asio::error_code error_code;
         bool will_close = false;
-        asio::streambuf recv_buffer;
+        // Set from the request line until its response has been sent
+        bool in_flight = false;
+        std::atomic<bool> draining = false;
+        pooled_streambuf_c recv_buffer{buffer_pool_c::get(ssl_socket.get_executor())};
 
         void start_idle_timer() {
             if (idle_timeout_seconds == 0)
                 return;
 
-            idle_timer.expires_after(std::chrono::seconds(idle_timeout_seconds));
-            idle_timer.async_wait([&](const asio::error_code &ec) {
-                if (ec == asio::error::operation_aborted)
-                    return;
-
+            idle_timer.start(std::chrono::seconds(idle_timeout_seconds), [&]() {
                 if (is_closing.load())
                     return;
 
@@ -499,8 +686,7 @@ namespace internetprotocol {
             if (is_closing.load() || idle_timeout_seconds == 0)
                 return;
 
-            idle_timer.cancel();
-            start_idle_timer();
+            idle_timer.refresh();
         }
 
         void consume_recv_buffer() {
@@ -518,7 +704,7 @@ namespace internetprotocol {
                 return;
             }
 
-            asio::async_read_until(ssl_socket, recv_buffer, "\r\n",
+            asio::async_read_until(ssl_socket, recv_buffer.dynamic(), "\r\n",
                                    [&](const asio::error_code &ec, const size_t bytes_received) {
                                        read_cb(ec, bytes_received);
                                    });
@@ -527,6 +713,7 @@ namespace internetprotocol {
 
         void write_cb(const asio::error_code &error, const size_t bytes_sent,
                       const std::function<void(const asio::error_code &ec, const size_t bytes_sent)> &callback) {
+            in_flight = false;
             if (!will_close)
                 reset_idle_timer();
             if (callback) callback(error, bytes_sent);
@@ -551,6 +738,7 @@ namespace internetprotocol {
                 return;
             }
             reset_idle_timer();
+            in_flight = true;
 
             std::istream request_stream(&recv_buffer);
             std::string method;
@@ -587,7 +775,7 @@ namespace internetprotocol {
             version.erase(0, 5);
             recv_buffer.consume(2);
             asio::async_read_until(ssl_socket,
-                                   recv_buffer, "\r\n\r\n",
+                                   recv_buffer.dynamic(), "\r\n\r\n",
                                    [&, path, version](const asio::error_code &ec, const size_t bytes_received) {
                                        read_headers(ec, path, version);
                                    });
@@ -628,6 +816,8 @@ namespace internetprotocol {
             will_close = req.headers.find("Connection") != req.headers.end() ? req.headers.at("Connection") != "keep-alive" : true;
             if (!will_close)
                 will_close = req.headers.find("connection") != req.headers.end() ? req.headers.at("connection") != "keep-alive" : true;
+            if (draining.load())
+                will_close = true;
 
             consume_recv_buffer();
             if (on_request) on_request(req);
@@ -12,8 +12,23 @@ namespace internetprotocol {
     class http_server_c {
     public:
         http_server_c() {}
+
+        /**
+         * Construct the server on a runtime instead of the default one.
+         * Every run loop of the server (io_threads per shard) occupies one runtime thread while the server is open.
+         * 'open()' fails with 'invalid_argument' if the runtime has fewer threads than shards * io_threads.
+         *
+         * @param runtime Runtime hosting the server run loops. Must outlive the server.
+         *
+         * @par Example
+         * @code
+         * runtime_c runtime({ 4, "server", { 0xF0 } });
+         * http_server_c server(runtime);
+         * @endcode
+         */
+        explicit http_server_c(runtime_c &runtime): runtime(runtime) {}
         ~http_server_c() {
-            if (net.acceptor.is_open())
+            if (net.acceptor.is_open() || draining.load())
                 close();
         }
 
@@ -51,6 +66,23 @@ namespace internetprotocol {
          */
         int backlog = 2147483647;
 
+        /**
+         * Set/Get the number of threads running the server io_context.
+         *
+         * Every accepted connection is bound to its own strand, so the handlers of a single
+         * connection never run concurrently even when io_threads is greater than 1.
+         * Values lower than 1 are treated as 1. Must be set before 'open()'.
+         *
+         * @par Example
+         * @code
+         * http_server_c server;
+         * // Spread accepts, reads and callbacks over 4 threads
+         * server.io_threads = 4;
+         * server.open({"", 8080});
+         * @endcode
+         */
+        uint16_t io_threads = 1;
+
         /**
          * Return true if socket is open.
          *
@@ -75,13 +107,13 @@ namespace internetprotocol {
         tcp::endpoint local_endpoint() const { return net.acceptor.local_endpoint(); }
 
         /**
-         * Gets a constant reference to the set of clients connected to the server.
+         * Gets a copy of the set of clients connected to the server.
          *
          * This method returns a std::set containing shared pointers to all tcp_remote_c
-         * clients currently connected to the server. Useful for monitoring active
+         * clients currently connected to the server, across every shard. Useful for monitoring active
          * connections or performing operations on all connected clients.
          *
-         * @return A constant reference to the std::set of connected clients.
+         * @return A std::set with the connected clients.
          *
          * @par Example
          * @code
@@ -100,7 +132,88 @@ namespace internetprotocol {
          * }
          * @endcode
          */
-        const std::set<std::shared_ptr<http_remote_c>> &clients() const { return net.clients; }
+        std::set<std::shared_ptr<http_remote_c>> clients() {
+            std::set<std::shared_ptr<http_remote_c>> all_clients;
+            for_each([&](const std::shared_ptr<http_remote_c> &client) {
+                all_clients.insert(client);
+            });
+            return all_clients;
+        }
+
+        /**
+         * Return the client with the connection id 'id', or nullptr if it is no longer connected.
+         * The lookup is O(1) and thread-safe. The id of a client is returned by its 'get_id()'.
+         *
+         * @par Example
+         * @code
+         * http_server_c server;
+         *
+         * std::shared_ptr<http_remote_c> client = server.find(id);
+         * if (client)
+         *     client->write("...");
+         * @endcode
+         */
+        std::shared_ptr<http_remote_c> find(const connection_id_t id) {
+            tcp_server_t<http_remote_c> *shard = shard_of(id);
+            if (!shard)
+                return nullptr;
+
+            std::lock_guard guard(shard->clients_mutex);
+            return shard->clients.find(id);
+        }
+
+        /**
+         * Call 'fn' for every connected client, across every shard.
+         * The clients are collected under the registry locks and 'fn' runs after they are released,
+         * so it may write to or close the clients.
+         *
+         * @par Example
+         * @code
+         * http_server_c server;
+         *
+         * server.for_each([&](const std::shared_ptr<http_remote_c> &client) {
+         *     // your code...
+         * });
+         * @endcode
+         */
+        void for_each(const std::function<void(const std::shared_ptr<http_remote_c> &)> &fn) {
+            std::vector<std::shared_ptr<http_remote_c>> all_clients;
+            {
+                std::lock_guard guard(net.clients_mutex);
+                all_clients.reserve(net.clients.size());
+                net.clients.for_each([&](const std::shared_ptr<http_remote_c> &client) { all_clients.push_back(client); });
+            }
+            for (const std::unique_ptr<tcp_server_t<http_remote_c>> &shard : net.shards) {
+                std::lock_guard guard(shard->clients_mutex);
+                shard->clients.for_each([&](const std::shared_ptr<http_remote_c> &client) { all_clients.push_back(client); });
+            }
+            for (const std::shared_ptr<http_remote_c> &client : all_clients)
+                fn(client);
+        }
+
+        /**
+         * Run 'fn' on the strand of the client with the connection id 'id', so it never races the client's own handlers.
+         * It can be called from any thread. It returns false if the client is no longer connected.
+         *
+         * @par Example
+         * @code
+         * http_server_c server;
+         *
+         * server.post_to(id, [](const std::shared_ptr<http_remote_c> &client) {
+         *     // your code...
+         * });
+         * @endcode
+         */
+        bool post_to(const connection_id_t id, const std::function<void(const std::shared_ptr<http_remote_c> &)> &fn) {
+            std::shared_ptr<http_remote_c> client = find(id);
+            if (!client || !fn)
+                return false;
+
+            asio::post(client->get_socket().get_executor(), [client, fn]() {
+                fn(client);
+            });
+            return true;
+        }
 
         /**
          * Return a const ref of the latest error code returned by asio.
@@ -297,83 +410,120 @@ namespace internetprotocol {
          * @endcode
          */
         bool open(const server_bind_options_t &bind_opts = { "", 8080, v4, true }) {
-            if (net.acceptor.is_open())
+            if (net.acceptor.is_open() || draining.load())
                 return false;
 
-            net.acceptor.open(bind_opts.protocol == v4
-                                  ? tcp::v4()
-                                  : tcp::v6(),
-                                  error_code);
+            bind_options = bind_opts;
+            admission.reset(bind_opts.admission);
 
-            if (error_code && on_error) {
-                std::lock_guard guard(mutex_error);
-                on_error(error_code);
+            const bool listening = bind_opts.listen_handles.empty() ? bind_listeners(bind_opts) : adopt_listeners(bind_opts);
+            if (!listening)
                 return false;
-            }
 
-            net.acceptor.set_option(asio::socket_base::reuse_address(bind_opts.reuse_address), error_code);
-            if (error_code && on_error) {
+            // Every run loop blocks a runtime thread until the server closes, a loop with no thread left never runs
+            const uint16_t threads = io_threads > 0 ? io_threads : 1;
+            if (runtime.thread_count() < threads * (net.shards.size() + 1)) {
+                asio::error_code ec;
+                net.acceptor.close(ec);
+                net.shards.clear();
                 std::lock_guard guard(mutex_error);
-                on_error(error_code);
+                error_code = asio::error::invalid_argument;
+                if (on_error) on_error(error_code);
                 return false;
             }
 
-            const tcp::endpoint endpoint = bind_opts.address.empty() ?
-                                        tcp::endpoint(bind_opts.protocol == v4
-                                                        ? tcp::v4()
-                                                        : tcp::v6(),
-                                                        bind_opts.port) :
-                                        tcp::endpoint(make_address(bind_opts.address), bind_opts.port);
+            error_code.clear();
+            running_threads.store(static_cast<uint32_t>(threads * (net.shards.size() + 1)));
+            start_shard(net, threads);
+            for (const std::unique_ptr<tcp_server_t<http_remote_c>> &shard : net.shards)
+                start_shard(*shard, threads);
+            return true;
+        }
 
-            net.acceptor.bind(endpoint, error_code);
-            if (error_code && on_error) {
-                std::lock_guard guard(mutex_error);
-                on_error(error_code);
-                return false;
+        /**
+         * Return the listening sockets of every shard, to hand them over to the process replacing this one
+         * with 'listen_handoff_c' or 'export_listen_handles()'. They stay owned by the server, the other process gets copies
+         * and keeps accepting on them after this server closes. Empty if the server is not open.
+         *
+         * @par Example
+         * @code
+         * http_server_c server;
+         * std::vector<tcp::acceptor::native_handle_type> handles = server.listen_handles();
+         * @endcode
+         */
+        std::vector<tcp::acceptor::native_handle_type> listen_handles() {
+            std::vector<tcp::acceptor::native_handle_type> handles;
+            if (!net.acceptor.is_open())
+                return handles;
+
+            handles.push_back(net.acceptor.native_handle());
+            for (const std::unique_ptr<tcp_server_t<http_remote_c>> &shard : net.shards) {
+                if (shard->acceptor.is_open())
+                    handles.push_back(shard->acceptor.native_handle());
             }
+            return handles;
+        }
 
-            net.acceptor.listen(backlog, error_code);
-            if (error_code && on_error) {
-                std::lock_guard guard(mutex_error);
-                on_error(error_code);
+        /**
+         * Stop accepting and let the connected clients finish before closing. 'on_close' event will be triggered once every client is gone.
+         * Requests already being handled get their response, sent with 'Connection: close', and idle clients are closed.
+         * Clients still connected when 'timeout' expires are closed. Returns false if the server is not open or is already draining.
+         *
+         * @param timeout Time given to the clients to finish.
+         *
+         * @par Example
+         * @code
+         * http_server_c server;
+         * server.on_close = [&]() {
+         *      // every client has been disconnected
+         * };
+         * server.drain(std::chrono::seconds(30));
+         * @endcode
+         */
+        bool drain(const std::chrono::steady_clock::duration timeout) {
+            if (!net.acceptor.is_open() || draining.exchange(true))
                 return false;
-            }
 
-            asio::post(thread_pool, [&]{ run_context_thread(); });
+            {
+                std::lock_guard guard(mutex_drain);
+                drain_timer.expires_after(timeout);
+                drain_timer.async_wait([&](const asio::error_code &ec) {
+                    if (!ec && draining.load())
+                        drain_expired();
+                });
+            }
+            for (const std::unique_ptr<tcp_server_t<http_remote_c>> &shard : net.shards)
+                stop_accepting(*shard);
+            stop_accepting(net);
+            for_each([](const std::shared_ptr<http_remote_c> &client) {
+                asio::post(client->get_socket().get_executor(), [client]() {
+                    client->close_after_response();
+                });
+            });
+            // Clients closing from now on cancel the deadline when they are the last one
+            if (admission.live_connections() == 0)
+                cancel_drain_timer();
             return true;
         }
 
         /**
          * Close the underlying socket and stop listening for data on it. 'on_close' event will be triggered.
          *
-         * @param force Cancel all asynchronous operations associated with the client sockets if true.
-         *
          * @par Example
          * @code
          * http_server_c server;
-         * server.close(false);
+         * server.close();
          * @endcode
          */
         void close() {
             is_closing.store(true);
-            if (net.acceptor.is_open()) {
-                std::lock_guard guard(mutex_error);
-                net.acceptor.close(error_code);
-                if (on_error) on_error(error_code);
-            }
-            if (!net.clients.empty()) {
-                std::lock_guard guard(mutex_error);
-                for (const auto &client : net.clients) {
-                    if (client)
-                        client->close();
-                }
-                net.clients.clear();
-            }
-            net.context.stop();
-            net.context.restart();
-            net.acceptor = tcp::acceptor(net.context);
+            cancel_drain_timer();
+            for (const std::unique_ptr<tcp_server_t<http_remote_c>> &shard : net.shards)
+                close_shard(*shard);
+            close_shard(net);
             if (on_close)
                 on_close();
+            draining.store(false);
             is_closing.store(false);
         }
 
@@ -405,11 +555,17 @@ namespace internetprotocol {
          */
         std::function<void(const asio::error_code &)> on_error;
     private:
-        std::mutex mutex_io;
         std::mutex mutex_error;
+        runtime_c &runtime = default_runtime();
         std::atomic<bool> is_closing = false;
+        std::atomic<uint32_t> running_threads = 0;
         tcp_server_t<http_remote_c> net;
         asio::error_code error_code;
+        server_bind_options_t bind_options;
+        admission_control_c admission;
+        std::atomic<bool> draining = false;
+        std::mutex mutex_drain;
+        asio::steady_timer drain_timer{net.context};
 
         std::map<std::string, std::function<void(const http_request_t &, const std::shared_ptr<http_remote_c> &)>> all_cb;
         std::map<std::string, std::function<void(const http_request_t &, const std::shared_ptr<http_remote_c> &)>> get_cb;
@@ -420,48 +576,268 @@ namespace internetprotocol {
         std::map<std::string, std::function<void(const http_request_t &, const std::shared_ptr<http_remote_c> &)>> options_cb;
         std::map<std::string, std::function<void(const http_request_t &, const std::shared_ptr<http_remote_c> &)>> patch_cb;
 
-        void run_context_thread() {
-            std::lock_guard guard(mutex_io);
-            error_code.clear();
-            std::shared_ptr<http_remote_c> client_socket = std::make_shared<http_remote_c>(net.context, iddle_timeout);
-            net.acceptor.async_accept(client_socket->get_socket(),
+        // Shard that handed out 'id', see connection_id_t
+        tcp_server_t<http_remote_c> *shard_of(const connection_id_t id) {
+            const uint16_t index = connection_shard(id);
+            if (index == 0)
+                return &net;
+            if (index > net.shards.size())
+                return nullptr;
+            return net.shards[index - 1].get();
+        }
+
+        void run_context_thread(tcp_server_t<http_remote_c> &shard) {
+            run_context(shard.context, bind_options.busy_poll_us);
+            if (running_threads.fetch_sub(1) == 1 && !is_closing.load())
+                close();
+        }
+
+        // Open and bind the acceptor of every shard
+        bool bind_listeners(const server_bind_options_t &bind_opts) {
+            const tcp::endpoint endpoint = bind_opts.address.empty() ?
+                                        tcp::endpoint(bind_opts.protocol == v4
+                                                        ? tcp::v4()
+                                                        : tcp::v6(),
+                                                        bind_opts.port) :
+                                        tcp::endpoint(make_address(bind_opts.address), bind_opts.port);
+
+#ifdef SO_REUSEPORT
+            const bool reuse_port = bind_opts.shards > 1;
+#else
+            const bool reuse_port = false;
+#endif
+            if (!open_acceptor(net.acceptor, bind_opts, endpoint, reuse_port))
+                return false;
+
+            net.shards.clear();
+            if (reuse_port) {
+                // Every shard binds the port picked by the first acceptor, so port 0 works too
+                const tcp::endpoint shard_endpoint = net.acceptor.local_endpoint();
+                for (uint16_t i = 1; i < bind_opts.shards; ++i) {
+                    net.shards.push_back(std::make_unique<tcp_server_t<http_remote_c>>());
+                    net.shards.back()->clients.set_shard(i);
+                    if (!open_acceptor(net.shards.back()->acceptor, bind_opts, shard_endpoint, reuse_port)) {
+                        asio::error_code ec;
+                        net.acceptor.close(ec);
+                        net.shards.clear();
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+
+        // Serve on sockets that are listening already, one shard each
+        bool adopt_listeners(const server_bind_options_t &bind_opts) {
+            net.shards.clear();
+            for (size_t i = 0; i < bind_opts.listen_handles.size(); ++i) {
+                if (i > 0) {
+                    net.shards.push_back(std::make_unique<tcp_server_t<http_remote_c>>());
+                    net.shards.back()->clients.set_shard(static_cast<uint16_t>(i));
+                }
+                tcp::acceptor &acceptor = i == 0 ? net.acceptor : net.shards.back()->acceptor;
+                if (!adopt_acceptor(acceptor, bind_opts.listen_handles[i], backlog, error_code)) {
+                    {
+                        std::lock_guard guard(mutex_error);
+                        if (on_error) on_error(error_code);
+                    }
+                    // The handles belong to the server, close the ones adopted so far and the ones left
+                    asio::error_code ec;
+                    net.acceptor.close(ec);
+                    net.shards.clear();
+                    for (size_t j = i; j < bind_opts.listen_handles.size(); ++j) {
+                        asio::detail::socket_ops::state_type state = 0;
+                        asio::detail::socket_ops::close(bind_opts.listen_handles[j], state, true, ec);
+                    }
+                    return false;
+                }
+                set_busy_poll(acceptor, bind_opts.so_busy_poll_us);
+                set_listener_options(acceptor, bind_opts.socket_options);
+            }
+            return true;
+        }
+
+        bool open_acceptor(tcp::acceptor &acceptor, const server_bind_options_t &bind_opts,
+                           const tcp::endpoint &endpoint, const bool reuse_port) {
+            acceptor.open(bind_opts.protocol == v4
+                          ? tcp::v4()
+                          : tcp::v6(),
+                          error_code);
+            if (error_code) {
+                std::lock_guard guard(mutex_error);
+                if (on_error) on_error(error_code);
+                return false;
+            }
+
+            acceptor.set_option(asio::socket_base::reuse_address(bind_opts.reuse_address), error_code);
+            if (error_code) {
+                std::lock_guard guard(mutex_error);
+                if (on_error) on_error(error_code);
+                return false;
+            }
+            set_busy_poll(acceptor, bind_opts.so_busy_poll_us);
+            set_listener_options(acceptor, bind_opts.socket_options);
+
+#ifdef SO_REUSEPORT
+            if (reuse_port) {
+                acceptor.set_option(reuse_port_t(true), error_code);
+                if (error_code) {
+                    std::lock_guard guard(mutex_error);
+                    if (on_error) on_error(error_code);
+                    return false;
+                }
+            }
+#endif
+
+            acceptor.bind(endpoint, error_code);
+            if (error_code) {
+                std::lock_guard guard(mutex_error);
+                if (on_error) on_error(error_code);
+                return false;
+            }
+
+            acceptor.listen(backlog, error_code);
+            if (error_code) {
+                std::lock_guard guard(mutex_error);
+                if (on_error) on_error(error_code);
+                return false;
+            }
+            return true;
+        }
+
+        // Arm one more accept, with the connection object it will hand the socket to constructed up front.
+        // 'client_socket' reuses the one of a rejected connection.
+        void async_accept(tcp_server_t<http_remote_c> &shard, std::shared_ptr<http_remote_c> client_socket = nullptr) {
+            const std::chrono::steady_clock::duration delay = admission.reserve_accept();
+            if (delay > std::chrono::steady_clock::duration::zero()) {
+                // Out of accept tokens, arm it once the bucket has refilled
+                std::shared_ptr<asio::steady_timer> timer = std::make_shared<asio::steady_timer>(shard.context, delay);
+                timer->async_wait([&, timer, client_socket](const asio::error_code &ec) {
+                    if (!ec && shard.acceptor.is_open())
+                        async_accept(shard, client_socket);
+                });
+                return;
+            }
+            if (!client_socket)
+                client_socket = std::make_shared<http_remote_c>(shard.context, iddle_timeout);
+            shard.acceptor.async_accept(client_socket->get_socket(),
                                         [&, client_socket](const asio::error_code &ec) {
-                                            accept(ec, client_socket);
+                                            accept(ec, client_socket, shard);
                                         });
-            net.context.run();
-            if (!is_closing.load())
-                close();
         }
 
-        void accept(const asio::error_code &error, const std::shared_ptr<http_remote_c> &client) {
+        void start_shard(tcp_server_t<http_remote_c> &shard, const uint16_t threads) {
+            for (uint16_t i = 0; i < std::max<uint16_t>(bind_options.pending_accepts, 1); ++i)
+                async_accept(shard);
+            for (uint16_t i = 0; i < threads; ++i)
+                asio::post(runtime.get_executor(), [&]{ run_context_thread(shard); });
+        }
+
+        void close_shard(tcp_server_t<http_remote_c> &shard) {
+            if (shard.acceptor.is_open()) {
+                std::lock_guard guard(mutex_error);
+                shard.acceptor.close(error_code);
+                if (on_error) on_error(error_code);
+            }
+            std::vector<std::shared_ptr<http_remote_c>> clients_to_close;
+            {
+                std::lock_guard guard(shard.clients_mutex);
+                clients_to_close = shard.clients.take_all();
+            }
+            if (!clients_to_close.empty()) {
+                std::lock_guard guard(mutex_error);
+                for (const auto &client : clients_to_close) {
+                    if (client)
+                        client->close();
+                }
+            }
+            shard.context.stop();
+            shard.context.restart();
+            shard.acceptor = tcp::acceptor(shard.context);
+        }
+
+        // Close the acceptor of 'shard' and leave its clients connected
+        void stop_accepting(tcp_server_t<http_remote_c> &shard) {
+            if (!shard.acceptor.is_open())
+                return;
+            std::lock_guard guard(mutex_error);
+            shard.acceptor.close(error_code);
+            if (error_code && on_error) on_error(error_code);
+        }
+
+        void cancel_drain_timer() {
+            std::lock_guard guard(mutex_drain);
+            drain_timer.cancel();
+        }
+
+        // Drain deadline: close whatever is still connected
+        void drain_expired() {
+            for_each([](const std::shared_ptr<http_remote_c> &client) {
+                asio::post(client->get_socket().get_executor(), [client]() {
+                    client->close();
+                    if (client->on_close) client->on_close();
+                });
+            });
+        }
+
+        void accept(const asio::error_code &error, const std::shared_ptr<http_remote_c> &client, tcp_server_t<http_remote_c> &shard) {
             if (error) {
                 std::lock_guard guard(mutex_error);
                 error_code = error;
                 if (!is_closing.load())
                     client->close();
                 if (on_error) on_error(error_code);
-                if (net.acceptor.is_open()) {
-                    std::shared_ptr<http_remote_c> client_socket = std::make_shared<http_remote_c>(net.context, iddle_timeout);
-                    net.acceptor.async_accept(client_socket->get_socket(),
-                                                [&, client_socket](const asio::error_code &ec) {
-                                                    accept(ec, client_socket);
-                                                });
-                }
+                if (shard.acceptor.is_open())
+                    async_accept(shard);
                 return;
             }
+            asio::error_code endpoint_error;
+            const asio::ip::address address = client->get_socket().remote_endpoint(endpoint_error).address();
+            if (endpoint_error || !admission.admit(address)) {
+                // Over a limit: drop it before anything is set up for it, its remote takes the next connection
+                client->get_socket().close(endpoint_error);
+                if (shard.acceptor.is_open())
+                    async_accept(shard, client);
+                return;
+            }
+            set_socket_options(client->get_socket(), bind_options.socket_options);
+            connection_id_t id;
+            {
+                std::lock_guard guard(shard.clients_mutex);
+                id = shard.clients.insert(client);
+            }
+            if (id == 0) {
+                // Registry full: its close could not find it, so its admission slots would never be given back
+                asio::error_code ec;
+                client->get_socket().close(ec);
+                admission.release(address);
+                if (shard.acceptor.is_open())
+                    async_accept(shard, client);
+                return;
+            }
+            client->set_id(id);
             client->on_request = [&, client](const http_request_t &request) {
                 read_cb(request, client);
             };
-            client->on_close = [&, client]() { net.clients.erase(client); };
-            net.clients.insert(client);
+            client->on_close = [&, client, address]() {
+                bool registered;
+                {
+                    std::lock_guard guard(shard.clients_mutex);
+                    registered = shard.clients.erase(client->get_id());
+                }
+                // 'on_close' may run more than once, the connection is given back only the first time
+                if (registered) {
+                    admission.release(address);
+                    if (draining.load() && admission.live_connections() == 0)
+                        cancel_drain_timer();
+                }
+            };
             client->connect();
-            if (net.acceptor.is_open()) {
-                std::shared_ptr<http_remote_c> client_socket = std::make_shared<http_remote_c>(net.context, iddle_timeout);
-                net.acceptor.async_accept(client_socket->get_socket(),
-                                        [&, client_socket](const asio::error_code &ec) {
-                                            accept(ec, client_socket);
-                                        });
-            }
+            // Accepted while draining, after 'drain()' went over the clients
+            if (draining.load())
+                client->close_after_response();
+            if (shard.acceptor.is_open())
+                async_accept(shard);
         }
 
         void read_cb(const http_request_t &request, const std::shared_ptr<http_remote_c> &client) {
@@ -527,7 +903,22 @@ namespace internetprotocol {
 #ifdef ENABLE_SSL
     class http_server_ssl_c {
     public:
-        http_server_ssl_c(const security_context_opts sec_opts = {}) {
+        http_server_ssl_c(const security_context_opts sec_opts = {}): http_server_ssl_c(default_runtime(), sec_opts) {}
+
+        /**
+         * Construct the server on a runtime instead of the default one.
+         * Every run loop of the server (io_threads per shard) occupies one runtime thread while the server is open.
+         * 'open()' fails with 'invalid_argument' if the runtime has fewer threads than shards * io_threads.
+         *
+         * @param runtime Runtime hosting the server run loops. Must outlive the server.
+         *
+         * @par Example
+         * @code
+         * runtime_c runtime({ 4, "server", { 0xF0 } });
+         * http_server_ssl_c server(runtime, {});
+         * @endcode
+         */
+        http_server_ssl_c(runtime_c &runtime, const security_context_opts sec_opts = {}): runtime(runtime) {
             if (!sec_opts.private_key.empty()) {
                 const asio::const_buffer buffer(sec_opts.private_key.data(), sec_opts.private_key.size());
                 net.ssl_context.use_private_key(buffer, sec_opts.file_format);
@@ -567,7 +958,7 @@ namespace internetprotocol {
             }
         }
         ~http_server_ssl_c() {
-            if (net.acceptor.is_open())
+            if (net.acceptor.is_open() || draining.load())
                 close();
         }
 
@@ -605,6 +996,23 @@ namespace internetprotocol {
          */
         int backlog = 2147483647;
 
+        /**
+         * Set/Get the number of threads running the server io_context.
+         *
+         * Every accepted connection is bound to its own strand, so the handlers of a single
+         * connection never run concurrently even when io_threads is greater than 1.
+         * Values lower than 1 are treated as 1. Must be set before 'open()'.
+         *
+         * @par Example
+         * @code
+         * http_server_ssl_c server({});
+         * // Spread accepts, reads and callbacks over 4 threads
+         * server.io_threads = 4;
+         * server.open({"", 8080});
+         * @endcode
+         */
+        uint16_t io_threads = 1;
+
         /**
          * Return true if socket is open.
          *
@@ -629,13 +1037,13 @@ namespace internetprotocol {
         tcp::endpoint local_endpoint() const { return net.acceptor.local_endpoint(); }
 
         /**
-         * Gets a constant reference to the set of clients connected to the server.
+         * Gets a copy of the set of clients connected to the server.
          *
          * This method returns a std::set containing shared pointers to all tcp_remote_c
-         * clients currently connected to the server. Useful for monitoring active
+         * clients currently connected to the server, across every shard. Useful for monitoring active
          * connections or performing operations on all connected clients.
          *
-         * @return A constant reference to the std::set of connected clients.
+         * @return A std::set with the connected clients.
          *
          * @par Example
          * @code
@@ -654,7 +1062,88 @@ namespace internetprotocol {
          * }
          * @endcode
          */
-        const std::set<std::shared_ptr<http_remote_ssl_c>> &clients() const { return net.ssl_clients; }
+        std::set<std::shared_ptr<http_remote_ssl_c>> clients() {
+            std::set<std::shared_ptr<http_remote_ssl_c>> all_clients;
+            for_each([&](const std::shared_ptr<http_remote_ssl_c> &client) {
+                all_clients.insert(client);
+            });
+            return all_clients;
+        }
+
+        /**
+         * Return the client with the connection id 'id', or nullptr if it is no longer connected.
+         * The lookup is O(1) and thread-safe. The id of a client is returned by its 'get_id()'.
+         *
+         * @par Example
+         * @code
+         * http_server_ssl_c server;
+         *
+         * std::shared_ptr<http_remote_ssl_c> client = server.find(id);
+         * if (client)
+         *     client->write("...");
+         * @endcode
+         */
+        std::shared_ptr<http_remote_ssl_c> find(const connection_id_t id) {
+            tcp_server_ssl_t<http_remote_ssl_c> *shard = shard_of(id);
+            if (!shard)
+                return nullptr;
+
+            std::lock_guard guard(shard->clients_mutex);
+            return shard->ssl_clients.find(id);
+        }
+
+        /**
+         * Call 'fn' for every connected client, across every shard.
+         * The clients are collected under the registry locks and 'fn' runs after they are released,
+         * so it may write to or close the clients.
+         *
+         * @par Example
+         * @code
+         * http_server_ssl_c server;
+         *
+         * server.for_each([&](const std::shared_ptr<http_remote_ssl_c> &client) {
+         *     // your code...
+         * });
+         * @endcode
+         */
+        void for_each(const std::function<void(const std::shared_ptr<http_remote_ssl_c> &)> &fn) {
+            std::vector<std::shared_ptr<http_remote_ssl_c>> all_clients;
+            {
+                std::lock_guard guard(net.clients_mutex);
+                all_clients.reserve(net.ssl_clients.size());
+                net.ssl_clients.for_each([&](const std::shared_ptr<http_remote_ssl_c> &client) { all_clients.push_back(client); });
+            }
+            for (const std::unique_ptr<tcp_server_ssl_t<http_remote_ssl_c>> &shard : net.shards) {
+                std::lock_guard guard(shard->clients_mutex);
+                shard->ssl_clients.for_each([&](const std::shared_ptr<http_remote_ssl_c> &client) { all_clients.push_back(client); });
+            }
+            for (const std::shared_ptr<http_remote_ssl_c> &client : all_clients)
+                fn(client);
+        }
+
+        /**
+         * Run 'fn' on the strand of the client with the connection id 'id', so it never races the client's own handlers.
+         * It can be called from any thread. It returns false if the client is no longer connected.
+         *
+         * @par Example
+         * @code
+         * http_server_ssl_c server;
+         *
+         * server.post_to(id, [](const std::shared_ptr<http_remote_ssl_c> &client) {
+         *     // your code...
+         * });
+         * @endcode
+         */
+        bool post_to(const connection_id_t id, const std::function<void(const std::shared_ptr<http_remote_ssl_c> &)> &fn) {
+            std::shared_ptr<http_remote_ssl_c> client = find(id);
+            if (!client || !fn)
+                return false;
+
+            asio::post(client->get_socket().get_executor(), [client, fn]() {
+                fn(client);
+            });
+            return true;
+        }
 
         /**
          * Return a const ref of the latest error code returned by asio.
@@ -851,83 +1340,120 @@ namespace internetprotocol {
          * @endcode
          */
         bool open(const server_bind_options_t &bind_opts = { "", 8080, v4, true }) {
-            if (net.acceptor.is_open())
+            if (net.acceptor.is_open() || draining.load())
                 return false;
 
-            net.acceptor.open(bind_opts.protocol == v4
-                                  ? tcp::v4()
-                                  : tcp::v6(),
-                                  error_code);
+            bind_options = bind_opts;
+            admission.reset(bind_opts.admission);
 
-            if (error_code && on_error) {
-                std::lock_guard guard(mutex_error);
-                on_error(error_code);
+            const bool listening = bind_opts.listen_handles.empty() ? bind_listeners(bind_opts) : adopt_listeners(bind_opts);
+            if (!listening)
                 return false;
-            }
 
-            net.acceptor.set_option(asio::socket_base::reuse_address(bind_opts.reuse_address), error_code);
-            if (error_code && on_error) {
+            // Every run loop blocks a runtime thread until the server closes, a loop with no thread left never runs
+            const uint16_t threads = io_threads > 0 ? io_threads : 1;
+            if (runtime.thread_count() < threads * (net.shards.size() + 1)) {
+                asio::error_code ec;
+                net.acceptor.close(ec);
+                net.shards.clear();
                 std::lock_guard guard(mutex_error);
-                on_error(error_code);
+                error_code = asio::error::invalid_argument;
+                if (on_error) on_error(error_code);
                 return false;
             }
 
-            const tcp::endpoint endpoint = bind_opts.address.empty() ?
-                                        tcp::endpoint(bind_opts.protocol == v4
-                                                        ? tcp::v4()
-                                                        : tcp::v6(),
-                                                        bind_opts.port) :
-                                        tcp::endpoint(make_address(bind_opts.address), bind_opts.port);
+            error_code.clear();
+            running_threads.store(static_cast<uint32_t>(threads * (net.shards.size() + 1)));
+            start_shard(net, threads);
+            for (const std::unique_ptr<tcp_server_ssl_t<http_remote_ssl_c>> &shard : net.shards)
+                start_shard(*shard, threads);
+            return true;
+        }
 
-            net.acceptor.bind(endpoint, error_code);
-            if (error_code && on_error) {
-                std::lock_guard guard(mutex_error);
-                on_error(error_code);
-                return false;
+        /**
+         * Return the listening sockets of every shard, to hand them over to the process replacing this one
+         * with 'listen_handoff_c' or 'export_listen_handles()'. They stay owned by the server, the other process gets copies
+         * and keeps accepting on them after this server closes. Empty if the server is not open.
+         *
+         * @par Example
+         * @code
+         * http_server_ssl_c server({});
+         * std::vector<tcp::acceptor::native_handle_type> handles = server.listen_handles();
+         * @endcode
+         */
+        std::vector<tcp::acceptor::native_handle_type> listen_handles() {
+            std::vector<tcp::acceptor::native_handle_type> handles;
+            if (!net.acceptor.is_open())
+                return handles;
+
+            handles.push_back(net.acceptor.native_handle());
+            for (const std::unique_ptr<tcp_server_ssl_t<http_remote_ssl_c>> &shard : net.shards) {
+                if (shard->acceptor.is_open())
+                    handles.push_back(shard->acceptor.native_handle());
             }
+            return handles;
+        }
 
-            net.acceptor.listen(backlog, error_code);
-            if (error_code && on_error) {
-                std::lock_guard guard(mutex_error);
-                on_error(error_code);
+        /**
+         * Stop accepting and let the connected clients finish before closing. 'on_close' event will be triggered once every client is gone.
+         * Requests already being handled get their response, sent with 'Connection: close', and idle clients are closed.
+         * Clients still connected when 'timeout' expires are closed. Returns false if the server is not open or is already draining.
+         *
+         * @param timeout Time given to the clients to finish.
+         *
+         * @par Example
+         * @code
+         * http_server_ssl_c server({});
+         * server.on_close = [&]() {
+         *      // every client has been disconnected
+         * };
+         * server.drain(std::chrono::seconds(30));
+         * @endcode
+         */
+        bool drain(const std::chrono::steady_clock::duration timeout) {
+            if (!net.acceptor.is_open() || draining.exchange(true))
                 return false;
-            }
 
-            asio::post(thread_pool, [&]{ run_context_thread(); });
+            {
+                std::lock_guard guard(mutex_drain);
+                drain_timer.expires_after(timeout);
+                drain_timer.async_wait([&](const asio::error_code &ec) {
+                    if (!ec && draining.load())
+                        drain_expired();
+                });
+            }
+            for (const std::unique_ptr<tcp_server_ssl_t<http_remote_ssl_c>> &shard : net.shards)
+                stop_accepting(*shard);
+            stop_accepting(net);
+            for_each([](const std::shared_ptr<http_remote_ssl_c> &client) {
+                asio::post(client->get_socket().get_executor(), [client]() {
+                    client->close_after_response();
+                });
+            });
+            // Clients closing from now on cancel the deadline when they are the last one
+            if (admission.live_connections() == 0)
+                cancel_drain_timer();
             return true;
         }
 
         /**
          * Close the underlying socket and stop listening for data on it. 'on_close' event will be triggered.
          *
-         * @param force Cancel all asynchronous operations associated with the client sockets if true.
-         *
          * @par Example
          * @code
          * http_server_ssl_c server;
-         * server.close(false);
+         * server.close();
          * @endcode
          */
         void close() {
             is_closing.store(true);
-            if (net.acceptor.is_open()) {
-                std::lock_guard guard(mutex_error);
-                net.acceptor.close(error_code);
-                if (on_error) on_error(error_code);
-            }
-            if (!net.ssl_clients.empty()) {
-                std::lock_guard guard(mutex_error);
-                for (const auto &client : net.ssl_clients) {
-                    if (client)
-                        client->close();
-                }
-                net.ssl_clients.clear();
-            }
-            net.context.stop();
-            net.context.restart();
-            net.acceptor = tcp::acceptor(net.context);
+            cancel_drain_timer();
+            for (const std::unique_ptr<tcp_server_ssl_t<http_remote_ssl_c>> &shard : net.shards)
+                close_shard(*shard);
+            close_shard(net);
             if (on_close)
                 on_close();
+            draining.store(false);
             is_closing.store(false);
         }
 
@@ -960,11 +1486,17 @@ namespace internetprotocol {
         std::function<void(const asio::error_code &)> on_error;
 
     private:
-        std::mutex mutex_io;
         std::mutex mutex_error;
+        runtime_c &runtime = default_runtime();
         std::atomic<bool> is_closing = false;
+        std::atomic<uint32_t> running_threads = 0;
         tcp_server_ssl_t<http_remote_ssl_c> net;
         asio::error_code error_code;
+        server_bind_options_t bind_options;
+        admission_control_c admission;
+        std::atomic<bool> draining = false;
+        std::mutex mutex_drain;
+        asio::steady_timer drain_timer{net.context};
 
         std::map<std::string, std::function<void(const http_request_t &, const std::shared_ptr<http_remote_ssl_c> &)>> all_cb;
         std::map<std::string, std::function<void(const http_request_t &, const std::shared_ptr<http_remote_ssl_c> &)>> get_cb;
@@ -975,48 +1507,268 @@ namespace internetprotocol {
         std::map<std::string, std::function<void(const http_request_t &, const std::shared_ptr<http_remote_ssl_c> &)>> options_cb;
         std::map<std::string, std::function<void(const http_request_t &, const std::shared_ptr<http_remote_ssl_c> &)>> patch_cb;
 
-        void run_context_thread() {
-            std::lock_guard guard(mutex_io);
-            error_code.clear();
-            std::shared_ptr<http_remote_ssl_c> client_socket = std::make_shared<http_remote_ssl_c>(net.context, net.ssl_context, iddle_timeout);
-            net.acceptor.async_accept(client_socket->get_socket().lowest_layer(),
+        // Shard that handed out 'id', see connection_id_t
+        tcp_server_ssl_t<http_remote_ssl_c> *shard_of(const connection_id_t id) {
+            const uint16_t index = connection_shard(id);
+            if (index == 0)
+                return &net;
+            if (index > net.shards.size())
+                return nullptr;
+            return net.shards[index - 1].get();
+        }
+
+        void run_context_thread(tcp_server_ssl_t<http_remote_ssl_c> &shard) {
+            run_context(shard.context, bind_options.busy_poll_us);
+            if (running_threads.fetch_sub(1) == 1 && !is_closing.load())
+                close();
+        }
+
+        // Open and bind the acceptor of every shard
+        bool bind_listeners(const server_bind_options_t &bind_opts) {
+            const tcp::endpoint endpoint = bind_opts.address.empty() ?
+                                        tcp::endpoint(bind_opts.protocol == v4
+                                                        ? tcp::v4()
+                                                        : tcp::v6(),
+                                                        bind_opts.port) :
+                                        tcp::endpoint(make_address(bind_opts.address), bind_opts.port);
+
+#ifdef SO_REUSEPORT
+            const bool reuse_port = bind_opts.shards > 1;
+#else
+            const bool reuse_port = false;
+#endif
+            if (!open_acceptor(net.acceptor, bind_opts, endpoint, reuse_port))
+                return false;
+
+            net.shards.clear();
+            if (reuse_port) {
+                // Every shard binds the port picked by the first acceptor, so port 0 works too
+                const tcp::endpoint shard_endpoint = net.acceptor.local_endpoint();
+                for (uint16_t i = 1; i < bind_opts.shards; ++i) {
+                    net.shards.push_back(std::make_unique<tcp_server_ssl_t<http_remote_ssl_c>>());
+                    net.shards.back()->ssl_clients.set_shard(i);
+                    if (!open_acceptor(net.shards.back()->acceptor, bind_opts, shard_endpoint, reuse_port)) {
+                        asio::error_code ec;
+                        net.acceptor.close(ec);
+                        net.shards.clear();
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+
+        // Serve on sockets that are listening already, one shard each
+        bool adopt_listeners(const server_bind_options_t &bind_opts) {
+            net.shards.clear();
+            for (size_t i = 0; i < bind_opts.listen_handles.size(); ++i) {
+                if (i > 0) {
+                    net.shards.push_back(std::make_unique<tcp_server_ssl_t<http_remote_ssl_c>>());
+                    net.shards.back()->ssl_clients.set_shard(static_cast<uint16_t>(i));
+                }
+                tcp::acceptor &acceptor = i == 0 ? net.acceptor : net.shards.back()->acceptor;
+                if (!adopt_acceptor(acceptor, bind_opts.listen_handles[i], backlog, error_code)) {
+                    {
+                        std::lock_guard guard(mutex_error);
+                        if (on_error) on_error(error_code);
+                    }
+                    // The handles belong to the server, close the ones adopted so far and the ones left
+                    asio::error_code ec;
+                    net.acceptor.close(ec);
+                    net.shards.clear();
+                    for (size_t j = i; j < bind_opts.listen_handles.size(); ++j) {
+                        asio::detail::socket_ops::state_type state = 0;
+                        asio::detail::socket_ops::close(bind_opts.listen_handles[j], state, true, ec);
+                    }
+                    return false;
+                }
+                set_busy_poll(acceptor, bind_opts.so_busy_poll_us);
+                set_listener_options(acceptor, bind_opts.socket_options);
+            }
+            return true;
+        }
+
+        bool open_acceptor(tcp::acceptor &acceptor, const server_bind_options_t &bind_opts,
+                           const tcp::endpoint &endpoint, const bool reuse_port) {
+            acceptor.open(bind_opts.protocol == v4
+                          ? tcp::v4()
+                          : tcp::v6(),
+                          error_code);
+            if (error_code) {
+                std::lock_guard guard(mutex_error);
+                if (on_error) on_error(error_code);
+                return false;
+            }
+
+            acceptor.set_option(asio::socket_base::reuse_address(bind_opts.reuse_address), error_code);
+            if (error_code) {
+                std::lock_guard guard(mutex_error);
+                if (on_error) on_error(error_code);
+                return false;
+            }
+            set_busy_poll(acceptor, bind_opts.so_busy_poll_us);
+            set_listener_options(acceptor, bind_opts.socket_options);
+
+#ifdef SO_REUSEPORT
+            if (reuse_port) {
+                acceptor.set_option(reuse_port_t(true), error_code);
+                if (error_code) {
+                    std::lock_guard guard(mutex_error);
+                    if (on_error) on_error(error_code);
+                    return false;
+                }
+            }
+#endif
+
+            acceptor.bind(endpoint, error_code);
+            if (error_code) {
+                std::lock_guard guard(mutex_error);
+                if (on_error) on_error(error_code);
+                return false;
+            }
+
+            acceptor.listen(backlog, error_code);
+            if (error_code) {
+                std::lock_guard guard(mutex_error);
+                if (on_error) on_error(error_code);
+                return false;
+            }
+            return true;
+        }
+
+        // Arm one more accept, with the connection object it will hand the socket to constructed up front.
+        // 'client_socket' reuses the one of a rejected connection.
+        void async_accept(tcp_server_ssl_t<http_remote_ssl_c> &shard, std::shared_ptr<http_remote_ssl_c> client_socket = nullptr) {
+            const std::chrono::steady_clock::duration delay = admission.reserve_accept();
+            if (delay > std::chrono::steady_clock::duration::zero()) {
+                // Out of accept tokens, arm it once the bucket has refilled
+                std::shared_ptr<asio::steady_timer> timer = std::make_shared<asio::steady_timer>(shard.context, delay);
+                timer->async_wait([&, timer, client_socket](const asio::error_code &ec) {
+                    if (!ec && shard.acceptor.is_open())
+                        async_accept(shard, client_socket);
+                });
+                return;
+            }
+            if (!client_socket)
+                client_socket = std::make_shared<http_remote_ssl_c>(shard.context, net.ssl_context, iddle_timeout);
+            shard.acceptor.async_accept(client_socket->get_socket().lowest_layer(),
                                         [&, client_socket](const asio::error_code &ec) {
-                                            accept(ec, client_socket);
+                                            accept(ec, client_socket, shard);
                                         });
-            net.context.run();
-            if (!is_closing.load())
-                close();
         }
 
-        void accept(const asio::error_code &error, const std::shared_ptr<http_remote_ssl_c> &client) {
+        void start_shard(tcp_server_ssl_t<http_remote_ssl_c> &shard, const uint16_t threads) {
+            for (uint16_t i = 0; i < std::max<uint16_t>(bind_options.pending_accepts, 1); ++i)
+                async_accept(shard);
+            for (uint16_t i = 0; i < threads; ++i)
+                asio::post(runtime.get_executor(), [&]{ run_context_thread(shard); });
+        }
+
+        void close_shard(tcp_server_ssl_t<http_remote_ssl_c> &shard) {
+            if (shard.acceptor.is_open()) {
+                std::lock_guard guard(mutex_error);
+                shard.acceptor.close(error_code);
+                if (on_error) on_error(error_code);
+            }
+            std::vector<std::shared_ptr<http_remote_ssl_c>> clients_to_close;
+            {
+                std::lock_guard guard(shard.clients_mutex);
+                clients_to_close = shard.ssl_clients.take_all();
+            }
+            if (!clients_to_close.empty()) {
+                std::lock_guard guard(mutex_error);
+                for (const auto &client : clients_to_close) {
+                    if (client)
+                        client->close();
+                }
+            }
+            shard.context.stop();
+            shard.context.restart();
+            shard.acceptor = tcp::acceptor(shard.context);
+        }
+
+        // Close the acceptor of 'shard' and leave its clients connected
+        void stop_accepting(tcp_server_ssl_t<http_remote_ssl_c> &shard) {
+            if (!shard.acceptor.is_open())
+                return;
+            std::lock_guard guard(mutex_error);
+            shard.acceptor.close(error_code);
+            if (error_code && on_error) on_error(error_code);
+        }
+
+        void cancel_drain_timer() {
+            std::lock_guard guard(mutex_drain);
+            drain_timer.cancel();
+        }
+
+        // Drain deadline: close whatever is still connected
+        void drain_expired() {
+            for_each([](const std::shared_ptr<http_remote_ssl_c> &client) {
+                asio::post(client->get_socket().get_executor(), [client]() {
+                    client->close();
+                    if (client->on_close) client->on_close();
+                });
+            });
+        }
+
+        void accept(const asio::error_code &error, const std::shared_ptr<http_remote_ssl_c> &client, tcp_server_ssl_t<http_remote_ssl_c> &shard) {
             if (error) {
                 std::lock_guard guard(mutex_error);
                 error_code = error;
                 if (!is_closing.load())
                     client->close();
                 if (on_error) on_error(error_code);
-                if (net.acceptor.is_open()) {
-                    std::shared_ptr<http_remote_ssl_c> client_socket = std::make_shared<http_remote_ssl_c>(net.context, net.ssl_context, iddle_timeout);
-                    net.acceptor.async_accept(client_socket->get_socket().lowest_layer(),
-                                                [&, client_socket](const asio::error_code &ec) {
-                                                    accept(ec, client_socket);
-                                                });
-                }
+                if (shard.acceptor.is_open())
+                    async_accept(shard);
                 return;
             }
+            asio::error_code endpoint_error;
+            const asio::ip::address address = client->get_socket().lowest_layer().remote_endpoint(endpoint_error).address();
+            if (endpoint_error || !admission.admit(address)) {
+                // Over a limit: drop it before anything is set up for it, its remote takes the next connection
+                client->get_socket().lowest_layer().close(endpoint_error);
+                if (shard.acceptor.is_open())
+                    async_accept(shard, client);
+                return;
+            }
+            set_socket_options(client->get_socket().lowest_layer(), bind_options.socket_options);
+            connection_id_t id;
+            {
+                std::lock_guard guard(shard.clients_mutex);
+                id = shard.ssl_clients.insert(client);
+            }
+            if (id == 0) {
+                // Registry full: its close could not find it, so its admission slots would never be given back
+                asio::error_code ec;
+                client->get_socket().lowest_layer().close(ec);
+                admission.release(address);
+                if (shard.acceptor.is_open())
+                    async_accept(shard, client);
+                return;
+            }
+            client->set_id(id);
             client->on_request = [&, client](const http_request_t &request) {
                 read_cb(request, client);
             };
-            client->on_close = [&, client]() { net.ssl_clients.erase(client); };
-            net.ssl_clients.insert(client);
+            client->on_close = [&, client, address]() {
+                bool registered;
+                {
+                    std::lock_guard guard(shard.clients_mutex);
+                    registered = shard.ssl_clients.erase(client->get_id());
+                }
+                // 'on_close' may run more than once, the connection is given back only the first time
+                if (registered) {
+                    admission.release(address);
+                    if (draining.load() && admission.live_connections() == 0)
+                        cancel_drain_timer();
+                }
+            };
             client->connect();
-            if (net.acceptor.is_open()) {
-                std::shared_ptr<http_remote_ssl_c> client_socket = std::make_shared<http_remote_ssl_c>(net.context, net.ssl_context, iddle_timeout);
-                net.acceptor.async_accept(client_socket->get_socket().lowest_layer(),
-                                        [&, client_socket](const asio::error_code &ec) {
-                                            accept(ec, client_socket);
-                                        });
-            }
+            // Accepted while draining, after 'drain()' went over the clients
+            if (draining.load())
+                client->close_after_response();
+            if (shard.acceptor.is_open())
+                async_accept(shard);
         }
 
         void read_cb(const http_request_t &request, const std::shared_ptr<http_remote_ssl_c> &client) {
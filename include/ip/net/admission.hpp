@@ -0,0 +1,140 @@
+/**
+ * MIT License (MIT)
+ * Copyright © 2025 Nathan Miguel
+*/
+
+#pragma once
+
+#include <asio.hpp>
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+
+namespace internetprotocol {
+    /**
+     * Limits on the connections a server admits. Every limit is disabled by 0.
+     *
+     * @par Example
+     * @code
+     * server_bind_options_t options;
+     * options.admission.max_connections = 50000;
+     * options.admission.max_connections_per_address = 32;
+     * options.admission.accept_rate = 2000;
+     * @endcode
+     */
+    struct admission_options_t {
+        /// Live connections across every shard. Connections over it are accepted and closed at once.
+        uint32_t max_connections = 0;
+        /// Live connections from a single source address. Connections over it are accepted and closed at once.
+        uint32_t max_connections_per_address = 0;
+        /// Connections accepted per second. When the token bucket is empty the acceptors wait for the next token,
+        /// leaving new connections in the listen backlog.
+        uint32_t accept_rate = 0;
+        /// Connections accepted back to back after a quiet period. 0 uses 'accept_rate'.
+        uint32_t accept_burst = 0;
+    };
+
+    /**
+     * Connection counters and accept token bucket shared by every shard of a server.
+     * Each accept takes a token before it is armed, which paces the acceptors instead of refusing connections.
+     * 'admit' runs right after accept returns, before the connection is registered or its TLS handshake starts.
+     */
+    class admission_control_c {
+    public:
+        /// Apply 'options' and forget the previous counters. Called when the server opens.
+        void reset(const admission_options_t &options) {
+            std::lock_guard guard(mutex_admission);
+            admission = options;
+            connections = 0;
+            per_address.clear();
+            tokens = static_cast<double>(burst());
+            last_refill = std::chrono::steady_clock::now();
+        }
+
+        /**
+         * Count a new connection from 'address'. Returns false if it is over a limit.
+         * Every admitted connection must be given back with 'release' once it closes.
+         */
+        bool admit(const asio::ip::address &address) {
+            std::lock_guard guard(mutex_admission);
+            if (admission.max_connections > 0 && connections >= admission.max_connections)
+                return false;
+
+            uint32_t *from_address = nullptr;
+            if (admission.max_connections_per_address > 0) {
+                from_address = &per_address[address];
+                if (*from_address >= admission.max_connections_per_address)
+                    return false;
+            }
+
+            ++connections;
+            if (from_address)
+                ++*from_address;
+            return true;
+        }
+
+        /// Give back a connection counted by 'admit'.
+        void release(const asio::ip::address &address) {
+            std::lock_guard guard(mutex_admission);
+            if (connections > 0)
+                --connections;
+            const auto it = per_address.find(address);
+            if (it != per_address.end() && --it->second == 0)
+                per_address.erase(it);
+        }
+
+        /**
+         * Take a token for the next accept. Returns zero if one was taken, or the time until the bucket holds one again.
+         * Always zero when the rate is unlimited.
+         */
+        std::chrono::steady_clock::duration reserve_accept() {
+            std::lock_guard guard(mutex_admission);
+            if (admission.accept_rate == 0)
+                return std::chrono::steady_clock::duration::zero();
+
+            refill();
+            if (tokens >= 1.0) {
+                tokens -= 1.0;
+                return std::chrono::steady_clock::duration::zero();
+            }
+            return std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>((1.0 - tokens) / admission.accept_rate));
+        }
+
+        /// Number of admitted connections still open.
+        uint32_t live_connections() {
+            std::lock_guard guard(mutex_admission);
+            return connections;
+        }
+
+    private:
+        struct address_hash_t {
+            size_t operator()(const asio::ip::address &address) const {
+                if (address.is_v4())
+                    return std::hash<uint32_t>()(address.to_v4().to_uint());
+                const asio::ip::address_v6::bytes_type bytes = address.to_v6().to_bytes();
+                return std::hash<std::string_view>()(std::string_view(reinterpret_cast<const char *>(bytes.data()), bytes.size()));
+            }
+        };
+
+        std::mutex mutex_admission;
+        admission_options_t admission;
+        uint32_t connections = 0;
+        std::unordered_map<asio::ip::address, uint32_t, address_hash_t> per_address;
+        double tokens = 0.0;
+        std::chrono::steady_clock::time_point last_refill;
+
+        uint32_t burst() const {
+            return admission.accept_burst > 0 ? admission.accept_burst : std::max<uint32_t>(admission.accept_rate, 1);
+        }
+
+        void refill() {
+            const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            const double elapsed = std::chrono::duration<double>(now - last_refill).count();
+            last_refill = now;
+            tokens = std::min(static_cast<double>(burst()), tokens + elapsed * admission.accept_rate);
+        }
+    };
+}
@@ -0,0 +1,304 @@
+/**
+ * MIT License (MIT)
+ * Copyright © 2025 Nathan Miguel
+*/
+
+#pragma once
+
+#include <asio.hpp>
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <streambuf>
+#include <type_traits>
+#include <vector>
+
+namespace internetprotocol {
+    /**
+     * Size-classed pool of byte blocks shared by every connection of an execution context.
+     * Each context gets a single instance through asio::use_service.
+     * Receive buffers and encoded frames are taken from the pool and handed back once they are drained or sent,
+     * so memory follows the traffic in flight instead of the number of open connections.
+     * Blocks are not registered with io_uring (asio::register_buffers()) under ASIO_HAS_IO_URING: asio only uses registered
+     * buffers for descriptor and file operations, socket operations go through recvmsg/sendmsg which cannot use them,
+     * and a registration is fixed for the io_context while pooled blocks come and go.
+     */
+    class buffer_pool_c : public asio::execution_context::service {
+    public:
+        static inline asio::execution_context::id id;
+
+        /// Smallest block size. Size classes double from here up to 'max_block_size'.
+        static constexpr size_t min_block_size = 512;
+        static constexpr size_t size_classes = 12;
+        /// Largest pooled block (1 MiB). Bigger requests are allocated and freed directly.
+        static constexpr size_t max_block_size = min_block_size << (size_classes - 1);
+        /// Largest block a receive buffer asks for up front, matching the largest single read asio issues.
+        static constexpr size_t max_read_block_size = 64 * 1024;
+
+        explicit buffer_pool_c(asio::execution_context &context): asio::execution_context::service(context) {
+        }
+
+        /// Return the pool of the execution context that runs 'executor'.
+        template<typename Executor>
+        static buffer_pool_c &get(const Executor &executor) {
+            return asio::use_service<buffer_pool_c>(asio::query(executor, asio::execution::context));
+        }
+
+        /// Bytes kept in the free list of each size class. Blocks released beyond it are freed.
+        size_t max_cached_bytes = 4 * 1024 * 1024;
+
+        /**
+         * Take an empty block with a capacity of at least 'size' bytes.
+         */
+        std::vector<uint8_t> acquire(const size_t size) {
+            std::vector<uint8_t> block;
+            if (size > max_block_size) {
+                block.reserve(size);
+                return block;
+            }
+
+            const size_t index = class_of(size);
+            {
+                std::lock_guard guard(mutex_pool);
+                std::vector<std::vector<uint8_t>> &free_list = free_blocks[index];
+                if (!free_list.empty()) {
+                    block = std::move(free_list.back());
+                    free_list.pop_back();
+                }
+            }
+            block.clear();
+            if (block.capacity() < class_size(index))
+                block.reserve(class_size(index));
+            return block;
+        }
+
+        /**
+         * Give a block back to the pool. Its contents are discarded.
+         */
+        void release(std::vector<uint8_t> &&block) {
+            const size_t capacity = block.capacity();
+            if (capacity < min_block_size || capacity > max_block_size)
+                return;
+
+            // Round down so every block of a class holds at least its class size
+            size_t index = 0;
+            while (index + 1 < size_classes && class_size(index + 1) <= capacity)
+                ++index;
+
+            std::lock_guard guard(mutex_pool);
+            std::vector<std::vector<uint8_t>> &free_list = free_blocks[index];
+            if ((free_list.size() + 1) * class_size(index) > max_cached_bytes)
+                return;
+
+            free_list.push_back(std::move(block));
+        }
+
+    private:
+        std::mutex mutex_pool;
+        std::array<std::vector<std::vector<uint8_t>>, size_classes> free_blocks;
+
+        void shutdown() override {
+            std::lock_guard guard(mutex_pool);
+            for (std::vector<std::vector<uint8_t>> &free_list : free_blocks)
+                free_list.clear();
+        }
+
+        static constexpr size_t class_size(const size_t index) {
+            return min_block_size << index;
+        }
+
+        static size_t class_of(const size_t size) {
+            size_t index = 0;
+            while (class_size(index) < size)
+                ++index;
+            return index;
+        }
+    };
+
+    /**
+     * Receive buffer backed by a buffer_pool_c block.
+     * It behaves like asio::streambuf, so it can be read with std::istream, but the block goes back to the pool
+     * as soon as all of its data has been consumed. A drained connection holds no receive memory.
+     */
+    class pooled_streambuf_c : public std::streambuf {
+    public:
+        explicit pooled_streambuf_c(buffer_pool_c &pool): pool(pool) {
+        }
+
+        pooled_streambuf_c(const pooled_streambuf_c &) = delete;
+        pooled_streambuf_c &operator=(const pooled_streambuf_c &) = delete;
+
+        ~pooled_streambuf_c() override {
+            release();
+        }
+
+        /**
+         * Lightweight DynamicBuffer_v1 view passed to asio read operations.
+         */
+        class dynamic_buffer_t {
+        public:
+            typedef asio::const_buffer const_buffers_type;
+            typedef asio::mutable_buffer mutable_buffers_type;
+
+            explicit dynamic_buffer_t(pooled_streambuf_c &buffer): buffer(buffer) {
+            }
+
+            size_t size() const { return buffer.size(); }
+            size_t max_size() const { return buffer.max_size(); }
+            size_t capacity() const { return buffer.capacity(); }
+            const_buffers_type data() const { return buffer.data(); }
+            mutable_buffers_type prepare(const size_t n) { return buffer.prepare(n); }
+            void commit(const size_t n) { buffer.commit(n); }
+            void consume(const size_t n) { buffer.consume(n); }
+
+        private:
+            pooled_streambuf_c &buffer;
+        };
+
+        dynamic_buffer_t dynamic() { return dynamic_buffer_t(*this); }
+
+        size_t size() const { return pptr() - gptr(); }
+
+        size_t max_size() const { return std::numeric_limits<size_t>::max(); }
+
+        size_t capacity() const { return block.capacity(); }
+
+        asio::const_buffer data() const { return asio::const_buffer(gptr(), size()); }
+
+        asio::mutable_buffer prepare(const size_t n) {
+            reserve(n);
+            reading = true;
+            prepared_size = n;
+            return asio::mutable_buffer(pptr(), n);
+        }
+
+        void commit(size_t n) {
+            reading = false;
+            // A read that filled everything it was given asks for a bigger block next time
+            if (n >= prepared_size)
+                preferred_size = std::min(preferred_size * 2, buffer_pool_c::max_read_block_size);
+            n = std::min<size_t>(n, epptr() - pptr());
+            pbump(static_cast<int>(n));
+            setg(eback(), gptr(), pptr());
+            // Nothing arrived, e.g. the read failed
+            if (size() == 0)
+                release();
+        }
+
+        void consume(size_t n) {
+            if (egptr() < pptr())
+                setg(eback(), gptr(), pptr());
+            n = std::min<size_t>(n, pptr() - gptr());
+            gbump(static_cast<int>(n));
+            if (size() == 0 && !reading)
+                release();
+        }
+
+    protected:
+        int_type underflow() override {
+            if (gptr() < pptr()) {
+                setg(eback(), gptr(), pptr());
+                return traits_type::to_int_type(*gptr());
+            }
+            if (!reading)
+                release();
+            return traits_type::eof();
+        }
+
+        int_type overflow(const int_type c) override {
+            if (traits_type::eq_int_type(c, traits_type::eof()))
+                return traits_type::not_eof(c);
+
+            reserve(1);
+            *pptr() = traits_type::to_char_type(c);
+            pbump(1);
+            setg(eback(), gptr(), pptr());
+            return c;
+        }
+
+    private:
+        buffer_pool_c &pool;
+        std::vector<uint8_t> block;
+        // Capacity of the last block, so a busy stream does not start over from the smallest class
+        size_t preferred_size = buffer_pool_c::min_block_size;
+        size_t prepared_size = 0;
+        bool reading = false;
+
+        char *base() { return reinterpret_cast<char *>(block.data()); }
+
+        void reset_pointers(const size_t get_offset, const size_t put_offset) {
+            setg(base(), base() + get_offset, base() + put_offset);
+            setp(base() + put_offset, base() + block.size());
+        }
+
+        // Make room for 'n' more bytes after the data, moving it to the front or to a bigger block when needed
+        void reserve(const size_t n) {
+            const size_t data_size = size();
+            if (block.empty()) {
+                block = pool.acquire(std::max(n, preferred_size));
+                block.resize(block.capacity());
+                reset_pointers(0, 0);
+                return;
+            }
+
+            if (static_cast<size_t>(epptr() - pptr()) >= n)
+                return;
+
+            const size_t get_offset = gptr() - eback();
+            if (get_offset + (epptr() - pptr()) >= n && data_size > 0) {
+                std::memmove(base(), gptr(), data_size);
+                reset_pointers(0, data_size);
+                return;
+            }
+            if (data_size == 0 && block.size() >= n) {
+                reset_pointers(0, 0);
+                return;
+            }
+
+            std::vector<uint8_t> bigger = pool.acquire(data_size + n);
+            bigger.resize(bigger.capacity());
+            if (data_size > 0)
+                std::memcpy(bigger.data(), gptr(), data_size);
+            pool.release(std::move(block));
+            block = std::move(bigger);
+            reset_pointers(0, data_size);
+        }
+
+        void release() {
+            if (block.empty())
+                return;
+
+            preferred_size = std::max(preferred_size, std::min(block.capacity(), buffer_pool_c::max_read_block_size));
+            pool.release(std::move(block));
+            block = std::vector<uint8_t>();
+            setg(nullptr, nullptr, nullptr);
+            setp(nullptr, nullptr);
+        }
+    };
+
+    /**
+     * Read at least one byte from 'stream' into 'buffer'.
+     * On plain TCP sockets with nothing buffered it first waits for the socket to become readable,
+     * so no block is taken from the pool while the connection is idle. TLS streams read directly,
+     * because the TLS layer may already hold decrypted data the socket cannot report.
+     */
+    template<typename Stream, typename Handler>
+    void async_read_pooled(Stream &stream, pooled_streambuf_c &buffer, Handler handler) {
+        if constexpr (std::is_same_v<Stream, asio::ip::tcp::socket>) {
+            if (buffer.size() == 0) {
+                stream.async_wait(asio::socket_base::wait_read,
+                                  [&stream, &buffer, handler = std::move(handler)](const asio::error_code &ec) mutable {
+                                      if (ec) {
+                                          handler(ec, 0);
+                                          return;
+                                      }
+                                      asio::async_read(stream, buffer.dynamic(), asio::transfer_at_least(1), std::move(handler));
+                                  });
+                return;
+            }
+        }
+        asio::async_read(stream, buffer.dynamic(), asio::transfer_at_least(1), std::move(handler));
+    }
+}
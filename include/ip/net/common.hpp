@@ -7,9 +7,34 @@
 
 #define ASIO_NOEXCEPT
 
+#if defined(ASIO_HAS_IO_URING) && !defined(__linux__)
+#error "ASIO_HAS_IO_URING is only supported on Linux"
+#endif
+#if defined(ASIO_DISABLE_EPOLL) && !defined(ASIO_HAS_IO_URING)
+#error "ASIO_DISABLE_EPOLL without ASIO_HAS_IO_URING falls back to select(), define ASIO_HAS_IO_URING as well"
+#endif
+
 #include <asio.hpp>
+#include <cmath>
+#include <deque>
 #include <set>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <tuple>
+#include <vector>
+#include "ip/net/runtime.hpp"
+#include "ip/net/bufferpool.hpp"
+#include "ip/net/sendqueue.hpp"
+#include "ip/net/timerwheel.hpp"
+#include "ip/net/framing.hpp"
+#include "ip/net/registry.hpp"
+#include "ip/net/admission.hpp"
+#include "ip/net/resolver.hpp"
+#include "ip/net/connector.hpp"
+#include "ip/net/handoff.hpp"
 #ifdef ENABLE_SSL
 #include <asio/ssl.hpp>
 #include <asio/ssl/stream.hpp>
@@ -18,27 +43,34 @@
 using namespace asio::ip;
 
 namespace internetprotocol {
-    inline extern asio::thread_pool thread_pool(std::thread::hardware_concurrency());
-
     /**
-     * This function stops the threads as soon as possible. As a result of calling stop_threads(), pending function objects may be never be invoked.
+     * This function stops the threads of the default runtime as soon as possible. As a result of calling stop_threads(), pending function objects may be never be invoked.
      */
     inline void stop_threads() {
-        thread_pool.stop();
+        default_runtime().stop();
     }
 
     /**
-     * This function blocks until the threads in the pool have completed. If join_threads() is not called prior to join_threads(), the join_threads() call will wait until the pool has no more outstanding work.
+     * This function blocks until the threads of the default runtime have completed. If stop_threads() is not called prior to join_threads(), the join_threads() call will wait until the runtime has no more outstanding work.
      */
     inline void join_threads() {
-        thread_pool.join();
+        default_runtime().join();
     }
 
     typedef enum : uint8_t {
         v4 = 0,
         v6 = 1,
+        /// Clients resolve both families and race them, see tcp_connector_c. Servers treat it as v6.
+        dual_stack = 2,
     } protocol_type_e;
 
+    /// Protocol a client resolves 'protocol' with. std::nullopt resolves both families.
+    inline std::optional<tcp> resolve_protocol(const protocol_type_e protocol) {
+        if (protocol == dual_stack)
+            return std::nullopt;
+        return protocol == v4 ? tcp::v4() : tcp::v6();
+    }
+
     typedef enum : uint8_t {
         none = 0x00,
         verify_peer = 0x01,
@@ -213,40 +245,147 @@ namespace internetprotocol {
         OPEN = 2
     } close_state_e;
 
+    /**
+     * Tuning options applied to TCP sockets: to the acceptor and every accepted socket on servers,
+     * and to the socket after connect on clients. Options the platform does not provide are skipped,
+     * and failures are ignored so a restricted option never fails a connection. Ignored by UDP.
+     */
+    struct socket_options_t {
+        /// TCP_NODELAY. Sends small writes immediately instead of holding them back for Nagle's algorithm.
+        bool tcp_no_delay = true;
+        /// SO_SNDBUF in bytes. 0 leaves the system default.
+        int send_buffer_size = 0;
+        /// SO_RCVBUF in bytes. 0 leaves the system default.
+        int receive_buffer_size = 0;
+        /// TCP_QUICKACK (Linux only). ACKs are sent right away instead of being delayed.
+        bool tcp_quick_ack = false;
+        /// TCP_DEFER_ACCEPT in seconds (Linux only, servers only). Connections are accepted once data arrives. 0 disables it.
+        int tcp_defer_accept_seconds = 0;
+        /// SO_KEEPALIVE. The idle, interval and count settings below only apply when it is enabled.
+        bool keep_alive = false;
+        /// TCP_KEEPIDLE in seconds (TCP_KEEPALIVE on macOS). 0 leaves the system default.
+        int keep_alive_idle_seconds = 0;
+        /// TCP_KEEPINTVL in seconds. 0 leaves the system default.
+        int keep_alive_interval_seconds = 0;
+        /// TCP_KEEPCNT. 0 leaves the system default.
+        int keep_alive_count = 0;
+        /// TCP_NOTSENT_LOWAT in bytes (Linux and macOS). 0 leaves the system default.
+        int not_sent_low_watermark = 0;
+        /// IP_TOS, or IPV6_TCLASS on IPv6 sockets. -1 leaves the system default.
+        int type_of_service = -1;
+        /// SO_PRIORITY (Linux only). -1 leaves the system default.
+        int priority = -1;
+        /**
+         * Messages of at least this many bytes are sent with MSG_ZEROCOPY (Linux plain TCP only),
+         * their write callback runs once the kernel has released the buffer. 0 disables it.
+         * Worth it for writes of 64 KiB and more, smaller ones are cheaper to copy.
+         */
+        size_t zerocopy_threshold = 0;
+    };
+
     // Client side
+    /**
+     * Reconnect policy of tcp_client_c. Disabled by default, the client closes when the connection drops.
+     * Delays grow from 'initial_delay_ms' by 'multiplier' after each failed attempt, up to 'max_delay_ms',
+     * and a random part of each delay is dropped so clients that lost the same server do not come back together.
+     *
+     * @par Example
+     * @code
+     * client_bind_options_t options;
+     * options.reconnect.enabled = true;
+     * options.reconnect.max_delay_ms = 10000;
+     * options.reconnect.max_attempts = 20;
+     * @endcode
+     */
+    struct reconnect_policy_t {
+        bool enabled = false;
+        /// Delay before the first attempt, in milliseconds.
+        uint32_t initial_delay_ms = 100;
+        /// Upper bound of the delay, in milliseconds.
+        uint32_t max_delay_ms = 30000;
+        /// Growth of the delay after every failed attempt.
+        double multiplier = 2.0;
+        /// Random fraction of each delay, from 0 (fixed delays) to 1 (anywhere between 0 and the delay).
+        double jitter = 1.0;
+        /// Failed attempts in a row before the client gives up and closes. 0 retries forever.
+        uint32_t max_attempts = 0;
+        /// Bytes of writes held while disconnected and sent once connected again. Writes over it are refused.
+        size_t max_queued_bytes = 1024 * 1024;
+    };
+
     struct client_bind_options_t {
         std::string address;
         std::string port = "8080";
         protocol_type_e protocol = v4;
+        /// Microseconds the private run loop spins on poll() before blocking, see run_context(). 0 disables spinning.
+        /// Clients on a shared io_context or runtime follow the runtime_options_t setting instead.
+        uint32_t busy_poll_us = 0;
+        /// SO_BUSY_POLL value in microseconds set on the socket (Linux only). 0 leaves the system default.
+        /// Raising it above net.core.busy_read requires CAP_NET_ADMIN, failures are ignored.
+        uint32_t so_busy_poll_us = 0;
+        /// TCP tuning options set on the socket once it is connected.
+        socket_options_t socket_options{};
+        /// Reconnect policy, used by tcp_client_c only.
+        reconnect_policy_t reconnect{};
+        /// Milliseconds before racing the next resolved address while earlier attempts are pending,
+        /// the RFC 8305 "Connection Attempt Delay". 0 tries the addresses one after the other.
+        uint32_t connect_attempt_delay_ms = 250;
+        /// Reuse recent lookups of the process-wide 'resolver_cache()'.
+        bool use_resolver_cache = true;
     };
 
     struct udp_client_t {
-        udp_client_t(): socket(context), resolver(context) {
+        udp_client_t(): owned_context(std::make_unique<asio::io_context>()), context(*owned_context),
+                        socket(asio::make_strand(context)), resolver(socket.get_executor()) {
         }
 
-        asio::io_context context;
+        explicit udp_client_t(asio::io_context &io_context): context(io_context),
+                                                             socket(asio::make_strand(context)),
+                                                             resolver(socket.get_executor()) {
+        }
+
+        // Null when the client runs on a shared io_context owned by someone else
+        std::unique_ptr<asio::io_context> owned_context;
+        asio::io_context &context;
         udp::socket socket;
         udp::endpoint endpoint;
         udp::resolver resolver;
     };
 
     struct tcp_client_t {
-        tcp_client_t(): socket(context), resolver(context) {
+        tcp_client_t(): owned_context(std::make_unique<asio::io_context>()), context(*owned_context),
+                        socket(asio::make_strand(context)), resolver(socket.get_executor()) {
         }
 
-        asio::io_context context;
+        explicit tcp_client_t(asio::io_context &io_context): context(io_context),
+                                                             socket(asio::make_strand(context)),
+                                                             resolver(socket.get_executor()) {
+        }
+
+        // Null when the client runs on a shared io_context owned by someone else
+        std::unique_ptr<asio::io_context> owned_context;
+        asio::io_context &context;
         tcp::socket socket;
         tcp::endpoint endpoint;
         tcp::resolver resolver;
     };
 #ifdef ENABLE_SSL
     struct tcp_client_ssl_t {
-        tcp_client_ssl_t(): ssl_context(asio::ssl::context::tlsv13_client),
-                            ssl_socket(context, ssl_context),
-                            resolver(context) {
+        tcp_client_ssl_t(): owned_context(std::make_unique<asio::io_context>()), context(*owned_context),
+                            ssl_context(asio::ssl::context::tlsv13_client),
+                            resolver(asio::make_strand(context)),
+                            ssl_socket(resolver.get_executor(), ssl_context) {
         }
 
-        asio::io_context context;
+        explicit tcp_client_ssl_t(asio::io_context &io_context): context(io_context),
+                                                                 ssl_context(asio::ssl::context::tlsv13_client),
+                                                                 resolver(asio::make_strand(context)),
+                                                                 ssl_socket(resolver.get_executor(), ssl_context) {
+        }
+
+        // Null when the client runs on a shared io_context owned by someone else
+        std::unique_ptr<asio::io_context> owned_context;
+        asio::io_context &context;
         asio::ssl::context ssl_context;
         tcp::resolver resolver;
         tcp::endpoint endpoint;
@@ -260,8 +399,147 @@ namespace internetprotocol {
         uint16_t port = 8080;
         protocol_type_e protocol = v4;
         bool reuse_address = true;
+        /// Number of SO_REUSEPORT acceptors (TCP servers only). Each shard owns its own io_context,
+        /// client set and io_threads run loops, and the kernel spreads incoming connections across them.
+        /// 0 or 1 disables sharding. Ignored on platforms without SO_REUSEPORT.
+        uint16_t shards = 0;
+        /// Number of accepts kept in flight on each acceptor, each with its connection object already constructed.
+        /// Raise it so connection storms are not serialized behind a single pending accept. Values lower than 1 are treated as 1.
+        uint16_t pending_accepts = 1;
+        /// Hand every accepted socket to the shard with the fewest clients instead of the one whose acceptor took it,
+        /// evening out the loops when the kernel hash spreads connections unevenly (tcp_server_c and tcp_server_ssl_c only).
+        bool balance_shards = false;
+        /// Microseconds each run loop spins on poll() before blocking, see run_context(). 0 disables spinning.
+        uint32_t busy_poll_us = 0;
+        /// SO_BUSY_POLL value in microseconds set on the listening socket and inherited by accepted sockets (Linux only).
+        /// 0 leaves the system default. Raising it above net.core.busy_read requires CAP_NET_ADMIN, failures are ignored.
+        uint32_t so_busy_poll_us = 0;
+        /// TCP tuning options set on the listening socket and on every accepted socket.
+        socket_options_t socket_options{};
+        /// Connection limits and accept rate, checked before a connection is registered or its TLS handshake starts.
+        admission_options_t admission{};
+        /// Listening sockets to serve on instead of binding 'address' and 'port', one shard each, e.g. handed over by the
+        /// process being replaced, see 'receive_listen_handles()'. The server owns them from then on. Ignores 'shards' when set.
+        std::vector<tcp::acceptor::native_handle_type> listen_handles{};
     };
 
+#ifdef SO_REUSEPORT
+    typedef asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT> reuse_port_t;
+#endif
+
+#ifdef SO_BUSY_POLL
+    typedef asio::detail::socket_option::integer<SOL_SOCKET, SO_BUSY_POLL> busy_poll_t;
+#endif
+
+    template<typename Socket>
+    inline void set_busy_poll(Socket &socket, const uint32_t busy_poll_us) {
+#ifdef SO_BUSY_POLL
+        if (busy_poll_us == 0)
+            return;
+        asio::error_code ec;
+        socket.set_option(busy_poll_t(static_cast<int>(busy_poll_us)), ec);
+#endif
+    }
+
+#ifdef TCP_QUICKACK
+    typedef asio::detail::socket_option::boolean<IPPROTO_TCP, TCP_QUICKACK> tcp_quick_ack_t;
+#endif
+
+#ifdef TCP_DEFER_ACCEPT
+    typedef asio::detail::socket_option::integer<IPPROTO_TCP, TCP_DEFER_ACCEPT> tcp_defer_accept_t;
+#endif
+
+#if defined(TCP_KEEPIDLE)
+    typedef asio::detail::socket_option::integer<IPPROTO_TCP, TCP_KEEPIDLE> tcp_keep_idle_t;
+#elif defined(TCP_KEEPALIVE)
+    typedef asio::detail::socket_option::integer<IPPROTO_TCP, TCP_KEEPALIVE> tcp_keep_idle_t;
+#endif
+
+#ifdef TCP_KEEPINTVL
+    typedef asio::detail::socket_option::integer<IPPROTO_TCP, TCP_KEEPINTVL> tcp_keep_interval_t;
+#endif
+
+#ifdef TCP_KEEPCNT
+    typedef asio::detail::socket_option::integer<IPPROTO_TCP, TCP_KEEPCNT> tcp_keep_count_t;
+#endif
+
+#ifdef TCP_NOTSENT_LOWAT
+    typedef asio::detail::socket_option::integer<IPPROTO_TCP, TCP_NOTSENT_LOWAT> tcp_not_sent_low_watermark_t;
+#endif
+
+#ifdef IP_TOS
+    typedef asio::detail::socket_option::integer<IPPROTO_IP, IP_TOS> ip_tos_t;
+#endif
+
+#ifdef IPV6_TCLASS
+    typedef asio::detail::socket_option::integer<IPPROTO_IPV6, IPV6_TCLASS> ipv6_tclass_t;
+#endif
+
+#ifdef SO_PRIORITY
+    typedef asio::detail::socket_option::integer<SOL_SOCKET, SO_PRIORITY> priority_t;
+#endif
+
+    template<typename Socket>
+    inline void set_socket_options(Socket &socket, const socket_options_t &opts) {
+        asio::error_code ec;
+        if (opts.tcp_no_delay)
+            socket.set_option(tcp::no_delay(true), ec);
+        if (opts.send_buffer_size > 0)
+            socket.set_option(asio::socket_base::send_buffer_size(opts.send_buffer_size), ec);
+        if (opts.receive_buffer_size > 0)
+            socket.set_option(asio::socket_base::receive_buffer_size(opts.receive_buffer_size), ec);
+#ifdef TCP_QUICKACK
+        if (opts.tcp_quick_ack)
+            socket.set_option(tcp_quick_ack_t(true), ec);
+#endif
+        if (opts.keep_alive) {
+            socket.set_option(asio::socket_base::keep_alive(true), ec);
+#if defined(TCP_KEEPIDLE) || defined(TCP_KEEPALIVE)
+            if (opts.keep_alive_idle_seconds > 0)
+                socket.set_option(tcp_keep_idle_t(opts.keep_alive_idle_seconds), ec);
+#endif
+#ifdef TCP_KEEPINTVL
+            if (opts.keep_alive_interval_seconds > 0)
+                socket.set_option(tcp_keep_interval_t(opts.keep_alive_interval_seconds), ec);
+#endif
+#ifdef TCP_KEEPCNT
+            if (opts.keep_alive_count > 0)
+                socket.set_option(tcp_keep_count_t(opts.keep_alive_count), ec);
+#endif
+        }
+#ifdef TCP_NOTSENT_LOWAT
+        if (opts.not_sent_low_watermark > 0)
+            socket.set_option(tcp_not_sent_low_watermark_t(opts.not_sent_low_watermark), ec);
+#endif
+        if (opts.type_of_service >= 0) {
+            const tcp::endpoint endpoint = socket.local_endpoint(ec);
+            if (!ec && endpoint.address().is_v6()) {
+#ifdef IPV6_TCLASS
+                socket.set_option(ipv6_tclass_t(opts.type_of_service), ec);
+#endif
+            } else {
+#ifdef IP_TOS
+                socket.set_option(ip_tos_t(opts.type_of_service), ec);
+#endif
+            }
+        }
+#ifdef SO_PRIORITY
+        if (opts.priority >= 0)
+            socket.set_option(priority_t(opts.priority), ec);
+#endif
+    }
+
+    template<typename Acceptor>
+    inline void set_listener_options(Acceptor &acceptor, const socket_options_t &opts) {
+        set_socket_options(acceptor, opts);
+#ifdef TCP_DEFER_ACCEPT
+        if (opts.tcp_defer_accept_seconds > 0) {
+            asio::error_code ec;
+            acceptor.set_option(tcp_defer_accept_t(opts.tcp_defer_accept_seconds), ec);
+        }
+#endif
+    }
+
     struct udp_server_t {
         udp_server_t(): socket(context) {
         }
@@ -278,7 +556,9 @@ namespace internetprotocol {
 
         asio::io_context context;
         tcp::acceptor acceptor;
-        std::set<std::shared_ptr<T> > clients;
+        std::mutex clients_mutex;
+        connection_registry_c<T> clients;
+        std::vector<std::unique_ptr<tcp_server_t<T>>> shards;
     };
 
 #ifdef ENABLE_SSL
@@ -290,7 +570,9 @@ namespace internetprotocol {
         asio::io_context context;
         asio::ssl::context ssl_context;
         tcp::acceptor acceptor;
-        std::set<std::shared_ptr<T>> ssl_clients;
+        std::mutex clients_mutex;
+        connection_registry_c<T> ssl_clients;
+        std::vector<std::unique_ptr<tcp_server_ssl_t<T>>> shards;
     };
 #endif
 }
\ No newline at end of file
@@ -0,0 +1,198 @@
+/**
+ * MIT License (MIT)
+ * Copyright © 2025 Nathan Miguel
+*/
+
+#pragma once
+
+#include <asio.hpp>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace internetprotocol {
+    /**
+     * Connects a socket to the first resolved endpoint that answers, racing them as in RFC 8305 (Happy Eyeballs v2).
+     * Endpoints are tried alternating IPv6 and IPv4, starting with the family the resolver listed first.
+     * A new attempt starts every 'attempt_delay' while the previous ones are pending, or at once when one fails.
+     * The first attempt to connect is moved into the target socket and the others are closed.
+     * Every handler runs on the executor of the target socket, which must be a strand when it is shared by several threads.
+     */
+    class tcp_connector_c {
+    public:
+        typedef std::function<void(const asio::error_code &, const asio::ip::tcp::endpoint &)> handler_t;
+
+        tcp_connector_c() = default;
+
+        tcp_connector_c(const tcp_connector_c &) = delete;
+        tcp_connector_c &operator=(const tcp_connector_c &) = delete;
+
+        ~tcp_connector_c() {
+            stop(false);
+        }
+
+        /**
+         * Connect 'target' to one of 'results' and call 'handler(const asio::error_code &, const tcp::endpoint &)'.
+         * An attempt already running is cancelled first.
+         *
+         * @param target Closed socket that receives the connection.
+         * @param results Endpoints to try, in the order of the resolver.
+         * @param attempt_delay Time before racing the next endpoint. Zero tries them one after the other.
+         */
+        void async_connect(asio::ip::tcp::socket &target, const asio::ip::tcp::resolver::results_type &results,
+                           const std::chrono::milliseconds attempt_delay, handler_t handler) {
+            cancel();
+            std::shared_ptr<attempt_t> state = std::make_shared<attempt_t>(target, attempt_delay, std::move(handler));
+            state->endpoints = interleave(results);
+            {
+                std::lock_guard guard(mutex_running);
+                running = state;
+            }
+            asio::post(target.get_executor(), [state]() {
+                if (state->endpoints.empty()) {
+                    state->finish(asio::error::host_not_found, asio::ip::tcp::endpoint());
+                    return;
+                }
+                state->start_next();
+            });
+        }
+
+        /**
+         * Stop the running attempt. Its handler is called with asio::error::operation_aborted.
+         */
+        void cancel() {
+            stop(true);
+        }
+
+    private:
+        struct attempt_t : std::enable_shared_from_this<attempt_t> {
+            attempt_t(asio::ip::tcp::socket &target, const std::chrono::milliseconds delay, handler_t handler):
+                target(target), delay(delay), timer(target.get_executor()), handler(std::move(handler)) {
+            }
+
+            asio::ip::tcp::socket &target;
+            std::chrono::milliseconds delay;
+            asio::steady_timer timer;
+            handler_t handler;
+            std::atomic<bool> cancelled = false;
+            // Set when the owner is gone, the handler must not run anymore
+            std::atomic<bool> detached = false;
+            bool done = false;
+            std::vector<asio::ip::tcp::endpoint> endpoints;
+            std::vector<std::unique_ptr<asio::ip::tcp::socket>> sockets;
+            size_t next = 0;
+            size_t pending = 0;
+            asio::error_code last_error;
+
+            void start_next() {
+                if (done || next >= endpoints.size())
+                    return;
+
+                const size_t index = next++;
+                sockets.push_back(std::make_unique<asio::ip::tcp::socket>(target.get_executor()));
+                asio::ip::tcp::socket &socket = *sockets.back();
+                ++pending;
+                socket.async_connect(endpoints[index],
+                                     [self = this->shared_from_this(), &socket, index](const asio::error_code &ec) {
+                                         self->attempt_done(socket, index, ec);
+                                     });
+
+                if (delay.count() == 0 || next >= endpoints.size())
+                    return;
+                timer.expires_after(delay);
+                timer.async_wait([self = this->shared_from_this()](const asio::error_code &ec) {
+                    if (!ec)
+                        self->start_next();
+                });
+            }
+
+            void attempt_done(asio::ip::tcp::socket &socket, const size_t index, const asio::error_code &ec) {
+                --pending;
+                if (done)
+                    return;
+                if (cancelled.load()) {
+                    finish(asio::error::operation_aborted, asio::ip::tcp::endpoint());
+                    return;
+                }
+
+                if (!ec) {
+                    target = std::move(socket);
+                    finish(ec, endpoints[index]);
+                    return;
+                }
+
+                last_error = ec;
+                asio::error_code ignored;
+                socket.close(ignored);
+                // A failed attempt hands over to the next endpoint without waiting for the delay
+                if (next < endpoints.size()) {
+                    timer.cancel();
+                    start_next();
+                    return;
+                }
+                if (pending == 0)
+                    finish(last_error, asio::ip::tcp::endpoint());
+            }
+
+            void finish(const asio::error_code &ec, const asio::ip::tcp::endpoint &endpoint) {
+                if (done)
+                    return;
+
+                done = true;
+                timer.cancel();
+                asio::error_code ignored;
+                for (const std::unique_ptr<asio::ip::tcp::socket> &socket : sockets) {
+                    if (socket->is_open())
+                        socket->close(ignored);
+                }
+                if (!detached.load())
+                    handler(ec, endpoint);
+            }
+        };
+
+        // 'cancel()' may be called from any thread, e.g. by a client closing
+        std::mutex mutex_running;
+        std::shared_ptr<attempt_t> running;
+
+        void stop(const bool notify) {
+            std::shared_ptr<attempt_t> state;
+            {
+                std::lock_guard guard(mutex_running);
+                state = std::move(running);
+            }
+            if (!state)
+                return;
+
+            state->detached.store(!notify);
+            state->cancelled.store(true);
+            asio::post(state->target.get_executor(), [state]() {
+                state->finish(asio::error::operation_aborted, asio::ip::tcp::endpoint());
+            });
+        }
+
+        // Alternate address families, starting with the family of the first result (RFC 8305 section 4)
+        static std::vector<asio::ip::tcp::endpoint> interleave(const asio::ip::tcp::resolver::results_type &results) {
+            std::vector<asio::ip::tcp::endpoint> first;
+            std::vector<asio::ip::tcp::endpoint> second;
+            for (const asio::ip::tcp::resolver::results_type::value_type &entry : results) {
+                if (first.empty() || entry.endpoint().protocol() == first.front().protocol())
+                    first.push_back(entry.endpoint());
+                else
+                    second.push_back(entry.endpoint());
+            }
+
+            std::vector<asio::ip::tcp::endpoint> endpoints;
+            endpoints.reserve(first.size() + second.size());
+            for (size_t i = 0; i < first.size() || i < second.size(); ++i) {
+                if (i < first.size())
+                    endpoints.push_back(first[i]);
+                if (i < second.size())
+                    endpoints.push_back(second[i]);
+            }
+            return endpoints;
+        }
+    };
+}
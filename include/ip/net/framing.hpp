@@ -0,0 +1,220 @@
+/**
+ * MIT License (MIT)
+ * Copyright © 2025 Nathan Miguel
+*/
+
+#pragma once
+
+#include <asio.hpp>
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace internetprotocol {
+    typedef enum : uint8_t {
+        /// No framing, each read is delivered as it arrived.
+        RAW = 0,
+        /// Every message is preceded by its payload length.
+        LENGTH_PREFIXED = 1,
+        /// Every message ends with 'delimiter'.
+        DELIMITED = 2,
+        /// Every message is exactly 'frame_size' bytes long.
+        FIXED_SIZE = 3
+    } framing_type_e;
+
+    /**
+     * This structure selects how a TCP byte stream is split into messages.
+     *
+     * @par Example
+     * @code
+     * framing_t framing;
+     * framing.type = LENGTH_PREFIXED;
+     * framing.length_size = 2;
+     * framing.little_endian = true;
+     * @endcode
+     */
+    struct framing_t {
+        framing_type_e type = RAW;
+        /// Size in bytes of the length prefix: 1, 2, 4 or 8. The prefix counts the payload only.
+        uint8_t length_size = 4;
+        /// Byte order of the length prefix. Network byte order (big-endian) by default.
+        bool little_endian = false;
+        /// Message terminator for DELIMITED framing.
+        std::string delimiter = "\n";
+        /// Message size for FIXED_SIZE framing.
+        size_t frame_size = 0;
+        /// Largest message accepted. A peer announcing or sending more is disconnected with asio::error::message_size.
+        size_t max_frame_size = 16 * 1024 * 1024;
+    };
+
+    /**
+     * Incremental encoder/decoder for a framing_t.
+     * 'decode' walks the receive buffer in place and hands out every complete message it finds,
+     * so several messages read at once are delivered without copying, and a partial one waits for the next read.
+     */
+    class frame_codec_c {
+    public:
+        explicit frame_codec_c(const framing_t &framing = {}): framing(framing) {
+        }
+
+        const framing_t &options() const { return framing; }
+
+        bool is_raw() const { return framing.type == RAW; }
+
+        /**
+         * Call 'emit(const uint8_t *data, size_t size)' for each complete message at the front of 'data'.
+         * Returns the number of bytes taken, which the caller consumes from its buffer.
+         * On a framing violation 'ec' is set and decoding stops.
+         */
+        template<typename Emit>
+        size_t decode(const uint8_t *data, const size_t size, Emit &&emit, asio::error_code &ec) {
+            switch (framing.type) {
+                case LENGTH_PREFIXED:
+                    return decode_length_prefixed(data, size, emit, ec);
+                case DELIMITED:
+                    return decode_delimited(data, size, emit, ec);
+                case FIXED_SIZE:
+                    return decode_fixed_size(data, size, emit, ec);
+                default:
+                    emit(data, size);
+                    return size;
+            }
+        }
+
+        /// Number of bytes 'encode' adds around a payload.
+        size_t overhead() const {
+            switch (framing.type) {
+                case LENGTH_PREFIXED:
+                    return framing.length_size;
+                case DELIMITED:
+                    return framing.delimiter.size();
+                default:
+                    return 0;
+            }
+        }
+
+        /**
+         * Append 'size' bytes at 'data' to 'buffer' as one message.
+         * Returns false if the payload does not fit the framing: too long for the prefix or 'max_frame_size',
+         * or not exactly 'frame_size' bytes for FIXED_SIZE.
+         */
+        bool encode(const uint8_t *data, const size_t size, std::vector<uint8_t> &buffer) const {
+            if (framing.type != RAW && size > framing.max_frame_size)
+                return false;
+
+            switch (framing.type) {
+                case LENGTH_PREFIXED: {
+                    if (!valid_length_size() || (framing.length_size < 8 && size >> (framing.length_size * 8) != 0))
+                        return false;
+                    for (uint8_t i = 0; i < framing.length_size; ++i) {
+                        const uint8_t shift = framing.little_endian ? i : framing.length_size - 1 - i;
+                        buffer.push_back(static_cast<uint8_t>(static_cast<uint64_t>(size) >> (shift * 8)));
+                    }
+                    buffer.insert(buffer.end(), data, data + size);
+                    return true;
+                }
+                case DELIMITED:
+                    buffer.insert(buffer.end(), data, data + size);
+                    buffer.insert(buffer.end(), framing.delimiter.begin(), framing.delimiter.end());
+                    return true;
+                case FIXED_SIZE:
+                    if (size != framing.frame_size)
+                        return false;
+                    buffer.insert(buffer.end(), data, data + size);
+                    return true;
+                default:
+                    buffer.insert(buffer.end(), data, data + size);
+                    return true;
+            }
+        }
+
+    private:
+        framing_t framing;
+        // Bytes at the front of the pending data already known to hold no delimiter
+        size_t searched = 0;
+
+        bool valid_length_size() const {
+            return framing.length_size == 1 || framing.length_size == 2 || framing.length_size == 4 || framing.length_size == 8;
+        }
+
+        template<typename Emit>
+        size_t decode_length_prefixed(const uint8_t *data, const size_t size, Emit &emit, asio::error_code &ec) {
+            if (!valid_length_size()) {
+                ec = asio::error::invalid_argument;
+                return 0;
+            }
+
+            const size_t header = framing.length_size;
+            size_t offset = 0;
+            while (size - offset >= header) {
+                uint64_t length = 0;
+                for (size_t i = 0; i < header; ++i) {
+                    const uint8_t byte = data[offset + (framing.little_endian ? header - 1 - i : i)];
+                    length = length << 8 | byte;
+                }
+                if (length > framing.max_frame_size) {
+                    ec = asio::error::message_size;
+                    return offset;
+                }
+                if (size - offset - header < length)
+                    break;
+
+                emit(data + offset + header, static_cast<size_t>(length));
+                offset += header + static_cast<size_t>(length);
+            }
+            return offset;
+        }
+
+        template<typename Emit>
+        size_t decode_delimited(const uint8_t *data, const size_t size, Emit &emit, asio::error_code &ec) {
+            const std::string &delimiter = framing.delimiter;
+            if (delimiter.empty()) {
+                ec = asio::error::invalid_argument;
+                return 0;
+            }
+
+            const uint8_t *first = reinterpret_cast<const uint8_t *>(delimiter.data());
+            const uint8_t *last = first + delimiter.size();
+            size_t offset = 0;
+            while (offset < size) {
+                const uint8_t *begin = data + offset + std::min(searched, size - offset);
+                const uint8_t *found = std::search(begin, data + size, first, last);
+                if (found == data + size) {
+                    // A delimiter split across reads can only start in the last 'delimiter.size() - 1' bytes
+                    const size_t pending = size - offset;
+                    searched = pending >= delimiter.size() ? pending - delimiter.size() + 1 : 0;
+                    if (pending > framing.max_frame_size + delimiter.size())
+                        ec = asio::error::message_size;
+                    return offset;
+                }
+
+                const size_t length = found - (data + offset);
+                if (length > framing.max_frame_size) {
+                    ec = asio::error::message_size;
+                    return offset;
+                }
+                searched = 0;
+                emit(data + offset, length);
+                offset += length + delimiter.size();
+            }
+            searched = 0;
+            return offset;
+        }
+
+        template<typename Emit>
+        size_t decode_fixed_size(const uint8_t *data, const size_t size, Emit &emit, asio::error_code &ec) {
+            if (framing.frame_size == 0 || framing.frame_size > framing.max_frame_size) {
+                ec = asio::error::invalid_argument;
+                return 0;
+            }
+
+            size_t offset = 0;
+            while (size - offset >= framing.frame_size) {
+                emit(data + offset, framing.frame_size);
+                offset += framing.frame_size;
+            }
+            return offset;
+        }
+    };
+}
@@ -0,0 +1,430 @@
+/**
+ * MIT License (MIT)
+ * Copyright © 2025 Nathan Miguel
+*/
+
+#pragma once
+
+#include <asio.hpp>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "ip/net/runtime.hpp"
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstdlib>
+#include <cstring>
+#endif
+
+namespace internetprotocol {
+    /**
+     * Serve on the listening socket 'handle' instead of binding a new one, see 'server_bind_options_t::listen_handles'.
+     * The address family is read from the socket itself and 'listen' is called again with 'backlog', which is harmless
+     * on a socket that is listening already. On success the acceptor owns the handle.
+     */
+    inline bool adopt_acceptor(asio::ip::tcp::acceptor &acceptor, const asio::ip::tcp::acceptor::native_handle_type handle,
+                               const int backlog, asio::error_code &ec) {
+        acceptor.assign(asio::ip::tcp::v6(), handle, ec);
+        if (ec)
+            return false;
+
+        const asio::ip::tcp::endpoint endpoint = acceptor.local_endpoint(ec);
+        if (!ec && endpoint.protocol() != asio::ip::tcp::v6()) {
+            // The family given to assign() is the one accepted sockets are opened with
+            acceptor.release(ec);
+            if (!ec)
+                acceptor.assign(endpoint.protocol(), handle, ec);
+        }
+        if (!ec)
+            acceptor.listen(backlog, ec);
+        if (ec) {
+            asio::error_code ignored;
+            if (acceptor.is_open())
+                acceptor.release(ignored);
+            return false;
+        }
+        return true;
+    }
+
+#ifndef _WIN32
+    /// Most handles a handoff carries, SCM_RIGHTS takes at most SCM_MAX_FD (253) descriptors per message on Linux.
+    constexpr size_t max_listen_handles = 253;
+
+    /// Set or clear FD_CLOEXEC on 'fd'.
+    inline bool set_close_on_exec(const int fd, const bool enabled) {
+        const int flags = ::fcntl(fd, F_GETFD);
+        if (flags < 0)
+            return false;
+        return ::fcntl(fd, F_SETFD, enabled ? flags | FD_CLOEXEC : flags & ~FD_CLOEXEC) == 0;
+    }
+
+    /**
+     * Hands the listening sockets of a running server to the process replacing it, over a Unix socket with SCM_RIGHTS.
+     * The new process calls 'receive_listen_handles()' with the same path and serves on the very same sockets,
+     * so the port never stops listening and connections waiting in the backlog are accepted by whichever process is running.
+     * The handoff happens once: the Unix socket is closed and removed when the first process connects, before the handles are sent.
+     * The socket file is created with mode 0600, only processes of the same user can take the handles.
+     *
+     * @par Example
+     * @code
+     * tcp_server_c server;
+     * listen_handoff_c handoff;
+     * handoff.on_handoff = [&]() {
+     *      // The new process accepts on the same sockets, let the old connections finish
+     *      server.drain(std::chrono::seconds(30));
+     * };
+     * handoff.open("/run/app/handoff.sock", [&]() { return server.listen_handles(); });
+     * @endcode
+     */
+    class listen_handoff_c {
+    public:
+        listen_handoff_c(): listen_handoff_c(default_runtime()) {}
+
+        /**
+         * Construct the handoff on a runtime instead of the default one.
+         *
+         * @param runtime Runtime running the Unix socket. Must outlive the handoff.
+         */
+        explicit listen_handoff_c(runtime_c &runtime): acceptor(asio::make_strand(runtime.context())) {}
+
+        listen_handoff_c(const listen_handoff_c &) = delete;
+        listen_handoff_c &operator=(const listen_handoff_c &) = delete;
+
+        ~listen_handoff_c() {
+            close();
+        }
+
+        /**
+         * Return true if the Unix socket is waiting for the new process.
+         *
+         * @par Example
+         * @code
+         * listen_handoff_c handoff;
+         * bool is_open = handoff.is_open();
+         * @endcode
+         */
+        bool is_open() const { return acceptor.is_open(); }
+
+        /**
+         * Listen on the Unix socket 'path' and send 'handles()' to the first process that connects to it.
+         * A file left at 'path' by a previous process is replaced. Return false if it is already open or on error.
+         *
+         * @param path Path of the Unix socket.
+         *
+         * @param handles Called when the new process connects, returns the listening sockets to hand over.
+         *
+         * @par Example
+         * @code
+         * listen_handoff_c handoff;
+         * handoff.open("/run/app/handoff.sock", [&]() { return server.listen_handles(); });
+         * @endcode
+         */
+        bool open(const std::string &path, const std::function<std::vector<int>()> &handles) {
+            std::lock_guard guard(mutex_handoff);
+            if (acceptor.is_open() || !handles)
+                return false;
+
+            asio::error_code ec;
+            ::unlink(path.c_str());
+            acceptor.open(asio::local::stream_protocol(), ec);
+            if (!ec)
+                acceptor.bind(asio::local::stream_protocol::endpoint(path), ec);
+            if (!ec && ::chmod(path.c_str(), S_IRUSR | S_IWUSR) != 0)
+                ec = asio::error_code(errno, asio::error::get_system_category());
+            if (!ec)
+                acceptor.listen(1, ec);
+            if (ec) {
+                asio::error_code ignored;
+                acceptor.close(ignored);
+                ::unlink(path.c_str());
+                if (on_error) on_error(ec);
+                return false;
+            }
+
+            socket_path = path;
+            get_handles = handles;
+            std::shared_ptr<asio::local::stream_protocol::socket> peer =
+                std::make_shared<asio::local::stream_protocol::socket>(acceptor.get_executor());
+            acceptor.async_accept(*peer, [&, peer](const asio::error_code &error) {
+                accept(error, peer);
+            });
+            return true;
+        }
+
+        /**
+         * Stop waiting for the new process and remove the Unix socket.
+         *
+         * @par Example
+         * @code
+         * listen_handoff_c handoff;
+         * handoff.close();
+         * @endcode
+         */
+        void close() {
+            std::lock_guard guard(mutex_handoff);
+            stop();
+        }
+
+        /**
+         * Adds the listener function to 'on_handoff'.
+         * This event will be triggered once the handles have been sent to the new process.
+         *
+         * @par Example
+         * @code
+         * listen_handoff_c handoff;
+         * handoff.on_handoff = [&]() {
+         *      // your code...
+         * };
+         * @endcode
+         */
+        std::function<void()> on_handoff;
+
+        /**
+         * Adds the listener function to 'on_error'.
+         * This event will be triggered when the Unix socket cannot be opened or the handles cannot be sent.
+         *
+         * @par Example
+         * @code
+         * listen_handoff_c handoff;
+         * handoff.on_error = [&](const asio::error_code &ec) {
+         *      // your code...
+         * };
+         * @endcode
+         */
+        std::function<void(const asio::error_code &)> on_error;
+
+    private:
+        std::mutex mutex_handoff;
+        asio::local::stream_protocol::acceptor acceptor;
+        std::string socket_path;
+        std::function<std::vector<int>()> get_handles;
+
+        void stop() {
+            if (!acceptor.is_open())
+                return;
+
+            asio::error_code ignored;
+            acceptor.close(ignored);
+            ::unlink(socket_path.c_str());
+        }
+
+        void accept(const asio::error_code &error, const std::shared_ptr<asio::local::stream_protocol::socket> &peer) {
+            if (error == asio::error::operation_aborted)
+                return;
+
+            std::function<std::vector<int>()> handles;
+            {
+                // Remove the path first, so the new process can open its own handoff there right after
+                std::lock_guard guard(mutex_handoff);
+                stop();
+                handles = std::move(get_handles);
+                get_handles = nullptr;
+            }
+            if (error) {
+                if (on_error) on_error(error);
+                return;
+            }
+
+            asio::error_code ec;
+            peer->non_blocking(false, ec);
+            if (!ec)
+                ec = send(peer->native_handle(), handles());
+            asio::error_code ignored;
+            peer->close(ignored);
+            if (ec) {
+                if (on_error) on_error(ec);
+                return;
+            }
+            if (on_handoff) on_handoff();
+        }
+
+        // One byte with the handle count, the handles themselves ride in the SCM_RIGHTS control message
+        static asio::error_code send(const int fd, const std::vector<int> &handles) {
+            if (handles.empty() || handles.size() > max_listen_handles)
+                return asio::error::invalid_argument;
+
+            uint8_t count = static_cast<uint8_t>(handles.size());
+            iovec io{&count, sizeof(count)};
+            std::vector<char> control(CMSG_SPACE(sizeof(int) * handles.size()));
+            msghdr message{};
+            message.msg_iov = &io;
+            message.msg_iovlen = 1;
+            message.msg_control = control.data();
+            message.msg_controllen = control.size();
+            cmsghdr *header = CMSG_FIRSTHDR(&message);
+            header->cmsg_level = SOL_SOCKET;
+            header->cmsg_type = SCM_RIGHTS;
+            header->cmsg_len = CMSG_LEN(sizeof(int) * handles.size());
+            std::memcpy(CMSG_DATA(header), handles.data(), sizeof(int) * handles.size());
+
+            ssize_t sent;
+            do {
+                sent = ::sendmsg(fd, &message, MSG_NOSIGNAL);
+            } while (sent < 0 && errno == EINTR);
+            return sent < 0 ? asio::error_code(errno, asio::error::get_system_category()) : asio::error_code();
+        }
+    };
+
+    /**
+     * Connect to the 'listen_handoff_c' of the running process at 'path' and return the listening sockets it hands over,
+     * ready for 'server_bind_options_t::listen_handles'. It blocks until they are received or 'timeout' expires.
+     * Returns an empty vector and sets 'ec' if there is no process to take them from, e.g. on the first start,
+     * or to 'asio::error::timed_out' if that process accepted the connection but did not answer in time.
+     *
+     * @par Example
+     * @code
+     * asio::error_code ec;
+     * server_bind_options_t options;
+     * options.listen_handles = receive_listen_handles("/run/app/handoff.sock", ec, std::chrono::seconds(5));
+     * // Binds the port as usual when nothing was received
+     * server.open(options);
+     * @endcode
+     */
+    inline std::vector<int> receive_listen_handles(const std::string &path, asio::error_code &ec,
+                                                   const std::chrono::milliseconds timeout = std::chrono::seconds(5)) {
+        asio::io_context context;
+        asio::local::stream_protocol::socket socket(context);
+        socket.connect(asio::local::stream_protocol::endpoint(path), ec);
+        if (ec)
+            return {};
+
+        uint8_t count = 0;
+        iovec io{&count, sizeof(count)};
+        std::vector<char> control(CMSG_SPACE(sizeof(int) * max_listen_handles));
+        msghdr message{};
+        message.msg_iov = &io;
+        message.msg_iovlen = 1;
+        message.msg_control = control.data();
+        message.msg_controllen = control.size();
+        int flags = 0;
+#ifdef MSG_CMSG_CLOEXEC
+        flags |= MSG_CMSG_CLOEXEC;
+#endif
+        // A wedged process may accept the connection and never answer, wait for the handles only until 'timeout'
+        const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + timeout;
+        pollfd readable{socket.native_handle(), POLLIN, 0};
+        int ready;
+        do {
+            const std::chrono::milliseconds remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now());
+            ready = ::poll(&readable, 1, static_cast<int>(std::clamp<std::chrono::milliseconds::rep>(
+                remaining.count(), 0, std::numeric_limits<int>::max())));
+        } while (ready < 0 && errno == EINTR);
+        if (ready < 0) {
+            ec = asio::error_code(errno, asio::error::get_system_category());
+            return {};
+        }
+        if (ready == 0) {
+            ec = asio::error::timed_out;
+            return {};
+        }
+
+        ssize_t received;
+        do {
+            received = ::recvmsg(socket.native_handle(), &message, flags);
+        } while (received < 0 && errno == EINTR);
+        if (received < 0) {
+            ec = asio::error_code(errno, asio::error::get_system_category());
+            return {};
+        }
+
+        std::vector<int> handles;
+        for (cmsghdr *header = CMSG_FIRSTHDR(&message); header; header = CMSG_NXTHDR(&message, header)) {
+            if (header->cmsg_level != SOL_SOCKET || header->cmsg_type != SCM_RIGHTS)
+                continue;
+            const size_t size = (header->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            const size_t offset = handles.size();
+            handles.resize(offset + size);
+            std::memcpy(handles.data() + offset, CMSG_DATA(header), sizeof(int) * size);
+        }
+        for (const int handle : handles)
+            set_close_on_exec(handle, true);
+        if (received == 0 || handles.empty() || (message.msg_flags & MSG_CTRUNC) || handles.size() != count) {
+            for (const int handle : handles)
+                ::close(handle);
+            ec = asio::error::connection_aborted;
+            return {};
+        }
+        return handles;
+    }
+
+    /**
+     * Keep the listening sockets 'handles' open across exec() and record them in the LISTEN_HANDLES environment variable,
+     * so a process started with fork() and exec() finds them with 'inherited_listen_handles()'.
+     *
+     * @par Example
+     * @code
+     * asio::error_code ec;
+     * if (export_listen_handles(server.listen_handles(), ec) && fork() == 0)
+     *     execv(argv[0], argv);
+     * @endcode
+     */
+    inline bool export_listen_handles(const std::vector<int> &handles, asio::error_code &ec) {
+        std::string value;
+        for (const int handle : handles) {
+            if (!set_close_on_exec(handle, false)) {
+                ec = asio::error_code(errno, asio::error::get_system_category());
+                return false;
+            }
+            if (!value.empty())
+                value += ',';
+            value += std::to_string(handle);
+        }
+        if (::setenv("LISTEN_HANDLES", value.c_str(), 1) != 0) {
+            ec = asio::error_code(errno, asio::error::get_system_category());
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * Return the listening sockets inherited from the parent process, recorded by 'export_listen_handles()'
+     * or passed by systemd socket activation (LISTEN_FDS). The variables are removed so further children do not see them.
+     * Returns an empty vector if nothing was inherited.
+     *
+     * @par Example
+     * @code
+     * server_bind_options_t options;
+     * options.listen_handles = inherited_listen_handles();
+     * server.open(options);
+     * @endcode
+     */
+    inline std::vector<int> inherited_listen_handles() {
+        std::vector<int> handles;
+        if (const char *value = ::getenv("LISTEN_HANDLES")) {
+            for (const char *begin = value; *begin;) {
+                char *end = nullptr;
+                const long handle = std::strtol(begin, &end, 10);
+                if (end == begin)
+                    break;
+                handles.push_back(static_cast<int>(handle));
+                begin = *end == ',' ? end + 1 : end;
+            }
+            ::unsetenv("LISTEN_HANDLES");
+        } else if (const char *count = ::getenv("LISTEN_FDS")) {
+            // sd_listen_fds(3): the sockets start at descriptor 3, and only if they were meant for this process
+            const char *pid = ::getenv("LISTEN_PID");
+            if (pid && std::strtol(pid, nullptr, 10) == static_cast<long>(::getpid())) {
+                const long size = std::strtol(count, nullptr, 10);
+                for (long i = 0; i < size; ++i)
+                    handles.push_back(static_cast<int>(3 + i));
+            }
+            ::unsetenv("LISTEN_FDS");
+            ::unsetenv("LISTEN_PID");
+            ::unsetenv("LISTEN_FDNAMES");
+        }
+        for (const int handle : handles)
+            set_close_on_exec(handle, true);
+        return handles;
+    }
+#endif
+}
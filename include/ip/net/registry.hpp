@@ -0,0 +1,146 @@
+/**
+ * MIT License (MIT)
+ * Copyright © 2025 Nathan Miguel
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace internetprotocol {
+    /**
+     * Stable identifier of a server connection. 0 is never a valid id.
+     * Bits 0-23 hold the registry slot, bits 24-47 the slot generation and bits 48-63 the shard.
+     * A closed connection's id stays invalid even after its slot has been reused.
+     */
+    typedef uint64_t connection_id_t;
+
+    /// Shard of the server that owns the connection 'id', 0 for the main acceptor.
+    inline uint16_t connection_shard(const connection_id_t id) {
+        return static_cast<uint16_t>(id >> 48);
+    }
+
+    /**
+     * Slot map of the connections of one server shard.
+     * Insert, erase and lookup by id are O(1), and the entries live in one contiguous array.
+     * Freed slots are reused in FIFO order and their generation is bumped, so stale ids do not match a new connection.
+     * It is not thread-safe, the shard guards it with its clients mutex.
+     */
+    template<typename T>
+    class connection_registry_c {
+    public:
+        static constexpr uint32_t max_slots = 1u << 24;
+
+        /// Shard index stored in the ids this registry hands out.
+        void set_shard(const uint16_t index) { shard = index; }
+
+        /**
+         * Store 'value' and return its id, or 0 if the registry is full.
+         */
+        connection_id_t insert(const std::shared_ptr<T> &value) {
+            uint32_t index;
+            if (!free_slots.empty()) {
+                index = free_slots.front();
+                free_slots.pop_front();
+            } else {
+                if (slots.size() >= max_slots)
+                    return 0;
+                index = static_cast<uint32_t>(slots.size());
+                slots.emplace_back();
+            }
+            slot_t &slot = slots[index];
+            slot.value = value;
+            ++count;
+            return make_id(index, slot.generation);
+        }
+
+        /**
+         * Remove the entry of 'id'. Returns false if it is not in the registry.
+         */
+        bool erase(const connection_id_t id) {
+            const size_t index = index_of(id);
+            if (index == npos)
+                return false;
+
+            release(index);
+            return true;
+        }
+
+        /**
+         * Return the entry of 'id', or nullptr if it is not in the registry.
+         */
+        std::shared_ptr<T> find(const connection_id_t id) const {
+            const size_t index = index_of(id);
+            return index == npos ? nullptr : slots[index].value;
+        }
+
+        /// Call 'fn(const std::shared_ptr<T> &)' for every entry.
+        template<typename Fn>
+        void for_each(Fn &&fn) const {
+            for (const slot_t &slot : slots) {
+                if (slot.value)
+                    fn(slot.value);
+            }
+        }
+
+        size_t size() const { return count; }
+
+        bool empty() const { return count == 0; }
+
+        /// Move every entry out of the registry. The ids handed out so far become invalid.
+        std::vector<std::shared_ptr<T>> take_all() {
+            std::vector<std::shared_ptr<T>> values;
+            values.reserve(count);
+            for (size_t index = 0; index < slots.size(); ++index) {
+                if (!slots[index].value)
+                    continue;
+                values.push_back(slots[index].value);
+                release(index);
+            }
+            return values;
+        }
+
+    private:
+        static constexpr uint32_t generation_mask = (1u << 24) - 1;
+        static constexpr size_t npos = static_cast<size_t>(-1);
+
+        struct slot_t {
+            std::shared_ptr<T> value;
+            uint32_t generation = 1;
+        };
+
+        std::vector<slot_t> slots;
+        std::deque<uint32_t> free_slots;
+        size_t count = 0;
+        uint16_t shard = 0;
+
+        connection_id_t make_id(const uint32_t index, const uint32_t generation) const {
+            return static_cast<connection_id_t>(shard) << 48 | static_cast<connection_id_t>(generation) << 24 | index;
+        }
+
+        size_t index_of(const connection_id_t id) const {
+            const size_t index = static_cast<size_t>(id & (max_slots - 1));
+            const uint32_t generation = static_cast<uint32_t>(id >> 24) & generation_mask;
+            if (connection_shard(id) != shard || index >= slots.size())
+                return npos;
+
+            const slot_t &slot = slots[index];
+            if (!slot.value || slot.generation != generation)
+                return npos;
+            return index;
+        }
+
+        void release(const size_t index) {
+            slot_t &slot = slots[index];
+            slot.value.reset();
+            slot.generation = (slot.generation + 1) & generation_mask;
+            if (slot.generation == 0)
+                slot.generation = 1;
+            free_slots.push_back(static_cast<uint32_t>(index));
+            --count;
+        }
+    };
+}
@@ -0,0 +1,195 @@
+/**
+ * MIT License (MIT)
+ * Copyright © 2025 Nathan Miguel
+*/
+
+#pragma once
+
+#include <asio.hpp>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace internetprotocol {
+    /**
+     * Options of the resolver cache.
+     *
+     * @par Example
+     * @code
+     * resolver_cache_options_t options;
+     * options.ttl_ms = 60000;
+     * resolver_cache().set_options(options);
+     * @endcode
+     */
+    struct resolver_cache_options_t {
+        /// Milliseconds a successful lookup is reused. 0 disables the cache.
+        uint32_t ttl_ms = 30000;
+        /// Milliseconds a failed lookup is reused, so a missing host does not hit the resolver on every connect.
+        uint32_t negative_ttl_ms = 5000;
+        /// Cached lookups kept at most. Expired entries are dropped first, then the oldest.
+        size_t max_entries = 1024;
+    };
+
+    /**
+     * Cache of TCP name lookups shared by every client of the process, see 'resolver_cache()'.
+     * asio does not expose the DNS record TTL, so entries expire after a fixed time instead.
+     * Numeric addresses never reach the resolver thread, their endpoint is built in place.
+     * Handlers always run on the executor of the resolver passed in, never inside 'async_resolve'.
+     */
+    class resolver_cache_c {
+    public:
+        typedef asio::ip::tcp::resolver::results_type results_type;
+
+        /// Apply 'options'. Entries already cached keep their expiry.
+        void set_options(const resolver_cache_options_t &options) {
+            std::lock_guard guard(mutex_cache);
+            cache_options = options;
+        }
+
+        /// Forget every cached lookup.
+        void clear() {
+            std::lock_guard guard(mutex_cache);
+            entries.clear();
+        }
+
+        /// Number of cached lookups, expired ones included.
+        size_t size() {
+            std::lock_guard guard(mutex_cache);
+            return entries.size();
+        }
+
+        /**
+         * Resolve 'host' and 'port' and call 'handler(const asio::error_code &, const results_type &)'.
+         *
+         * @param resolver Resolver used on a cache miss. The handler runs on its executor.
+         * @param protocol Address family to resolve, or std::nullopt for both.
+         * @param cached Use and fill the cache. False always asks the resolver.
+         */
+        template<typename Handler>
+        void async_resolve(asio::ip::tcp::resolver &resolver, const std::optional<asio::ip::tcp> &protocol,
+                           const std::string &host, const std::string &port, Handler handler, const bool cached = true) {
+            results_type results;
+            asio::error_code ec;
+            if (numeric(protocol, host, port, results) || (cached && find(key(protocol, host, port), results, ec))) {
+                asio::post(resolver.get_executor(), [handler = std::move(handler), ec, results]() mutable {
+                    handler(ec, results);
+                });
+                return;
+            }
+
+            auto done = [this, cached, entry_key = key(protocol, host, port), handler = std::move(handler)](
+                const asio::error_code &error, const results_type &resolved) mutable {
+                // A cancelled lookup says nothing about the host
+                if (cached && error != asio::error::operation_aborted)
+                    store(entry_key, resolved, error);
+                handler(error, resolved);
+            };
+            if (protocol)
+                resolver.async_resolve(*protocol, host, port, std::move(done));
+            else
+                resolver.async_resolve(host, port, std::move(done));
+        }
+
+    private:
+        struct entry_t {
+            results_type results;
+            asio::error_code error;
+            std::chrono::steady_clock::time_point stored;
+            std::chrono::steady_clock::time_point expires;
+        };
+
+        std::mutex mutex_cache;
+        resolver_cache_options_t cache_options;
+        std::unordered_map<std::string, entry_t> entries;
+
+        static std::string key(const std::optional<asio::ip::tcp> &protocol, const std::string &host, const std::string &port) {
+            std::string value;
+            value.reserve(host.size() + port.size() + 3);
+            value += !protocol ? '*' : protocol->family() == asio::ip::tcp::v4().family() ? '4' : '6';
+            value += host;
+            value += '\n';
+            value += port;
+            return value;
+        }
+
+        static bool numeric(const std::optional<asio::ip::tcp> &protocol, const std::string &host, const std::string &port,
+                            results_type &results) {
+            asio::error_code ec;
+            const asio::ip::address address = asio::ip::make_address(host, ec);
+            if (ec || port.empty() || port.find_first_not_of("0123456789") != std::string::npos || port.size() > 5)
+                return false;
+
+            const unsigned long number = std::stoul(port);
+            if (number > 65535)
+                return false;
+            if (protocol && (protocol->family() == asio::ip::tcp::v4().family()) != address.is_v4())
+                return false;
+
+            results = results_type::create(asio::ip::tcp::endpoint(address, static_cast<uint16_t>(number)), host, port);
+            return true;
+        }
+
+        bool find(const std::string &key, results_type &results, asio::error_code &ec) {
+            std::lock_guard guard(mutex_cache);
+            const auto it = entries.find(key);
+            if (it == entries.end())
+                return false;
+            if (it->second.expires <= std::chrono::steady_clock::now()) {
+                entries.erase(it);
+                return false;
+            }
+            results = it->second.results;
+            ec = it->second.error;
+            return true;
+        }
+
+        void store(const std::string &key, const results_type &results, const asio::error_code &error) {
+            std::lock_guard guard(mutex_cache);
+            const uint32_t ttl_ms = error ? cache_options.negative_ttl_ms : cache_options.ttl_ms;
+            if (cache_options.ttl_ms == 0 || ttl_ms == 0 || cache_options.max_entries == 0 || (!error && results.empty()))
+                return;
+
+            const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            if (entries.size() >= cache_options.max_entries && entries.find(key) == entries.end())
+                evict(now);
+
+            entry_t &entry = entries[key];
+            entry.results = results;
+            entry.error = error;
+            entry.stored = now;
+            entry.expires = now + std::chrono::milliseconds(ttl_ms);
+        }
+
+        // Make room for one entry: drop the expired ones, or the oldest if none has expired
+        void evict(const std::chrono::steady_clock::time_point now) {
+            auto oldest = entries.end();
+            for (auto it = entries.begin(); it != entries.end();) {
+                if (it->second.expires <= now) {
+                    it = entries.erase(it);
+                    continue;
+                }
+                if (oldest == entries.end() || it->second.stored < oldest->second.stored)
+                    oldest = it;
+                ++it;
+            }
+            if (entries.size() >= cache_options.max_entries && oldest != entries.end())
+                entries.erase(oldest);
+        }
+    };
+
+    /**
+     * The resolver cache shared by every client of the process.
+     *
+     * @par Example
+     * @code
+     * resolver_cache().clear();
+     * @endcode
+     */
+    inline resolver_cache_c &resolver_cache() {
+        static resolver_cache_c cache;
+        return cache;
+    }
+}
@@ -0,0 +1,253 @@
+/**
+ * MIT License (MIT)
+ * Copyright © 2025 Nathan Miguel
+*/
+
+#pragma once
+
+#include <asio.hpp>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#if defined(__linux__) || defined(__APPLE__)
+#include <pthread.h>
+#endif
+
+namespace internetprotocol {
+    struct runtime_options_t {
+        /// Number of threads. 0 uses std::thread::hardware_concurrency().
+        uint16_t threads = 0;
+        /// Thread name prefix, the thread index is appended ("ip-worker-0", "ip-worker-1", ...).
+        /// Linux truncates names to 15 characters. Empty keeps the default names.
+        std::string thread_name = "ip-worker";
+        /// CPU affinity masks. Thread i is pinned to affinity_masks[i % size], bit n selects CPU n.
+        /// Empty disables pinning. Ignored on macOS, which has no thread affinity API.
+        std::vector<uint64_t> affinity_masks;
+        /// Microseconds each thread spins on poll() before blocking, see run_context(). 0 disables spinning.
+        uint32_t busy_poll_us = 0;
+    };
+
+    /**
+     * Run the io_context until it is stopped or runs out of work.
+     * When 'spin_us' is greater than 0, the calling thread spins on poll() for up to 'spin_us' microseconds
+     * after the last handler ran before it blocks in run_one(). This trades a busy core for lower wakeup latency.
+     *
+     * @param context The io_context to run.
+     * @param spin_us Spin budget in microseconds. 0 just calls run().
+     */
+    inline void run_context(asio::io_context &context, const uint32_t spin_us) {
+        if (spin_us == 0) {
+            context.run();
+            return;
+        }
+
+        const std::chrono::microseconds budget(spin_us);
+        std::chrono::steady_clock::time_point last_work = std::chrono::steady_clock::now();
+        while (!context.stopped()) {
+            if (context.poll() > 0) {
+                last_work = std::chrono::steady_clock::now();
+                continue;
+            }
+            // poll() stops the context once it runs out of work
+            if (context.stopped())
+                break;
+            if (std::chrono::steady_clock::now() - last_work < budget)
+                continue;
+            if (context.run_one() == 0)
+                break;
+            last_work = std::chrono::steady_clock::now();
+        }
+    }
+
+    class runtime_c {
+    public:
+        explicit runtime_c(const runtime_options_t &options = {}): options(options) {}
+
+        runtime_c(const runtime_c &) = delete;
+        runtime_c &operator=(const runtime_c &) = delete;
+
+        ~runtime_c() {
+            stop();
+            join();
+        }
+
+        /**
+         * Return the io_context driven by the runtime threads, starting them on first use.
+         * Clients constructed with a runtime run their sockets on this io_context.
+         *
+         * @par Example
+         * @code
+         * runtime_c runtime({ 2, "net", { 0x4, 0x8 } });
+         * tcp_client_c client(runtime.context());
+         * @endcode
+         */
+        asio::io_context &context() {
+            start();
+            return io_context;
+        }
+
+        /**
+         * Return an executor of the runtime io_context, starting the threads on first use.
+         *
+         * @par Example
+         * @code
+         * runtime_c runtime;
+         * asio::post(runtime.get_executor(), [&]() {
+         *      // your code...
+         * });
+         * @endcode
+         */
+        asio::io_context::executor_type get_executor() {
+            start();
+            return io_context.get_executor();
+        }
+
+        /**
+         * Return true if the runtime threads are started.
+         *
+         * @par Example
+         * @code
+         * runtime_c runtime;
+         * bool is_running = runtime.is_running();
+         * @endcode
+         */
+        bool is_running() const { return running.load(); }
+
+        /**
+         * Return the options used to start the threads.
+         *
+         * @par Example
+         * @code
+         * runtime_c runtime;
+         * uint16_t threads = runtime.get_options().threads;
+         * @endcode
+         */
+        const runtime_options_t &get_options() const { return options; }
+
+        /**
+         * Return the number of threads the runtime runs, resolving a 'threads' option of 0.
+         *
+         * @par Example
+         * @code
+         * runtime_c runtime;
+         * uint16_t threads = runtime.thread_count();
+         * @endcode
+         */
+        uint16_t thread_count() const {
+            if (options.threads > 0)
+                return options.threads;
+
+            const unsigned int hardware_threads = std::thread::hardware_concurrency();
+            return static_cast<uint16_t>(hardware_threads > 0 ? hardware_threads : 1);
+        }
+
+        /**
+         * This function stops the threads as soon as possible. As a result of calling stop(), pending function objects may be never be invoked.
+         *
+         * @par Example
+         * @code
+         * runtime_c runtime;
+         * runtime.stop();
+         * @endcode
+         */
+        void stop() {
+            io_context.stop();
+        }
+
+        /**
+         * This function blocks until the threads have completed. If stop() is not called prior to join(), the join() call will wait until the runtime has no more outstanding work.
+         * The threads are started again on the next call to context() or get_executor().
+         *
+         * @par Example
+         * @code
+         * runtime_c runtime;
+         * runtime.join();
+         * @endcode
+         */
+        void join() {
+            std::lock_guard guard(mutex_threads);
+            if (!running.load())
+                return;
+
+            work_guard.reset();
+            for (std::thread &thread : threads) {
+                if (thread.joinable())
+                    thread.join();
+            }
+            threads.clear();
+            io_context.restart();
+            running.store(false);
+        }
+
+    private:
+        runtime_options_t options;
+        asio::io_context io_context;
+        std::unique_ptr<asio::executor_work_guard<asio::io_context::executor_type>> work_guard;
+        std::mutex mutex_threads;
+        std::vector<std::thread> threads;
+        std::atomic<bool> running = false;
+
+        void start() {
+            if (running.load())
+                return;
+
+            std::lock_guard guard(mutex_threads);
+            if (running.load())
+                return;
+
+            work_guard = std::make_unique<asio::executor_work_guard<asio::io_context::executor_type>>(io_context.get_executor());
+            const uint16_t count = thread_count();
+            threads.reserve(count);
+            for (uint16_t i = 0; i < count; ++i) {
+                threads.emplace_back([this, i]() {
+                    setup_thread(i);
+                    run_context(io_context, options.busy_poll_us);
+                });
+            }
+            running.store(true);
+        }
+
+        void setup_thread(const uint16_t index) const {
+            const std::string name = options.thread_name.empty() ? "" : options.thread_name + "-" + std::to_string(index);
+            const uint64_t mask = options.affinity_masks.empty()
+                                      ? 0
+                                      : options.affinity_masks[index % options.affinity_masks.size()];
+#if defined(__linux__)
+            if (!name.empty())
+                pthread_setname_np(pthread_self(), name.substr(0, 15).c_str());
+            if (mask != 0) {
+                cpu_set_t cpus;
+                CPU_ZERO(&cpus);
+                for (int cpu = 0; cpu < 64; ++cpu) {
+                    if (mask & (static_cast<uint64_t>(1) << cpu))
+                        CPU_SET(cpu, &cpus);
+                }
+                pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpus);
+            }
+#elif defined(__APPLE__)
+            if (!name.empty())
+                pthread_setname_np(name.c_str());
+#elif defined(_WIN32)
+            if (!name.empty()) {
+                const std::wstring wide_name(name.begin(), name.end());
+                SetThreadDescription(GetCurrentThread(), wide_name.c_str());
+            }
+            if (mask != 0)
+                SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(mask));
+#endif
+        }
+    };
+
+    /**
+     * Return the runtime used by servers and clients constructed without one.
+     * It is created on first use, and its threads are started when the first server or client needs them.
+     */
+    inline runtime_c &default_runtime() {
+        static runtime_c runtime;
+        return runtime;
+    }
+}
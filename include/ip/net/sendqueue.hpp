@@ -0,0 +1,721 @@
+/**
+ * MIT License (MIT)
+ * Copyright © 2025 Nathan Miguel
+*/
+
+#pragma once
+
+#include <asio.hpp>
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <csignal>
+#include <linux/errqueue.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#if defined(MSG_ZEROCOPY) && defined(SO_ZEROCOPY) && defined(SO_EE_ORIGIN_ZEROCOPY)
+#define IP_HAS_MSG_ZEROCOPY
+#endif
+#endif
+#include "ip/net/bufferpool.hpp"
+
+namespace internetprotocol {
+    /// Immutable, encoded message shared by the send queues of many connections, e.g. a broadcast frame.
+    typedef std::shared_ptr<const std::vector<uint8_t>> shared_buffer_t;
+
+    /**
+     * Per-connection write queue. Only one write is in flight on the stream at a time.
+     * Queued messages are sent together with a single gather write, up to 'max_batch_bytes' per write.
+     * Callbacks run on the stream executor, in the order the messages were pushed.
+     * Messages are held in buffer_pool_c blocks, which go back to the pool once written.
+     * Optional high/low watermarks on the queued bytes report when the peer falls behind and when it has caught up.
+     * File regions can be queued between messages. On Linux plain TCP sockets they are sent with sendfile(2).
+     * Large messages can be sent with MSG_ZEROCOPY on Linux plain TCP sockets, see 'set_zerocopy_threshold()'.
+     */
+    template<typename Stream>
+    class send_queue_c {
+    public:
+        /// Upper bound on messages per gather write, matching the iovec count asio passes to a single writev.
+        static constexpr size_t max_batch_buffers = 64;
+
+        /**
+         * @param stream Stream to write to. Its executor must be a strand when 'push' is called from several threads.
+         * @param linearize Copy a batch into one contiguous buffer before writing. Use it for TLS streams,
+         * which encrypt one buffer per record and would otherwise gain nothing from a gather write.
+         */
+        explicit send_queue_c(Stream &stream, const bool linearize = false): stream(stream),
+                                                                             pool(buffer_pool_c::get(stream.get_executor())),
+                                                                             linearize(linearize) {
+        }
+
+        send_queue_c(const send_queue_c &) = delete;
+        send_queue_c &operator=(const send_queue_c &) = delete;
+
+        /// Maximum number of bytes coalesced into one write. A single larger message is still sent whole.
+        size_t max_batch_bytes = 64 * 1024;
+
+        /// Take an empty block from the pool, for callers that encode a message in place before pushing it.
+        std::vector<uint8_t> acquire(const size_t size) {
+            return pool.acquire(size);
+        }
+
+        /// Queue a copy of 'size' bytes at 'data'.
+        void push(const void *data, const size_t size, std::function<void(const asio::error_code &, const size_t)> callback = nullptr) {
+            std::vector<uint8_t> block = pool.acquire(size);
+            block.resize(size);
+            std::memcpy(block.data(), data, size);
+            push(std::move(block), std::move(callback));
+        }
+
+        /// Queue 'block' without copying it. It is returned to the pool after it has been written.
+        void push(std::vector<uint8_t> &&block, std::function<void(const asio::error_code &, const size_t)> callback = nullptr) {
+            send_item_t item;
+            item.bytes = std::move(block);
+            item.callback = std::move(callback);
+            enqueue(std::move(item));
+        }
+
+        /// Queue a shared message without copying it. The queue keeps a reference until it has been written.
+        void push(const shared_buffer_t &buffer, std::function<void(const asio::error_code &, const size_t)> callback = nullptr) {
+            send_item_t item;
+            item.shared = buffer;
+            item.callback = std::move(callback);
+            enqueue(std::move(item));
+        }
+
+#ifdef ASIO_HAS_CO_AWAIT
+        /// Awaitable version of 'push()'. The bytes are copied before the first suspension.
+        asio::awaitable<std::tuple<asio::error_code, size_t>> async_push(const void *data, const size_t size) {
+            asio::error_code ec;
+            auto token = asio::redirect_error(asio::use_awaitable, ec);
+            const size_t bytes_sent = co_await asio::async_initiate<decltype(token), void(asio::error_code, size_t)>(
+                [this, data, size](auto handler) {
+                    using handler_t = decltype(handler);
+                    std::shared_ptr<handler_t> shared_handler = std::make_shared<handler_t>(std::move(handler));
+                    push(data, size, [shared_handler](const asio::error_code &error, const size_t bytes) {
+                        asio::post(asio::get_associated_executor(*shared_handler),
+                                   [shared_handler, error, bytes]() mutable {
+                                       std::move(*shared_handler)(error, bytes);
+                                   });
+                    });
+                },
+                token);
+            co_return std::make_tuple(ec, bytes_sent);
+        }
+#endif
+
+#ifndef _WIN32
+        /**
+         * Queue 'length' bytes of the open file 'fd' starting at 'offset'. A 'length' of 0 sends up to the end of the file.
+         * The descriptor is not closed and must stay open until the callback. Returns false if 'offset' and 'length' go past the end of the file.
+         */
+        bool push_file(const int fd, const uint64_t offset, const uint64_t length,
+                       std::function<void(const asio::error_code &, const size_t)> callback = nullptr) {
+            return queue_file(fd, false, offset, length, std::move(callback));
+        }
+
+        /**
+         * Open 'path' and queue it like 'push_file(fd, ...)'. The file is closed once it has been sent.
+         * Returns false if it cannot be opened or if 'offset' and 'length' go past its end.
+         */
+        bool push_file(const std::string &path, const uint64_t offset, const uint64_t length,
+                       std::function<void(const asio::error_code &, const size_t)> callback = nullptr) {
+            const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0)
+                return false;
+
+            if (!queue_file(fd, true, offset, length, std::move(callback))) {
+                ::close(fd);
+                return false;
+            }
+            return true;
+        }
+#endif
+
+        /// Whether this stream type can send with MSG_ZEROCOPY on this system.
+#ifdef IP_HAS_MSG_ZEROCOPY
+        static constexpr bool supports_zerocopy = std::is_same_v<Stream, asio::ip::tcp::socket>;
+#else
+        static constexpr bool supports_zerocopy = false;
+#endif
+
+        /**
+         * Send messages of at least 'threshold' bytes with MSG_ZEROCOPY, so the kernel transmits them from the message
+         * block instead of copying it. Each one is sent alone and its callback runs once the kernel has released the block.
+         * Only Linux plain TCP sockets support it; the stream must be open. Returns false if it is not supported.
+         * A 'threshold' of 0 disables it.
+         */
+        bool set_zerocopy_threshold(const size_t threshold) {
+#ifdef IP_HAS_MSG_ZEROCOPY
+            if constexpr (std::is_same_v<Stream, asio::ip::tcp::socket>) {
+                if (threshold > 0) {
+                    asio::error_code ec;
+                    stream.set_option(zerocopy_t(true), ec);
+                    if (ec)
+                        return false;
+                }
+                zerocopy_threshold = threshold;
+                return true;
+            }
+#endif
+            return threshold == 0;
+        }
+
+        /// Number of messages waiting to be written, not counting the batch in flight.
+        size_t pending() {
+            std::lock_guard guard(mutex_queue);
+            return queue.size();
+        }
+
+        /// Bytes pushed and not written yet, including the batch in flight.
+        size_t queued_bytes() {
+            std::lock_guard guard(mutex_queue);
+            return queued;
+        }
+
+        /**
+         * Call 'fn' once every queued message has been sent: right away if nothing is being written,
+         * otherwise on the stream executor the first time the writer goes idle. Messages pushed meanwhile are waited for too.
+         */
+        void when_flushed(std::function<void()> fn) {
+            {
+                std::lock_guard guard(mutex_queue);
+                if (writing) {
+                    flushed_waiters.push_back(std::move(fn));
+                    return;
+                }
+            }
+            fn();
+        }
+
+        /**
+         * Call 'backpressure' when the queued bytes reach 'high', then 'drain' once they fall back to 'low' or below.
+         * 'backpressure' runs on the thread that pushed, 'drain' on the stream executor. A 'high' of 0 disables them.
+         */
+        void set_watermarks(const size_t high, const size_t low, std::function<void()> backpressure, std::function<void()> drain) {
+            std::lock_guard guard(mutex_queue);
+            high_watermark = high;
+            low_watermark = std::min(low, high);
+            on_backpressure = std::move(backpressure);
+            on_drain = std::move(drain);
+            above_high_watermark = false;
+        }
+
+    private:
+#ifdef IP_HAS_MSG_ZEROCOPY
+        typedef asio::detail::socket_option::boolean<SOL_SOCKET, SO_ZEROCOPY> zerocopy_t;
+#endif
+
+        struct send_item_t {
+            std::vector<uint8_t> bytes;
+            // Shared message sent instead of 'bytes'
+            shared_buffer_t shared;
+            std::function<void(const asio::error_code &, const size_t)> callback;
+            // File region sent instead of 'bytes', -1 for a message
+            int file = -1;
+            bool owns_file = false;
+            uint64_t file_offset = 0;
+            uint64_t file_length = 0;
+
+            const uint8_t *data() const { return shared ? shared->data() : bytes.data(); }
+
+            asio::const_buffer buffer() const { return asio::buffer(data(), size()); }
+
+            size_t size() const { return shared ? shared->size() : bytes.size(); }
+        };
+
+        Stream &stream;
+        buffer_pool_c &pool;
+        bool linearize;
+        std::mutex mutex_queue;
+        std::deque<send_item_t> queue;
+        bool writing = false;
+        std::vector<send_item_t> in_flight;
+        std::vector<asio::const_buffer> buffers;
+        std::vector<uint8_t> flat;
+        size_t queued = 0;
+        size_t high_watermark = 0;
+        size_t low_watermark = 0;
+        bool above_high_watermark = false;
+        std::function<void()> on_backpressure;
+        std::function<void()> on_drain;
+        std::vector<std::function<void()>> flushed_waiters;
+        // File region being sent, and how much of it has been sent so far
+        send_item_t file_item;
+        size_t file_sent = 0;
+        // Message sent with MSG_ZEROCOPY, how much of it has been sent and how many completions are still due
+        size_t zerocopy_threshold = 0;
+        bool zerocopy_active = false;
+        bool zerocopy_waiting = false;
+        send_item_t zerocopy_item;
+        size_t zerocopy_offset = 0;
+        uint32_t zerocopy_pending = 0;
+        asio::error_code zerocopy_error;
+
+        void enqueue(send_item_t item) {
+            bool start_write = false;
+            std::function<void()> backpressure;
+            {
+                std::lock_guard guard(mutex_queue);
+                queued += item.size();
+                queue.push_back(std::move(item));
+                if (high_watermark > 0 && !above_high_watermark && queued >= high_watermark) {
+                    above_high_watermark = true;
+                    backpressure = on_backpressure;
+                }
+                if (!writing) {
+                    writing = true;
+                    start_write = true;
+                }
+            }
+            if (backpressure)
+                backpressure();
+            if (!start_write)
+                return;
+
+            asio::post(stream.get_executor(), [this]() {
+                flush();
+            });
+        }
+
+        // Runs on the stream executor
+        void flush() {
+            {
+                std::lock_guard guard(mutex_queue);
+                if (queue.front().file >= 0) {
+                    file_item = std::move(queue.front());
+                    queue.pop_front();
+                } else if (takes_zerocopy(queue.front())) {
+                    zerocopy_item = std::move(queue.front());
+                    queue.pop_front();
+                    zerocopy_active = true;
+                }
+                size_t batch_bytes = 0;
+                while (file_item.file < 0 && !zerocopy_active && !queue.empty() && in_flight.size() < max_batch_buffers) {
+                    // File regions and zero-copy messages start their own write once the messages before them are out
+                    if (queue.front().file >= 0 || takes_zerocopy(queue.front()))
+                        break;
+
+                    const size_t size = queue.front().size();
+                    if (!in_flight.empty() && batch_bytes + size > max_batch_bytes)
+                        break;
+
+                    batch_bytes += size;
+                    in_flight.push_back(std::move(queue.front()));
+                    queue.pop_front();
+                }
+            }
+
+            if (file_item.file >= 0) {
+                send_file_region();
+                return;
+            }
+#ifdef IP_HAS_MSG_ZEROCOPY
+            if constexpr (std::is_same_v<Stream, asio::ip::tcp::socket>) {
+                if (zerocopy_active) {
+                    send_zerocopy();
+                    return;
+                }
+            }
+#endif
+
+            buffers.clear();
+            if (linearize && in_flight.size() > 1) {
+                size_t batch_bytes = 0;
+                for (const send_item_t &item : in_flight)
+                    batch_bytes += item.size();
+                flat = pool.acquire(batch_bytes);
+                for (const send_item_t &item : in_flight)
+                    flat.insert(flat.end(), item.data(), item.data() + item.size());
+                buffers.push_back(asio::buffer(flat.data(), flat.size()));
+            } else {
+                for (const send_item_t &item : in_flight)
+                    buffers.push_back(item.buffer());
+            }
+
+            asio::async_write(stream, buffers, [this](const asio::error_code &ec, const size_t bytes_sent) {
+                write_cb(ec, bytes_sent);
+            });
+        }
+
+        void write_cb(const asio::error_code &error, size_t bytes_sent) {
+            if (!flat.empty())
+                pool.release(std::move(flat));
+            flat = std::vector<uint8_t>();
+            std::vector<send_item_t> done;
+            done.swap(in_flight);
+            size_t done_bytes = 0;
+            for (send_item_t &item : done) {
+                done_bytes += item.size();
+                const size_t sent = std::min(item.size(), bytes_sent);
+                bytes_sent -= sent;
+                if (item.callback)
+                    item.callback(error, sent);
+                pool.release(std::move(item.bytes));
+            }
+            done.clear();
+            // Keep the allocation for the next batch
+            in_flight.swap(done);
+
+            next(done_bytes);
+        }
+
+        // Account for 'done_bytes' written and start the next write, if anything is queued
+        void next(const size_t done_bytes) {
+            bool more = true;
+            std::function<void()> drain;
+            std::vector<std::function<void()>> flushed;
+            {
+                std::lock_guard guard(mutex_queue);
+                queued -= std::min(done_bytes, queued);
+                if (above_high_watermark && queued <= low_watermark) {
+                    above_high_watermark = false;
+                    drain = on_drain;
+                }
+                if (queue.empty()) {
+                    writing = false;
+                    more = false;
+                    flushed.swap(flushed_waiters);
+                }
+            }
+            if (drain)
+                drain();
+            for (std::function<void()> &fn : flushed)
+                fn();
+            if (more)
+                flush();
+        }
+
+#ifndef _WIN32
+        bool queue_file(const int fd, const bool owns_file, const uint64_t offset, uint64_t length,
+                        std::function<void(const asio::error_code &, const size_t)> callback) {
+            struct stat info{};
+            if (::fstat(fd, &info) != 0 || static_cast<uint64_t>(info.st_size) < offset)
+                return false;
+
+            const uint64_t available = static_cast<uint64_t>(info.st_size) - offset;
+            if (length == 0)
+                length = available;
+            else if (length > available)
+                return false;
+
+            send_item_t item;
+            item.callback = std::move(callback);
+            item.file = fd;
+            item.owns_file = owns_file;
+            item.file_offset = offset;
+            item.file_length = length;
+            enqueue(std::move(item));
+            return true;
+        }
+#endif
+
+        bool takes_zerocopy(const send_item_t &item) const {
+            return zerocopy_threshold > 0 && item.size() >= zerocopy_threshold;
+        }
+
+#ifdef IP_HAS_MSG_ZEROCOPY
+        // Runs on the stream executor
+        void send_zerocopy() {
+            const int fd = stream.native_handle();
+            const uint8_t *data = zerocopy_item.data();
+            const size_t size = zerocopy_item.size();
+            while (zerocopy_offset < size) {
+                const ssize_t bytes_sent = ::send(fd, data + zerocopy_offset, size - zerocopy_offset,
+                                                  MSG_ZEROCOPY | MSG_NOSIGNAL | MSG_DONTWAIT);
+                if (bytes_sent >= 0) {
+                    // Every successful call is reported once on the error queue
+                    zerocopy_offset += static_cast<size_t>(bytes_sent);
+                    ++zerocopy_pending;
+                    continue;
+                }
+                if (errno == EINTR)
+                    continue;
+                if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    stream.async_wait(asio::socket_base::wait_write, [this](const asio::error_code &ec) {
+                        if (ec) {
+                            zerocopy_error = ec;
+                            wait_zerocopy();
+                            return;
+                        }
+                        send_zerocopy();
+                    });
+                    return;
+                }
+                if (errno == ENOBUFS) {
+                    // Out of memory to pin pages (optmem_max): send the rest with a regular copy
+                    asio::async_write(stream, asio::buffer(data + zerocopy_offset, size - zerocopy_offset),
+                                      [this](const asio::error_code &ec, const size_t bytes_written) {
+                                          zerocopy_offset += bytes_written;
+                                          zerocopy_error = ec;
+                                          wait_zerocopy();
+                                      });
+                    return;
+                }
+                zerocopy_error = asio::error_code(errno, asio::error::get_system_category());
+                break;
+            }
+            wait_zerocopy();
+        }
+
+        // Consume the MSG_ZEROCOPY completions on the socket error queue. Returns false if there was none.
+        bool read_zerocopy_completions() {
+            bool progress = false;
+            while (true) {
+                char control[128];
+                msghdr message{};
+                message.msg_control = control;
+                message.msg_controllen = sizeof(control);
+                if (::recvmsg(stream.native_handle(), &message, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+                    if (errno == EINTR)
+                        continue;
+                    return progress;
+                }
+
+                for (cmsghdr *header = CMSG_FIRSTHDR(&message); header; header = CMSG_NXTHDR(&message, header)) {
+                    const bool recv_error = (header->cmsg_level == SOL_IP && header->cmsg_type == IP_RECVERR)
+                                            || (header->cmsg_level == SOL_IPV6 && header->cmsg_type == IPV6_RECVERR);
+                    if (!recv_error)
+                        continue;
+
+                    sock_extended_err error{};
+                    std::memcpy(&error, CMSG_DATA(header), sizeof(error));
+                    if (error.ee_errno != 0 || error.ee_origin != SO_EE_ORIGIN_ZEROCOPY)
+                        continue;
+
+                    // ee_info..ee_data is the range of completed calls, copied or not
+                    const uint32_t completed = error.ee_data - error.ee_info + 1;
+                    zerocopy_pending -= std::min(completed, zerocopy_pending);
+                    progress = true;
+                }
+            }
+        }
+
+        // Wait until the kernel no longer references the message block
+        void wait_zerocopy() {
+            const bool progress = read_zerocopy_completions();
+            if (zerocopy_pending == 0) {
+                finish_zerocopy();
+                return;
+            }
+
+            if (!zerocopy_waiting) {
+                zerocopy_waiting = true;
+                stream.async_wait(asio::socket_base::wait_error, [this](const asio::error_code &ec) {
+                    zerocopy_waiting = false;
+                    if (!zerocopy_active)
+                        return;
+
+                    if (ec) {
+                        // The stream is closed, the kernel keeps the pages pinned for as long as it needs them
+                        abort_zerocopy(ec);
+                        return;
+                    }
+                    wait_zerocopy();
+                });
+            }
+
+            // A completion queued before the wait was armed would not wake it up
+            pollfd poll_fd{stream.native_handle(), 0, 0};
+            if (::poll(&poll_fd, 1, 0) <= 0 || !(poll_fd.revents & POLLERR))
+                return;
+
+            int socket_error = 0;
+            socklen_t length = sizeof(socket_error);
+            ::getsockopt(stream.native_handle(), SOL_SOCKET, SO_ERROR, &socket_error, &length);
+            if (socket_error != 0 && !progress) {
+                abort_zerocopy(asio::error_code(socket_error, asio::error::get_system_category()));
+                return;
+            }
+            asio::post(stream.get_executor(), [this]() {
+                if (zerocopy_active)
+                    wait_zerocopy();
+            });
+        }
+
+        void abort_zerocopy(const asio::error_code &error) {
+            zerocopy_pending = 0;
+            if (!zerocopy_error)
+                zerocopy_error = error;
+            finish_zerocopy();
+        }
+
+        void finish_zerocopy() {
+            send_item_t item = std::move(zerocopy_item);
+            zerocopy_item = send_item_t();
+            zerocopy_active = false;
+            const size_t sent = zerocopy_offset;
+            const asio::error_code error = zerocopy_error;
+            zerocopy_offset = 0;
+            zerocopy_error.clear();
+            if (item.callback)
+                item.callback(error, sent);
+            const size_t size = item.size();
+            pool.release(std::move(item.bytes));
+            next(size);
+        }
+#endif
+
+        // Runs on the stream executor
+        void send_file_region() {
+#ifdef __linux__
+            if constexpr (std::is_same_v<Stream, asio::ip::tcp::socket>) {
+                asio::error_code ec;
+                stream.native_non_blocking(true, ec);
+                if (!ec) {
+                    sendfile_region();
+                    return;
+                }
+            }
+#endif
+            read_file_chunk();
+        }
+
+        void advance_file(const size_t bytes) {
+            file_item.file_offset += bytes;
+            file_item.file_length -= bytes;
+            file_sent += bytes;
+        }
+
+        void file_done(const asio::error_code &error) {
+            send_item_t item = std::move(file_item);
+            file_item = send_item_t();
+            const size_t sent = file_sent;
+            file_sent = 0;
+#ifndef _WIN32
+            if (item.owns_file)
+                ::close(item.file);
+#endif
+            if (item.callback)
+                item.callback(error, sent);
+            next(0);
+        }
+
+        // Fallback for TLS streams and platforms without sendfile: read the file through pooled blocks
+        void read_file_chunk() {
+#ifndef _WIN32
+            if (file_item.file_length == 0) {
+                file_done(asio::error_code());
+                return;
+            }
+
+            const size_t chunk = static_cast<size_t>(std::min<uint64_t>(file_item.file_length, max_batch_bytes));
+            flat = pool.acquire(chunk);
+            flat.resize(chunk);
+            ssize_t bytes_read;
+            do {
+                bytes_read = ::pread(file_item.file, flat.data(), chunk, static_cast<off_t>(file_item.file_offset));
+            } while (bytes_read < 0 && errno == EINTR);
+            if (bytes_read <= 0) {
+                pool.release(std::move(flat));
+                flat = std::vector<uint8_t>();
+                file_done(bytes_read == 0
+                              ? asio::error_code(asio::error::eof)
+                              : asio::error_code(errno, asio::error::get_system_category()));
+                return;
+            }
+
+            flat.resize(static_cast<size_t>(bytes_read));
+            asio::async_write(stream, asio::buffer(flat.data(), flat.size()), [this](const asio::error_code &ec, const size_t bytes_sent) {
+                pool.release(std::move(flat));
+                flat = std::vector<uint8_t>();
+                advance_file(bytes_sent);
+                if (ec) {
+                    file_done(ec);
+                    return;
+                }
+                read_file_chunk();
+            });
+#else
+            file_done(asio::error::operation_not_supported);
+#endif
+        }
+
+#ifdef __linux__
+        /// Bytes sent with sendfile() before yielding the executor to other connections.
+        static constexpr size_t max_sendfile_burst = 1024 * 1024;
+
+        // sendfile() raises SIGPIPE on a reset connection, which would end the process. It is blocked around
+        // the call and a signal raised by it is discarded, so the error comes back as EPIPE like on other writes.
+        static ssize_t sendfile_nosignal(const int out_fd, const int in_fd, off_t *offset, const size_t count) {
+            sigset_t pipe_mask;
+            sigset_t old_mask;
+            sigemptyset(&pipe_mask);
+            sigaddset(&pipe_mask, SIGPIPE);
+            pthread_sigmask(SIG_BLOCK, &pipe_mask, &old_mask);
+            const ssize_t bytes_sent = ::sendfile(out_fd, in_fd, offset, count);
+            const int error = errno;
+            if (bytes_sent < 0 && error == EPIPE) {
+                sigset_t pending;
+                sigpending(&pending);
+                if (sigismember(&pending, SIGPIPE)) {
+                    const timespec no_wait{0, 0};
+                    sigtimedwait(&pipe_mask, nullptr, &no_wait);
+                }
+            }
+            pthread_sigmask(SIG_SETMASK, &old_mask, nullptr);
+            errno = error;
+            return bytes_sent;
+        }
+
+        // Move the file straight from the page cache to the socket, waiting for it to become writable when full
+        void sendfile_region() {
+            size_t burst = 0;
+            while (file_item.file_length > 0) {
+                if (burst >= max_sendfile_burst) {
+                    asio::post(stream.get_executor(), [this]() {
+                        sendfile_region();
+                    });
+                    return;
+                }
+
+                off_t offset = static_cast<off_t>(file_item.file_offset);
+                const size_t count = static_cast<size_t>(std::min<uint64_t>(file_item.file_length, max_sendfile_burst));
+                const ssize_t bytes_sent = sendfile_nosignal(stream.native_handle(), file_item.file, &offset, count);
+                if (bytes_sent > 0) {
+                    advance_file(static_cast<size_t>(bytes_sent));
+                    burst += static_cast<size_t>(bytes_sent);
+                    continue;
+                }
+                if (bytes_sent == 0) {
+                    // The file is shorter than the region
+                    file_done(asio::error::eof);
+                    return;
+                }
+                if (errno == EINTR)
+                    continue;
+                if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    stream.async_wait(asio::socket_base::wait_write, [this](const asio::error_code &ec) {
+                        if (ec) {
+                            file_done(ec);
+                            return;
+                        }
+                        sendfile_region();
+                    });
+                    return;
+                }
+                file_done(asio::error_code(errno, asio::error::get_system_category()));
+                return;
+            }
+            file_done(asio::error_code());
+        }
+#endif
+    };
+}
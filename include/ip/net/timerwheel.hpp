@@ -0,0 +1,328 @@
+/**
+ * MIT License (MIT)
+ * Copyright © 2025 Nathan Miguel
+*/
+
+#pragma once
+
+#include <asio.hpp>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace internetprotocol {
+    /**
+     * Hierarchical timer wheel shared by every connection of an io_context.
+     * Each io_context gets a single instance through asio::use_service, driven by one steady_timer
+     * that only ticks while at least one wheel_timer_c is armed.
+     * Starting, refreshing, cancelling and expiring a timer are O(1). Refreshing is lock-free,
+     * so idle timeouts can be pushed forward on every read and write without touching the timer queue.
+     */
+    class timer_wheel_c : public asio::execution_context::service {
+    public:
+        static inline asio::execution_context::id id;
+
+        /// Tick length. Timeouts are rounded up to a whole number of ticks.
+        static constexpr std::chrono::milliseconds resolution{100};
+
+        explicit timer_wheel_c(asio::io_context &io_context): asio::execution_context::service(io_context),
+                                                              timer(io_context),
+                                                              origin(std::chrono::steady_clock::now()) {
+        }
+
+        struct entry_t {
+            explicit entry_t(const asio::any_io_executor &executor): executor(executor) {}
+
+            asio::any_io_executor executor;
+            std::function<void()> callback;
+            uint64_t interval = 0;
+            std::atomic<uint64_t> deadline = 0;
+            std::atomic<uint64_t> generation = 0;
+            std::atomic<bool> armed = false;
+        };
+
+        void start(const std::shared_ptr<entry_t> &entry, const std::chrono::steady_clock::duration timeout,
+                   std::function<void()> callback) {
+            std::lock_guard guard(mutex_wheel);
+            entry->callback = std::move(callback);
+            entry->interval = std::max<uint64_t>(1, (timeout + resolution - std::chrono::nanoseconds(1)) / resolution);
+            arm(entry);
+        }
+
+        void refresh(const std::shared_ptr<entry_t> &entry) {
+            if (entry->armed.load(std::memory_order_acquire)) {
+                entry->deadline.store(current_tick.load(std::memory_order_relaxed) + entry->interval + 1,
+                                      std::memory_order_relaxed);
+                return;
+            }
+
+            std::lock_guard guard(mutex_wheel);
+            if (entry->callback)
+                arm(entry);
+        }
+
+        void cancel(const std::shared_ptr<entry_t> &entry) {
+            std::lock_guard guard(mutex_wheel);
+            entry->generation.fetch_add(1);
+            // Only 'start()' may arm it again, a late refresh must not revive it
+            entry->callback = nullptr;
+            if (!entry->armed.load())
+                return;
+
+            entry->armed.store(false, std::memory_order_release);
+            if (--active == 0)
+                stop();
+        }
+
+    private:
+        static constexpr size_t near_bits = 8;
+        static constexpr size_t far_bits = 6;
+        static constexpr size_t far_levels = 3;
+
+        struct slot_item_t {
+            std::shared_ptr<entry_t> entry;
+            uint64_t generation;
+        };
+
+        std::mutex mutex_wheel;
+        asio::steady_timer timer;
+        std::chrono::steady_clock::time_point origin;
+        std::atomic<uint64_t> current_tick = 0;
+        size_t active = 0;
+        bool running = false;
+        std::array<std::vector<slot_item_t>, 1 << near_bits> near_slots;
+        std::array<std::array<std::vector<slot_item_t>, 1 << far_bits>, far_levels> far_slots;
+        std::vector<slot_item_t> scratch;
+
+        void shutdown() override {
+            std::lock_guard guard(mutex_wheel);
+            for (std::vector<slot_item_t> &slot : near_slots) {
+                for (const slot_item_t &item : slot)
+                    item.entry->armed.store(false);
+            }
+            for (std::array<std::vector<slot_item_t>, 1 << far_bits> &level : far_slots) {
+                for (std::vector<slot_item_t> &slot : level) {
+                    for (const slot_item_t &item : slot)
+                        item.entry->armed.store(false);
+                }
+            }
+            clear_slots();
+            active = 0;
+            running = false;
+        }
+
+        uint64_t now_tick() const {
+            return static_cast<uint64_t>((std::chrono::steady_clock::now() - origin) / resolution);
+        }
+
+        // Call with mutex_wheel held
+        void arm(const std::shared_ptr<entry_t> &entry) {
+            if (!entry->armed.load()) {
+                entry->armed.store(true, std::memory_order_release);
+                if (active++ == 0)
+                    begin();
+            }
+            const uint64_t generation = entry->generation.fetch_add(1) + 1;
+            // One extra tick because the current one is already partly elapsed
+            entry->deadline.store(current_tick.load() + entry->interval + 1);
+            schedule({entry, generation});
+        }
+
+        void begin() {
+            if (running)
+                return;
+
+            running = true;
+            current_tick.store(now_tick());
+            wait();
+        }
+
+        void stop() {
+            running = false;
+            timer.cancel();
+            clear_slots();
+        }
+
+        void clear_slots() {
+            for (std::vector<slot_item_t> &slot : near_slots)
+                slot.clear();
+            for (std::array<std::vector<slot_item_t>, 1 << far_bits> &level : far_slots) {
+                for (std::vector<slot_item_t> &slot : level)
+                    slot.clear();
+            }
+        }
+
+        void wait() {
+            timer.expires_at(origin + resolution * (current_tick.load() + 1));
+            timer.async_wait([this](const asio::error_code &ec) {
+                if (ec == asio::error::operation_aborted)
+                    return;
+
+                advance();
+            });
+        }
+
+        // Place an item in the lowest level whose span still covers its deadline.
+        // Deadlines beyond the last level are parked in its furthest slot and cascaded again later.
+        void schedule(slot_item_t item) {
+            const uint64_t now = current_tick.load();
+            const uint64_t deadline = std::max(item.entry->deadline.load(), now + 1);
+            if (deadline - now < near_slots.size()) {
+                near_slots[deadline & (near_slots.size() - 1)].push_back(std::move(item));
+                return;
+            }
+
+            for (size_t level = 0; level < far_levels; ++level) {
+                const size_t shift = near_bits + far_bits * level;
+                if ((deadline >> shift) - (now >> shift) < (1u << far_bits)) {
+                    far_slots[level][(deadline >> shift) & ((1u << far_bits) - 1)].push_back(std::move(item));
+                    return;
+                }
+            }
+
+            const size_t shift = near_bits + far_bits * (far_levels - 1);
+            far_slots[far_levels - 1][((now >> shift) + (1u << far_bits) - 1) & ((1u << far_bits) - 1)].push_back(std::move(item));
+        }
+
+        void advance() {
+            std::lock_guard guard(mutex_wheel);
+            if (!running)
+                return;
+
+            const uint64_t target = now_tick();
+            while (current_tick.load() < target && active > 0) {
+                const uint64_t now = current_tick.fetch_add(1) + 1;
+                for (size_t level = far_levels; level-- > 0;) {
+                    const size_t shift = near_bits + far_bits * level;
+                    if ((now & ((static_cast<uint64_t>(1) << shift) - 1)) == 0)
+                        expire(far_slots[level][(now >> shift) & ((1u << far_bits) - 1)], now);
+                }
+                expire(near_slots[now & (near_slots.size() - 1)], now);
+            }
+
+            if (active > 0)
+                wait();
+            else
+                stop();
+        }
+
+        // Fire due items of 'slot', drop cancelled ones and move refreshed ones closer.
+        void expire(std::vector<slot_item_t> &slot, const uint64_t now) {
+            scratch.swap(slot);
+            for (slot_item_t &item : scratch) {
+                const std::shared_ptr<entry_t> &entry = item.entry;
+                if (entry->generation.load() != item.generation || !entry->armed.load())
+                    continue;
+
+                if (entry->deadline.load() > now) {
+                    schedule(std::move(item));
+                    continue;
+                }
+
+                entry->armed.store(false, std::memory_order_release);
+                --active;
+                asio::post(entry->executor, [this, entry, generation = item.generation, callback = entry->callback]() {
+                    fire(entry, generation, callback);
+                });
+            }
+            scratch.clear();
+            if (slot.empty())
+                slot.swap(scratch);
+        }
+
+        // Runs on the executor of the entry. A refresh that raced with the expiry re-arms the timer instead.
+        void fire(const std::shared_ptr<entry_t> &entry, const uint64_t generation, const std::function<void()> &callback) {
+            {
+                std::lock_guard guard(mutex_wheel);
+                if (entry->generation.load() != generation)
+                    return;
+
+                if (entry->deadline.load() > current_tick.load()) {
+                    arm(entry);
+                    return;
+                }
+            }
+            if (callback)
+                callback();
+        }
+    };
+
+    /**
+     * One-shot timer of a timer_wheel_c. Handlers run on the executor given at construction, usually the connection strand.
+     */
+    class wheel_timer_c {
+    public:
+        wheel_timer_c(asio::io_context &io_context, const asio::any_io_executor &executor)
+            : wheel(asio::use_service<timer_wheel_c>(io_context)),
+              entry(std::make_shared<timer_wheel_c::entry_t>(executor)) {
+        }
+
+        wheel_timer_c(const wheel_timer_c &) = delete;
+        wheel_timer_c &operator=(const wheel_timer_c &) = delete;
+
+        ~wheel_timer_c() {
+            cancel();
+        }
+
+        /**
+         * Arm the timer, replacing any pending expiry. 'callback' runs once after 'timeout' unless the timer is refreshed or cancelled.
+         *
+         * @par Example
+         * @code
+         * wheel_timer_c timer(io_context, socket.get_executor());
+         * timer.start(std::chrono::seconds(5), [&]() {
+         *      // your code...
+         * });
+         * @endcode
+         */
+        void start(const std::chrono::steady_clock::duration timeout, std::function<void()> callback) {
+            wheel.start(entry, timeout, std::move(callback));
+        }
+
+        /**
+         * Push the expiry one full timeout forward. Re-arms a timer that already expired with its last timeout and callback,
+         * but not one that was cancelled.
+         *
+         * @par Example
+         * @code
+         * wheel_timer_c timer(io_context, socket.get_executor());
+         * timer.refresh();
+         * @endcode
+         */
+        void refresh() {
+            wheel.refresh(entry);
+        }
+
+        /**
+         * Cancel the timer. A callback already queued for execution will not run, and only 'start()' arms it again.
+         *
+         * @par Example
+         * @code
+         * wheel_timer_c timer(io_context, socket.get_executor());
+         * timer.cancel();
+         * @endcode
+         */
+        void cancel() {
+            wheel.cancel(entry);
+        }
+
+        /**
+         * Return true if the timer is waiting to expire.
+         *
+         * @par Example
+         * @code
+         * wheel_timer_c timer(io_context, socket.get_executor());
+         * bool is_armed = timer.is_armed();
+         * @endcode
+         */
+        bool is_armed() const { return entry->armed.load(); }
+
+    private:
+        timer_wheel_c &wheel;
+        std::shared_ptr<timer_wheel_c::entry_t> entry;
+    };
+}
@@ -12,8 +12,40 @@ namespace internetprotocol {
     public:
         tcp_client_c() {}
 
+        /**
+         * Construct the client on a shared io_context instead of a private one.
+         * No runtime thread is reserved for this client, the owner of 'io_context' is responsible
+         * for running it, so many clients can be multiplexed over a few threads. Handlers of the
+         * client are serialized on its own strand.
+         * Keep the client alive until 'io_context' has run the handlers cancelled by 'close()'.
+         *
+         * @param io_context Shared io_context used by the socket, resolver and timers.
+         *
+         * @par Example
+         * @code
+         * asio::io_context io_context;
+         * tcp_client_c client(io_context);
+         * client.connect({"localhost", "8080", v4});
+         * io_context.run();
+         * @endcode
+         */
+        explicit tcp_client_c(asio::io_context &io_context): net(io_context) {}
+
+        /**
+         * Construct the client on the io_context of a runtime, see the io_context constructor.
+         *
+         * @param runtime Runtime whose threads run the client handlers. Must outlive the client.
+         *
+         * @par Example
+         * @code
+         * runtime_c runtime({ 2, "client" });
+         * tcp_client_c client(runtime);
+         * @endcode
+         */
+        explicit tcp_client_c(runtime_c &runtime): tcp_client_c(runtime.context()) {}
+
         ~tcp_client_c() {
-            if (net.socket.is_open())
+            if (net.socket.is_open() || reconnecting.load())
                 close();
             consume_recv_buffer();
         }
@@ -29,6 +61,18 @@ namespace internetprotocol {
          */
         bool is_open() const { return net.socket.is_open(); }
 
+        /**
+         * Return true while the client waits to reconnect or is reconnecting, see 'reconnect_policy_t'.
+         * Writes issued meanwhile are held and sent once the connection is back.
+         *
+         * @par Example
+         * @code
+         * tcp_client_c client;
+         * bool is_reconnecting = client.is_reconnecting();
+         * @endcode
+         */
+        bool is_reconnecting() const { return reconnecting.load(); }
+
         /**
          * Get the local endpoint of the socket. Use this function only after open connection.
          *
@@ -66,6 +110,7 @@ namespace internetprotocol {
         /**
          * Sends string data on the socket.
          * It returns false if socket is closed or if buffer is empty.
+         * While reconnecting the message is held for the next connection, and false is returned if the hold is full.
          *
          * @param message String to be send.
          *
@@ -81,20 +126,21 @@ namespace internetprotocol {
          * @endcode
          */
         bool write(const std::string &message, const std::function<void(const asio::error_code &, const size_t)> &callback = nullptr) {
-            if (!net.socket.is_open() || message.empty())
+            if (message.empty())
+                return false;
+            if (reconnecting.load())
+                return hold_write(reinterpret_cast<const uint8_t *>(message.data()), message.size(), callback);
+            if (!net.socket.is_open())
                 return false;
 
-            asio::async_write(net.socket,
-                                asio::buffer(message.c_str(), message.size()),
-                                [&, callback](const asio::error_code &ec, const size_t bytes_sent) {
-                                    if (callback) callback(ec, bytes_sent);
-                                });
+            send_queue.push(message.data(), message.size(), callback);
             return true;
         }
 
         /**
          * Sends buffer data on the socket.
          * It returns false if socket is closed or if buffer is empty.
+         * While reconnecting the buffer is held for the next connection, and false is returned if the hold is full.
          *
          * @param buffer String to be send.
          *
@@ -110,17 +156,223 @@ namespace internetprotocol {
          * @endcode
          */
         bool write_buffer(const std::vector<uint8_t> &buffer, const std::function<void(const asio::error_code &, const size_t)> &callback = nullptr) {
-            if (!net.socket.is_open() || buffer.empty())
+            if (buffer.empty())
+                return false;
+            if (reconnecting.load())
+                return hold_write(buffer.data(), buffer.size(), callback);
+            if (!net.socket.is_open())
                 return false;
 
-            asio::async_write(net.socket,
-                                asio::buffer(buffer.data(), buffer.size()),
-                                [&, callback](const asio::error_code &ec, const size_t bytes_sent) {
-                                    if (callback) callback(ec, bytes_sent);
-                                });
+            send_queue.push(buffer.data(), buffer.size(), callback);
             return true;
         }
 
+        /**
+         * Sends string data on the socket as one message of the configured framing.
+         * The length prefix or delimiter is added for you. It returns false if socket is closed, if message is empty
+         * or if it does not fit the framing.
+         *
+         * @param message String to be send.
+         *
+         * @param callback An optional callback function may be specified to as a way of reporting DNS errors or for determining when it is safe to reuse the buf object.
+         *
+         * @par Example
+         * @code
+         * tcp_client_c client;
+         *
+         * std::string message = "...";
+         * client.write_frame(message);
+         * @endcode
+         */
+        bool write_frame(const std::string &message, const std::function<void(const asio::error_code &, const size_t)> &callback = nullptr) {
+            if ((!net.socket.is_open() && !reconnecting.load()) || message.empty())
+                return false;
+
+            return push_frame(reinterpret_cast<const uint8_t *>(message.data()), message.size(), callback);
+        }
+
+        /**
+         * Sends buffer data on the socket as one message of the configured framing.
+         * The length prefix or delimiter is added for you. It returns false if socket is closed, if buffer is empty
+         * or if it does not fit the framing.
+         *
+         * @param buffer Buffer to be send.
+         *
+         * @param callback An optional callback function may be specified to as a way of reporting DNS errors or for determining when it is safe to reuse the buf object.
+         *
+         * @par Example
+         * @code
+         * tcp_client_c client;
+         *
+         * std::vector<uint8_t> buffer = { 0, 1, 2, ... };
+         * client.write_frame_buffer(buffer);
+         * @endcode
+         */
+        bool write_frame_buffer(const std::vector<uint8_t> &buffer, const std::function<void(const asio::error_code &, const size_t)> &callback = nullptr) {
+            if ((!net.socket.is_open() && !reconnecting.load()) || buffer.empty())
+                return false;
+
+            return push_frame(buffer.data(), buffer.size(), callback);
+        }
+
+#ifndef _WIN32
+        /**
+         * Sends part of a file on the socket, after the data already written.
+         * On Linux plain sockets the bytes go from the page cache to the socket with sendfile(2) and never enter user space.
+         * TLS connections, and other platforms, read the file in chunks.
+         * It returns false if socket is closed or if the file cannot be opened.
+         *
+         * @param path Path of the file to be send.
+         *
+         * @param offset First byte of the file to send.
+         *
+         * @param length Number of bytes to send. 0 sends up to the end of the file.
+         *
+         * @param callback An optional callback function reporting errors and the number of file bytes sent.
+         *
+         * @par Example
+         * @code
+         * tcp_client_c client;
+         * client.send_file("artifact.tar.gz");
+         * @endcode
+         */
+        bool send_file(const std::string &path, const uint64_t offset = 0, const uint64_t length = 0,
+                       const std::function<void(const asio::error_code &, const size_t)> &callback = nullptr) {
+            if (!net.socket.is_open())
+                return false;
+
+            return send_queue.push_file(path, offset, length, callback);
+        }
+
+        /**
+         * Sends part of an open file on the socket, after the data already written. See 'send_file(path, ...)'.
+         * The descriptor is not closed and must stay open until the callback has been called.
+         *
+         * @param fd Open file descriptor.
+         *
+         * @param offset First byte of the file to send.
+         *
+         * @param length Number of bytes to send. 0 sends up to the end of the file.
+         *
+         * @param callback An optional callback function reporting errors and the number of file bytes sent.
+         *
+         * @par Example
+         * @code
+         * tcp_client_c client;
+         * int fd = open("artifact.tar.gz", O_RDONLY);
+         * client.send_file(fd, 0, 0, [fd](const asio::error_code &ec, const size_t bytes_sent) {
+         *      close(fd);
+         * });
+         * @endcode
+         */
+        bool send_file(const int fd, const uint64_t offset = 0, const uint64_t length = 0,
+                       const std::function<void(const asio::error_code &, const size_t)> &callback = nullptr) {
+            if (!net.socket.is_open())
+                return false;
+
+            return send_queue.push_file(fd, offset, length, callback);
+        }
+#endif
+
+#ifdef ASIO_HAS_CO_AWAIT
+        /**
+         * Return the strand executor of the socket. Coroutines using the awaitable functions must run on it.
+         *
+         * @par Example
+         * @code
+         * asio::co_spawn(client.get_executor(), session(client), asio::detached);
+         * client.connect({"localhost", "8080", v4});
+         * @endcode
+         */
+        asio::any_io_executor get_executor() { return net.socket.get_executor(); }
+
+        /**
+         * Awaitable version of 'write()'. The message is owned by the coroutine frame until it has been sent.
+         *
+         * @param message String to be send.
+         *
+         * @return A tuple with the error code and the number of bytes sent.
+         *
+         * @par Example
+         * @code
+         * tcp_client_c client;
+         *
+         * auto [ec, bytes_sent] = co_await client.async_write("...");
+         * @endcode
+         */
+        asio::awaitable<std::tuple<asio::error_code, size_t>> async_write(const std::string message) {
+            if (!is_open())
+                co_return std::make_tuple(asio::error_code(asio::error::not_connected), size_t(0));
+
+            co_return co_await send_queue.async_push(message.data(), message.size());
+        }
+
+        /**
+         * Awaitable version of 'write_buffer()'. The buffer is owned by the coroutine frame until it has been sent.
+         *
+         * @param buffer Buffer to be send.
+         *
+         * @return A tuple with the error code and the number of bytes sent.
+         *
+         * @par Example
+         * @code
+         * tcp_client_c client;
+         *
+         * std::vector<uint8_t> buffer = { 0, 1, 2, ... };
+         * auto [ec, bytes_sent] = co_await client.async_write_buffer(buffer);
+         * @endcode
+         */
+        asio::awaitable<std::tuple<asio::error_code, size_t>> async_write_buffer(const std::vector<uint8_t> buffer) {
+            if (!is_open())
+                co_return std::make_tuple(asio::error_code(asio::error::not_connected), size_t(0));
+
+            co_return co_await send_queue.async_push(buffer.data(), buffer.size());
+        }
+
+        /**
+         * Wait for the next message received on the socket.
+         * After the first call, received messages are queued for 'async_read()' instead of being passed to 'on_message_received'.
+         *
+         * @return A tuple with the error code and the message. The error code is set when the connection
+         * has failed or ended and no queued message is left.
+         *
+         * @par Example
+         * @code
+         * tcp_client_c client;
+         *
+         * auto [ec, message] = co_await client.async_read();
+         * @endcode
+         */
+        asio::awaitable<std::tuple<asio::error_code, std::vector<uint8_t>>> async_read() {
+            awaiting_reads = true;
+            while (read_queue.empty() && !read_error) {
+                asio::error_code ec;
+                read_signal.expires_at(asio::steady_timer::time_point::max());
+                co_await read_signal.async_wait(asio::redirect_error(asio::use_awaitable, ec));
+            }
+            if (read_queue.empty())
+                co_return std::make_tuple(read_error, std::vector<uint8_t>());
+
+            std::vector<uint8_t> message = std::move(read_queue.front());
+            read_queue.pop_front();
+            co_return std::make_tuple(asio::error_code(), std::move(message));
+        }
+#endif
+
+        /**
+         * Set/Get how the byte stream is split into messages. Applied on the next 'connect()'.
+         * With a framing other than RAW, each complete message is passed to 'on_frame' or 'on_message_received',
+         * and 'write_frame()' adds the length prefix or delimiter. 'on_data' is not called.
+         *
+         * @par Example
+         * @code
+         * tcp_client_c client;
+         * client.framing.type = LENGTH_PREFIXED;
+         * client.framing.length_size = 2;
+         * @endcode
+         */
+        framing_t framing;
+
         /**
          * Initiate a connection on a given socket.
          * It returns false if socket is already open or if asio return any error code during the listening.
@@ -139,13 +391,25 @@ namespace internetprotocol {
             if (net.socket.is_open())
                 return false;
 
-            net.resolver.async_resolve(bind_opts.protocol == v4 ? tcp::v4() : tcp::v6(),
-                                        bind_opts.address, bind_opts.port,
-                                        [&](const asio::error_code &ec, const tcp::resolver::results_type &results) {
-                                            resolve(ec, results);
-                                        });
-
-            asio::post(thread_pool, [&]{ run_context_thread(); });
+            bind_options = bind_opts;
+            endpoints = tcp::resolver::results_type();
+            reconnect_attempt = 0;
+            reading_paused.store(false);
+            read_parked = false;
+            parked_work.reset();
+            codec = frame_codec_c(framing);
+#ifdef ASIO_HAS_CO_AWAIT
+            read_queue.clear();
+            read_error.clear();
+#endif
+            resolver_cache().async_resolve(net.resolver, resolve_protocol(bind_opts.protocol),
+                                            bind_opts.address, bind_opts.port,
+                                            [&](const asio::error_code &ec, const tcp::resolver::results_type &results) {
+                                                resolve(ec, results);
+                                            }, bind_opts.use_resolver_cache);
+
+            if (net.owned_context)
+                asio::post(default_runtime().get_executor(), [&]{ run_context_thread(); });
             return true;
         }
 
@@ -160,6 +424,9 @@ namespace internetprotocol {
          */
         void close() {
             is_closing.store(true);
+            connector.cancel();
+            reconnect_timer.cancel();
+            drop_held_writes(asio::error::operation_aborted);
             if (net.socket.is_open()) {
                 std::lock_guard guard(mutex_error);
                 net.socket.shutdown(tcp::socket::shutdown_both, error_code);
@@ -169,14 +436,117 @@ namespace internetprotocol {
                 if (error_code && on_error)
                     on_error(error_code);
             }
-            net.context.stop();
-            net.context.restart();
+            if (net.owned_context) {
+                net.context.stop();
+                net.context.restart();
+            }
             net.endpoint = tcp::endpoint();
             if (on_close)
                 on_close();
             is_closing.store(false);
         }
 
+        /**
+         * Set the send queue watermarks in bytes. 'on_backpressure' is triggered when the bytes waiting to be sent
+         * reach 'high', and 'on_drain' once they fall back to 'low' or below. A 'high' of 0 disables them.
+         *
+         * @param high Queued bytes at which the peer is considered to be falling behind.
+         *
+         * @param low Queued bytes at which writing may resume.
+         *
+         * @par Example
+         * @code
+         * tcp_client_c client;
+         * client.set_watermarks(1024 * 1024, 256 * 1024);
+         * @endcode
+         */
+        void set_watermarks(const size_t high, const size_t low) {
+            send_queue.set_watermarks(high, low,
+                                      [&]() {
+                                          if (on_backpressure)
+                                              on_backpressure();
+                                      },
+                                      [&]() {
+                                          if (on_drain)
+                                              on_drain();
+                                      });
+        }
+
+        /**
+         * Return the number of bytes written and not sent yet.
+         *
+         * @par Example
+         * @code
+         * tcp_client_c client;
+         * size_t queued = client.get_queued_bytes();
+         * @endcode
+         */
+        size_t get_queued_bytes() { return send_queue.queued_bytes(); }
+
+        /**
+         * Send messages of at least 'threshold' bytes with MSG_ZEROCOPY (Linux only).
+         * Their callback runs once the kernel has released the buffer, not when the data was queued to the socket.
+         * It is kept in 'bind_options.socket_options' and applied again on every connection.
+         * Returns false if the system does not support it. A 'threshold' of 0 disables it.
+         *
+         * @par Example
+         * @code
+         * tcp_client_c client;
+         * client.set_zerocopy_threshold(64 * 1024);
+         * @endcode
+         */
+        bool set_zerocopy_threshold(const size_t threshold) {
+            bind_options.socket_options.zerocopy_threshold = threshold;
+            if (!net.socket.is_open())
+                return threshold == 0 || send_queue_c<tcp::socket>::supports_zerocopy;
+            return send_queue.set_zerocopy_threshold(threshold);
+        }
+
+        /**
+         * Stop reading from the socket. The read already in progress still completes,
+         * after that nothing more is received until 'resume_reading()' is called.
+         *
+         * @par Example
+         * @code
+         * tcp_client_c client;
+         * client.pause_reading();
+         * @endcode
+         */
+        void pause_reading() { reading_paused.store(true); }
+
+        /**
+         * Start reading from the socket again after 'pause_reading()'.
+         *
+         * @par Example
+         * @code
+         * tcp_client_c client;
+         * client.resume_reading();
+         * @endcode
+         */
+        void resume_reading() {
+            reading_paused.store(false);
+            asio::post(net.socket.get_executor(), [&]() {
+                if (!read_parked)
+                    return;
+
+                read_parked = false;
+                parked_work.reset();
+                if (net.socket.is_open())
+                    read_next();
+            });
+        }
+
+        /**
+         * Return true if reading has been paused with 'pause_reading()'.
+         *
+         * @par Example
+         * @code
+         * tcp_client_c client;
+         * bool paused = client.is_reading_paused();
+         * @endcode
+         */
+        bool is_reading_paused() const { return reading_paused.load(); }
+
         /**
          * Adds the listener function to 'on_connected'.
          * This event will be triggered when socket start to listening.
@@ -205,6 +575,69 @@ namespace internetprotocol {
          */
         std::function<void(const std::vector<uint8_t> &, const size_t)> on_message_received;
 
+        /**
+         * Adds the listener function to 'on_data'. When set, it is called instead of 'on_message_received'.
+         * It is not called when 'framing' is set to anything other than RAW, see 'on_frame'.
+         * It receives a read-only view of the receive buffer, without copying it, and returns how many bytes it consumed.
+         * Bytes left unconsumed stay buffered and are passed again, followed by the new data, on the next read.
+         * The view is only valid during the call.
+         *
+         * @par Example
+         * @code
+         * tcp_client_c client;
+         * client.on_data = [&](const uint8_t *data, const size_t size) -> size_t {
+         *      // your code...
+         *      return size;
+         * };
+         * @endcode
+         */
+        std::function<size_t(const uint8_t *, const size_t)> on_data;
+
+        /**
+         * Adds the listener function to 'on_frame'.
+         * When framing is enabled, this event is triggered once per complete message with a read-only view of it
+         * inside the receive buffer, without copying it. The view is only valid during the call.
+         * If it is not set, each message is copied and passed to 'on_message_received' instead.
+         *
+         * @par Example
+         * @code
+         * tcp_client_c client;
+         * client.on_frame = [&](const uint8_t *data, const size_t size) {
+         *      // your code...
+         * };
+         * @endcode
+         */
+        std::function<void(const uint8_t *, const size_t)> on_frame;
+
+        /**
+         * Adds the listener function to 'on_backpressure'.
+         * This event will be triggered when the bytes waiting to be sent reach the high watermark, see 'set_watermarks()'.
+         * It runs on the thread that wrote the message.
+         *
+         * @par Example
+         * @code
+         * tcp_client_c client;
+         * client.on_backpressure = [&]() {
+         *      // stop writing until 'on_drain'...
+         * };
+         * @endcode
+         */
+        std::function<void()> on_backpressure;
+
+        /**
+         * Adds the listener function to 'on_drain'.
+         * This event will be triggered when the bytes waiting to be sent fall back to the low watermark after 'on_backpressure'.
+         *
+         * @par Example
+         * @code
+         * tcp_client_c client;
+         * client.on_drain = [&]() {
+         *      // your code...
+         * };
+         * @endcode
+         */
+        std::function<void()> on_drain;
+
         /**
          * Adds the listener function to 'on_close'.
          * This event will be triggered when socket is closed.
@@ -219,6 +652,21 @@ namespace internetprotocol {
          */
         std::function<void()> on_close;
 
+        /**
+         * Adds the listener function to 'on_reconnecting'.
+         * It is triggered when the connection dropped or an attempt failed and the next attempt has been scheduled,
+         * with the attempt number, starting at 1, and the delay before it in milliseconds.
+         *
+         * @par Example
+         * @code
+         * tcp_client_c client;
+         * client.on_reconnecting = [&](const uint32_t attempt, const uint32_t delay_ms) {
+         *      std::cout << "reconnect attempt " << attempt << " in " << delay_ms << "ms" << std::endl;
+         * };
+         * @endcode
+         */
+        std::function<void(const uint32_t, const uint32_t)> on_reconnecting;
+
         /**
          * Adds the listener function to 'on_error'.
          * This event will be triggered when any error has been returned by asio.
@@ -238,53 +686,269 @@ namespace internetprotocol {
         std::mutex mutex_error;
         std::atomic<bool> is_closing = false;
         tcp_client_t net;
+        tcp_connector_c connector;
+        send_queue_c<tcp::socket> send_queue{net.socket};
         asio::error_code error_code;
-        asio::streambuf recv_buffer;
+        client_bind_options_t bind_options;
+        frame_codec_c codec;
+        std::atomic<bool> reading_paused = false;
+        bool read_parked = false;
+        std::optional<asio::executor_work_guard<asio::io_context::executor_type>> parked_work;
+        pooled_streambuf_c recv_buffer{buffer_pool_c::get(net.socket.get_executor())};
+        // Reconnect state. The resolved endpoints are kept so reconnecting does not resolve again
+        tcp::resolver::results_type endpoints;
+        asio::steady_timer reconnect_timer{net.socket.get_executor()};
+        std::atomic<bool> reconnecting = false;
+        uint32_t reconnect_attempt = 0;
+        std::minstd_rand reconnect_rng{std::random_device{}()};
+        // Writes issued while reconnecting, sent once connected again
+        std::mutex mutex_held;
+        std::deque<std::pair<std::vector<uint8_t>, std::function<void(const asio::error_code &, const size_t)>>> held_writes;
+        size_t held_bytes = 0;
+#ifdef ASIO_HAS_CO_AWAIT
+        bool awaiting_reads = false;
+        asio::steady_timer read_signal{net.socket.get_executor()};
+        std::deque<std::vector<uint8_t>> read_queue;
+        asio::error_code read_error;
+
+        void wake_readers(const asio::error_code &error) {
+            read_error = error;
+            read_signal.cancel();
+        }
+#endif
 
         void run_context_thread() {
             std::lock_guard guard(mutex_io);
             error_code.clear();
-            net.context.run();
+            run_context(net.context, bind_options.busy_poll_us);
             if (!is_closing.load())
                 close();
         }
 
+        void close_after_error(const asio::error_code &error) {
+#ifdef ASIO_HAS_CO_AWAIT
+            wake_readers(error);
+#endif
+            if (error != asio::error::operation_aborted && !is_closing.load() && schedule_reconnect())
+                return;
+            // Private io_contexts are closed by run_context_thread once they run out of work
+            if (!net.owned_context && error != asio::error::operation_aborted && !is_closing.load())
+                close();
+        }
+
         void resolve(const asio::error_code &error, const tcp::resolver::results_type &results) {
             if (error) {
-                std::lock_guard guard(mutex_error);
-                error_code = error;
-                if (on_error)
-                    on_error(error_code);
+                {
+                    std::lock_guard guard(mutex_error);
+                    error_code = error;
+                    if (on_error)
+                        on_error(error_code);
+                }
+                close_after_error(error);
                 return;
             }
 
+            endpoints = results;
             net.endpoint = results.begin()->endpoint();
-            asio::async_connect(net.socket,
-                                results,
-                                [&](const asio::error_code &ec, const tcp::endpoint &ep) {
-                                    conn(ec); 
-                                });
+            connector.async_connect(net.socket, results, std::chrono::milliseconds(bind_options.connect_attempt_delay_ms),
+                                    [&](const asio::error_code &ec, const tcp::endpoint &ep) {
+                                        conn(ec);
+                                    });
         }
 
         void conn(const asio::error_code &error) {
             if (error) {
-                std::lock_guard guard(mutex_error);
-                error_code = error;
-                if (on_error)
-                    on_error(error_code);
+                {
+                    std::lock_guard guard(mutex_error);
+                    error_code = error;
+                    if (on_error)
+                        on_error(error_code);
+                }
+                close_after_error(error);
                 return;
             }
 
+            set_busy_poll(net.socket, bind_options.so_busy_poll_us);
+            set_socket_options(net.socket, bind_options.socket_options);
+            send_queue.set_zerocopy_threshold(bind_options.socket_options.zerocopy_threshold);
+            reconnect_attempt = 0;
+            release_held_writes();
+
             if (on_connected)
                 on_connected();
             
             consume_recv_buffer();
-            asio::async_read(net.socket,
-                                recv_buffer, 
-                                asio::transfer_at_least(1),
-                                [&](const asio::error_code &ec, const size_t bytes_recvd) {
-                                    read_cb(ec, bytes_recvd);
-                                });
+            async_read_pooled(net.socket, recv_buffer,
+                              [&](const asio::error_code &ec, const size_t bytes_recvd) {
+                                  read_cb(ec, bytes_recvd);
+                              });
+        }
+
+        bool push_frame(const uint8_t *data, const size_t size, const std::function<void(const asio::error_code &, const size_t)> &callback) {
+            std::vector<uint8_t> frame = send_queue.acquire(codec.overhead() + size);
+            if (!codec.encode(data, size, frame))
+                return false;
+
+            if (reconnecting.load())
+                return hold_write(std::move(frame), callback);
+            send_queue.push(std::move(frame), callback);
+            return true;
+        }
+
+        bool hold_write(const uint8_t *data, const size_t size, const std::function<void(const asio::error_code &, const size_t)> &callback) {
+            std::vector<uint8_t> block = send_queue.acquire(size);
+            block.assign(data, data + size);
+            return hold_write(std::move(block), callback);
+        }
+
+        // Keep 'block' until the connection is back. Returns false if the hold is full
+        bool hold_write(std::vector<uint8_t> &&block, const std::function<void(const asio::error_code &, const size_t)> &callback) {
+            std::lock_guard guard(mutex_held);
+            // The connection came back since the caller checked
+            if (!reconnecting.load()) {
+                if (!net.socket.is_open())
+                    return false;
+                send_queue.push(std::move(block), callback);
+                return true;
+            }
+            if (held_bytes + block.size() > bind_options.reconnect.max_queued_bytes)
+                return false;
+
+            held_bytes += block.size();
+            held_writes.emplace_back(std::move(block), callback);
+            return true;
+        }
+
+        // Move the held writes to the send queue, ahead of any write issued from now on
+        void release_held_writes() {
+            std::lock_guard guard(mutex_held);
+            for (auto &held : held_writes)
+                send_queue.push(std::move(held.first), std::move(held.second));
+            held_writes.clear();
+            held_bytes = 0;
+            reconnecting.store(false);
+        }
+
+        void drop_held_writes(const asio::error_code &error) {
+            std::deque<std::pair<std::vector<uint8_t>, std::function<void(const asio::error_code &, const size_t)>>> dropped;
+            {
+                std::lock_guard guard(mutex_held);
+                dropped.swap(held_writes);
+                held_bytes = 0;
+                reconnecting.store(false);
+            }
+            for (auto &held : dropped) {
+                if (held.second)
+                    held.second(error, 0);
+            }
+        }
+
+        // Delay before attempt number 'attempt', counting from 0
+        uint32_t reconnect_delay(const uint32_t attempt) {
+            const reconnect_policy_t &policy = bind_options.reconnect;
+            const double growth = std::pow(std::max(policy.multiplier, 1.0), std::min<uint32_t>(attempt, 64));
+            const double delay = std::min(policy.initial_delay_ms * growth, static_cast<double>(policy.max_delay_ms));
+            const double jitter = std::clamp(policy.jitter, 0.0, 1.0);
+            std::uniform_real_distribution<double> spread(1.0 - jitter, 1.0);
+            return static_cast<uint32_t>(delay * spread(reconnect_rng));
+        }
+
+        // Close the dropped connection and arm the next attempt. Returns false if the policy does not allow one
+        bool schedule_reconnect() {
+            const reconnect_policy_t &policy = bind_options.reconnect;
+            if (!policy.enabled || (policy.max_attempts > 0 && reconnect_attempt >= policy.max_attempts))
+                return false;
+
+            {
+                std::lock_guard guard(mutex_held);
+                reconnecting.store(true);
+            }
+            asio::error_code ec;
+            net.socket.close(ec);
+            read_parked = false;
+            parked_work.reset();
+
+            const uint32_t delay_ms = reconnect_delay(reconnect_attempt++);
+            if (on_reconnecting)
+                on_reconnecting(reconnect_attempt, delay_ms);
+
+            reconnect_timer.expires_after(std::chrono::milliseconds(delay_ms));
+            reconnect_timer.async_wait([&](const asio::error_code &ec) {
+                // close() cancels the timer and clears 'reconnecting', a wait already completed sees the latter
+                if (ec || is_closing.load() || !reconnecting.load())
+                    return;
+                reconnect();
+            });
+            return true;
+        }
+
+        void reconnect() {
+            codec = frame_codec_c(framing);
+            consume_recv_buffer();
+            if (endpoints.empty()) {
+                resolver_cache().async_resolve(net.resolver, resolve_protocol(bind_options.protocol),
+                                               bind_options.address, bind_options.port,
+                                               [&](const asio::error_code &ec, const tcp::resolver::results_type &results) {
+                                                   resolve(ec, results);
+                                               }, bind_options.use_resolver_cache);
+                return;
+            }
+            connector.async_connect(net.socket, endpoints, std::chrono::milliseconds(bind_options.connect_attempt_delay_ms),
+                                    [&](const asio::error_code &ec, const tcp::endpoint &) {
+                                        conn(ec);
+                                    });
+        }
+
+        void dispatch_frame(const uint8_t *data, const size_t size) {
+#ifdef ASIO_HAS_CO_AWAIT
+            if (awaiting_reads) {
+                read_queue.emplace_back(data, data + size);
+                read_signal.cancel();
+                return;
+            }
+#endif
+            if (on_frame) {
+                on_frame(data, size);
+                return;
+            }
+            if (on_message_received)
+                on_message_received(std::vector<uint8_t>(data, data + size), size);
+        }
+
+        // Deliver every complete message in the receive buffer. Returns false if the peer broke the framing.
+        bool read_frames() {
+            asio::error_code ec;
+            const size_t consumed = codec.decode(static_cast<const uint8_t *>(recv_buffer.data().data()), recv_buffer.size(),
+                                                 [&](const uint8_t *data, const size_t size) {
+                                                     dispatch_frame(data, size);
+                                                 }, ec);
+            recv_buffer.consume(consumed);
+            if (!ec)
+                return true;
+
+            {
+                std::lock_guard guard(mutex_error);
+                error_code = ec;
+                if (on_error)
+                    on_error(error_code);
+            }
+            close_after_error(ec);
+            return false;
+        }
+
+        // Re-arm the read unless reading is paused, in which case 'resume_reading()' does it
+        void read_next() {
+            if (reading_paused.load()) {
+                read_parked = true;
+                // A private io_context would otherwise run out of work and close the connection
+                if (net.owned_context)
+                    parked_work.emplace(net.context.get_executor());
+                return;
+            }
+            async_read_pooled(net.socket, recv_buffer,
+                              [&](const asio::error_code &ec, const size_t bytes_received) {
+                                  read_cb(ec, bytes_received);
+                              });
         }
 
         void consume_recv_buffer() {
@@ -295,28 +959,49 @@ namespace internetprotocol {
 
         void read_cb(const asio::error_code &error, const size_t bytes_recvd) {
             if (error) {
-                std::lock_guard guard(mutex_error);
-                error_code = error;
-                if (on_error)
-                    on_error(error_code);
+                {
+                    std::lock_guard guard(mutex_error);
+                    error_code = error;
+                    if (on_error)
+                        on_error(error_code);
+                }
+                close_after_error(error);
                 return;
             }
 
-            if (on_message_received) {
-                std::vector<uint8_t> buffer;
-                buffer.resize(bytes_recvd);
-                asio::buffer_copy(asio::buffer(buffer, bytes_recvd),
-                                    recv_buffer.data());
-                on_message_received(buffer, bytes_recvd);
+            if (!codec.is_raw()) {
+                if (read_frames())
+                    read_next();
+                return;
             }
-
-            consume_recv_buffer();
-            asio::async_read(net.socket,
-                                recv_buffer, 
-                                asio::transfer_at_least(1),
-                                [&](const asio::error_code &ec, const size_t bytes_received) {
-                                    read_cb(ec, bytes_received);
-                                });
+#ifdef ASIO_HAS_CO_AWAIT
+            if (awaiting_reads) {
+                std::vector<uint8_t> buf(bytes_recvd);
+                asio::buffer_copy(asio::buffer(buf, bytes_recvd),
+                                  recv_buffer.data());
+                read_queue.push_back(std::move(buf));
+                read_signal.cancel();
+                consume_recv_buffer();
+                read_next();
+                return;
+            }
+#endif
+            if (on_data) {
+                const size_t size = recv_buffer.size();
+                const size_t consumed = on_data(static_cast<const uint8_t *>(recv_buffer.data().data()), size);
+                // Bytes left unconsumed stay buffered and are passed again with the next read
+                recv_buffer.consume(std::min(consumed, size));
+            } else {
+                if (on_message_received) {
+                    std::vector<uint8_t> buffer;
+                    buffer.resize(bytes_recvd);
+                    asio::buffer_copy(asio::buffer(buffer, bytes_recvd),
+                                        recv_buffer.data());
+                    on_message_received(buffer, bytes_recvd);
+                }
+                consume_recv_buffer();
+            }
+            read_next();
         }
     };
 
@@ -324,156 +1009,347 @@ namespace internetprotocol {
     class tcp_client_ssl_c {
     public:
         tcp_client_ssl_c(const security_context_opts &sec_opts = {}) {
-            if (!sec_opts.private_key.empty()) {
-                const asio::const_buffer buffer(sec_opts.private_key.data(), sec_opts.private_key.size());
-                net.ssl_context.use_private_key(buffer, sec_opts.file_format);
-            }
+            init(sec_opts);
+        }
 
-            if (!sec_opts.cert.empty()) {
-                const asio::const_buffer buffer(sec_opts.cert.data(), sec_opts.cert.size());
-                net.ssl_context.use_certificate(buffer, sec_opts.file_format);
-            }
+        /**
+         * Construct the client on a shared io_context instead of a private one.
+         * No runtime thread is reserved for this client, the owner of 'io_context' is responsible
+         * for running it, so many clients can be multiplexed over a few threads. Handlers of the
+         * client are serialized on its own strand.
+         * Keep the client alive until 'io_context' has run the handlers cancelled by 'close()'.
+         *
+         * @param io_context Shared io_context used by the socket, resolver and timers.
+         *
+         * @par Example
+         * @code
+         * asio::io_context io_context;
+         * tcp_client_ssl_c client(io_context, {});
+         * client.connect({"localhost", "8080", v4});
+         * io_context.run();
+         * @endcode
+         */
+        tcp_client_ssl_c(asio::io_context &io_context, const security_context_opts &sec_opts = {}): net(io_context) {
+            init(sec_opts);
+        }
 
-            if (!sec_opts.cert_chain.empty()) {
-                const asio::const_buffer buffer(sec_opts.cert_chain.data(), sec_opts.cert_chain.size());
-                net.ssl_context.use_certificate_chain(buffer);
-            }
+        /**
+         * Construct the client on the io_context of a runtime, see the io_context constructor.
+         *
+         * @param runtime Runtime whose threads run the client handlers. Must outlive the client.
+         *
+         * @par Example
+         * @code
+         * runtime_c runtime({ 2, "client" });
+         * tcp_client_ssl_c client(runtime, {});
+         * @endcode
+         */
+        tcp_client_ssl_c(runtime_c &runtime, const security_context_opts &sec_opts = {}): tcp_client_ssl_c(runtime.context(), sec_opts) {}
+        ~tcp_client_ssl_c() {
+            if (net.ssl_socket.next_layer().is_open())
+                close();
+            consume_recv_buffer();
+        }
 
-            if (!sec_opts.rsa_private_key.empty()) {
-                const asio::const_buffer buffer(sec_opts.rsa_private_key.data(), sec_opts.rsa_private_key.size());
-                net.ssl_context.use_rsa_private_key(buffer, sec_opts.file_format);
-            }
+        /**
+         * Return true if socket is open.
+         *
+         * @par Example
+         * @code
+         * tcp_client_ssl_c client({});
+         * bool is_open = client.is_open();
+         * @endcode
+         */
+        bool is_open() const { return net.ssl_socket.next_layer().is_open(); }
 
-            if (!sec_opts.host_name_verification.empty()) {
-                net.ssl_context.set_verify_callback(asio::ssl::host_name_verification(sec_opts.host_name_verification));
-            }
+        /**
+         * Get the local endpoint of the socket. Use this function only after open connection.
+         *
+         * @par Example
+         * @code
+         * tcp_client_ssl_c client({});
+         * asio::ip::tcp::endpoint ep = client.local_endpoint();
+         * @endcode
+         */
+        tcp::endpoint local_endpoint() const { return net.ssl_socket.next_layer().local_endpoint(); }
 
-            switch (sec_opts.verify_mode) {
-                case none:
-                    net.ssl_context.set_verify_mode(asio::ssl::verify_none);
-                    break;
-                case verify_peer:
-                    net.ssl_context.set_verify_mode(asio::ssl::verify_peer);
-                    break;
-                case verify_fail_if_no_peer_cert:
-                    net.ssl_context.set_verify_mode(asio::ssl::verify_fail_if_no_peer_cert);
-                    break;
-                case verify_client_once:
-                    net.ssl_context.set_verify_mode(asio::ssl::verify_client_once);
-                    break;
-                default:
-                    break;
-            }
+        /**
+         * Get the remote endpoint of the socket. Use this function only after open connection.
+         *
+         * @par Example
+         * @code
+         * tcp_client_ssl_c client({});
+         * asio::ip::tcp::endpoint ep = client.remote_endpoint();
+         * @endcode
+         */
+        tcp::endpoint remote_endpoint() const { return net.ssl_socket.next_layer().remote_endpoint(); }
+
+        /**
+         * Return a const ref of the latest error code returned by asio.
+         *
+         * @par Example
+         * @code
+         * tcp_client_ssl_c client({});
+         * asio::error_code ec = client.get_error_code();
+         * @endcode
+         */
+        asio::error_code get_error_code() const { return error_code; }
+
+        /**
+         * Sends string data on the socket.
+         * It returns false if socket is closed or if buffer is empty.
+         *
+         * @param message String to be send.
+         *
+         * @param callback An optional callback function may be specified to as a way of reporting DNS errors or for determining when it is safe to reuse the buf object.
+         *
+         * @par Example
+         * @code
+         * tcp_client_ssl_c client({});
+         * client.connect("localhost", 8080, v4);
+         *
+         * std::string message = "...";
+         * client.write(message);
+         * @endcode
+         */
+        bool write(const std::string &message, const std::function<void(const asio::error_code &, const size_t)> &callback = nullptr) {
+            if (!net.ssl_socket.next_layer().is_open() || message.empty())
+                return false;
+
+            send_queue.push(message.data(), message.size(), callback);
+            return true;
+        }
+
+        /**
+         * Sends string data on the socket.
+         * It returns false if socket is closed or if buffer is empty.
+         *
+         * @param buffer String to be send.
+         *
+         * @param callback An optional callback function may be specified to as a way of reporting DNS errors or for determining when it is safe to reuse the buf object.
+         *
+         * @par Example
+         * @code
+         * tcp_client_ssl_c client({});
+         * client.connect("localhost", 8080, v4);
+         *
+         * std::vector<uint8_t> buffer = { 0, 1, 2, ... };
+         * client.write_buffer(buffer);
+         * @endcode
+         */
+        bool write_buffer(const std::vector<uint8_t> &buffer, const std::function<void(const asio::error_code &, const size_t)> &callback = nullptr) {
+            if (!net.ssl_socket.next_layer().is_open() || buffer.empty())
+                return false;
+
+            send_queue.push(buffer.data(), buffer.size(), callback);
+            return true;
+        }
+
+        /**
+         * Sends string data on the socket as one message of the configured framing.
+         * The length prefix or delimiter is added for you. It returns false if socket is closed, if message is empty
+         * or if it does not fit the framing.
+         *
+         * @param message String to be send.
+         *
+         * @param callback An optional callback function may be specified to as a way of reporting DNS errors or for determining when it is safe to reuse the buf object.
+         *
+         * @par Example
+         * @code
+         * tcp_client_ssl_c client;
+         *
+         * std::string message = "...";
+         * client.write_frame(message);
+         * @endcode
+         */
+        bool write_frame(const std::string &message, const std::function<void(const asio::error_code &, const size_t)> &callback = nullptr) {
+            if (!net.ssl_socket.next_layer().is_open() || message.empty())
+                return false;
 
-            net.ssl_socket = asio::ssl::stream<tcp::socket>(net.context, net.ssl_context);
-        }
-        ~tcp_client_ssl_c() {
-            if (net.ssl_socket.next_layer().is_open())
-                close();
-            consume_recv_buffer();
+            return push_frame(reinterpret_cast<const uint8_t *>(message.data()), message.size(), callback);
         }
 
         /**
-         * Return true if socket is open.
+         * Sends buffer data on the socket as one message of the configured framing.
+         * The length prefix or delimiter is added for you. It returns false if socket is closed, if buffer is empty
+         * or if it does not fit the framing.
+         *
+         * @param buffer Buffer to be send.
+         *
+         * @param callback An optional callback function may be specified to as a way of reporting DNS errors or for determining when it is safe to reuse the buf object.
          *
          * @par Example
          * @code
-         * tcp_client_ssl_c client({});
-         * bool is_open = client.is_open();
+         * tcp_client_ssl_c client;
+         *
+         * std::vector<uint8_t> buffer = { 0, 1, 2, ... };
+         * client.write_frame_buffer(buffer);
          * @endcode
          */
-        bool is_open() const { return net.ssl_socket.next_layer().is_open(); }
+        bool write_frame_buffer(const std::vector<uint8_t> &buffer, const std::function<void(const asio::error_code &, const size_t)> &callback = nullptr) {
+            if (!net.ssl_socket.next_layer().is_open() || buffer.empty())
+                return false;
+
+            return push_frame(buffer.data(), buffer.size(), callback);
+        }
 
+#ifndef _WIN32
         /**
-         * Get the local endpoint of the socket. Use this function only after open connection.
+         * Sends part of a file on the socket, after the data already written.
+         * On Linux plain sockets the bytes go from the page cache to the socket with sendfile(2) and never enter user space.
+         * TLS connections, and other platforms, read the file in chunks.
+         * It returns false if socket is closed or if the file cannot be opened.
+         *
+         * @param path Path of the file to be send.
+         *
+         * @param offset First byte of the file to send.
+         *
+         * @param length Number of bytes to send. 0 sends up to the end of the file.
+         *
+         * @param callback An optional callback function reporting errors and the number of file bytes sent.
          *
          * @par Example
          * @code
-         * tcp_client_ssl_c client({});
-         * asio::ip::tcp::endpoint ep = client.local_endpoint();
+         * tcp_client_ssl_c client;
+         * client.send_file("artifact.tar.gz");
          * @endcode
          */
-        tcp::endpoint local_endpoint() const { return net.ssl_socket.next_layer().local_endpoint(); }
+        bool send_file(const std::string &path, const uint64_t offset = 0, const uint64_t length = 0,
+                       const std::function<void(const asio::error_code &, const size_t)> &callback = nullptr) {
+            if (!net.ssl_socket.next_layer().is_open())
+                return false;
+
+            return send_queue.push_file(path, offset, length, callback);
+        }
 
         /**
-         * Get the remote endpoint of the socket. Use this function only after open connection.
+         * Sends part of an open file on the socket, after the data already written. See 'send_file(path, ...)'.
+         * The descriptor is not closed and must stay open until the callback has been called.
+         *
+         * @param fd Open file descriptor.
+         *
+         * @param offset First byte of the file to send.
+         *
+         * @param length Number of bytes to send. 0 sends up to the end of the file.
+         *
+         * @param callback An optional callback function reporting errors and the number of file bytes sent.
          *
          * @par Example
          * @code
-         * tcp_client_ssl_c client({});
-         * asio::ip::tcp::endpoint ep = client.remote_endpoint();
+         * tcp_client_ssl_c client;
+         * int fd = open("artifact.tar.gz", O_RDONLY);
+         * client.send_file(fd, 0, 0, [fd](const asio::error_code &ec, const size_t bytes_sent) {
+         *      close(fd);
+         * });
          * @endcode
          */
-        tcp::endpoint remote_endpoint() const { return net.ssl_socket.next_layer().remote_endpoint(); }
+        bool send_file(const int fd, const uint64_t offset = 0, const uint64_t length = 0,
+                       const std::function<void(const asio::error_code &, const size_t)> &callback = nullptr) {
+            if (!net.ssl_socket.next_layer().is_open())
+                return false;
 
+            return send_queue.push_file(fd, offset, length, callback);
+        }
+#endif
+
+#ifdef ASIO_HAS_CO_AWAIT
         /**
-         * Return a const ref of the latest error code returned by asio.
+         * Return the strand executor of the socket. Coroutines using the awaitable functions must run on it.
          *
          * @par Example
          * @code
-         * tcp_client_ssl_c client({});
-         * asio::error_code ec = client.get_error_code();
+         * asio::co_spawn(client.get_executor(), session(client), asio::detached);
+         * client.connect({"localhost", "8080", v4});
          * @endcode
          */
-        asio::error_code get_error_code() const { return error_code; }
+        asio::any_io_executor get_executor() { return net.resolver.get_executor(); }
 
         /**
-         * Sends string data on the socket.
-         * It returns false if socket is closed or if buffer is empty.
+         * Awaitable version of 'write()'. The message is owned by the coroutine frame until it has been sent.
          *
          * @param message String to be send.
          *
-         * @param callback An optional callback function may be specified to as a way of reporting DNS errors or for determining when it is safe to reuse the buf object.
+         * @return A tuple with the error code and the number of bytes sent.
          *
          * @par Example
          * @code
          * tcp_client_ssl_c client({});
-         * client.connect("localhost", 8080, v4);
          *
-         * std::string message = "...";
-         * client.write(message);
+         * auto [ec, bytes_sent] = co_await client.async_write("...");
          * @endcode
          */
-        bool write(const std::string &message, const std::function<void(const asio::error_code &, const size_t)> &callback = nullptr) {
-            if (!net.ssl_socket.next_layer().is_open() || message.empty())
-                return false;
+        asio::awaitable<std::tuple<asio::error_code, size_t>> async_write(const std::string message) {
+            if (!is_open())
+                co_return std::make_tuple(asio::error_code(asio::error::not_connected), size_t(0));
 
-            asio::async_write(net.ssl_socket,
-                                asio::buffer(message.c_str(), message.size()),
-                                [&, callback](const asio::error_code &ec, const size_t bytes_sent) {
-                                    if (callback) callback(ec, bytes_sent);
-                                });
-            return true;
+            co_return co_await send_queue.async_push(message.data(), message.size());
         }
 
         /**
-         * Sends string data on the socket.
-         * It returns false if socket is closed or if buffer is empty.
+         * Awaitable version of 'write_buffer()'. The buffer is owned by the coroutine frame until it has been sent.
          *
-         * @param buffer String to be send.
+         * @param buffer Buffer to be send.
          *
-         * @param callback An optional callback function may be specified to as a way of reporting DNS errors or for determining when it is safe to reuse the buf object.
+         * @return A tuple with the error code and the number of bytes sent.
          *
          * @par Example
          * @code
          * tcp_client_ssl_c client({});
-         * client.connect("localhost", 8080, v4);
          *
          * std::vector<uint8_t> buffer = { 0, 1, 2, ... };
-         * client.write_buffer(buffer);
+         * auto [ec, bytes_sent] = co_await client.async_write_buffer(buffer);
          * @endcode
          */
-        bool write_buffer(const std::vector<uint8_t> &buffer, const std::function<void(const asio::error_code &, const size_t)> &callback = nullptr) {
-            if (!net.ssl_socket.next_layer().is_open() || buffer.empty())
-                return false;
+        asio::awaitable<std::tuple<asio::error_code, size_t>> async_write_buffer(const std::vector<uint8_t> buffer) {
+            if (!is_open())
+                co_return std::make_tuple(asio::error_code(asio::error::not_connected), size_t(0));
 
-            asio::async_write(net.ssl_socket,
-                                asio::buffer(buffer.data(), buffer.size()),
-                                [&, callback](const asio::error_code &ec, const size_t bytes_sent) {
-                                    if (callback) callback(ec, bytes_sent);
-                                });
-            return true;
+            co_return co_await send_queue.async_push(buffer.data(), buffer.size());
+        }
+
+        /**
+         * Wait for the next message received on the socket.
+         * After the first call, received messages are queued for 'async_read()' instead of being passed to 'on_message_received'.
+         *
+         * @return A tuple with the error code and the message. The error code is set when the connection
+         * has failed or ended and no queued message is left.
+         *
+         * @par Example
+         * @code
+         * tcp_client_ssl_c client({});
+         *
+         * auto [ec, message] = co_await client.async_read();
+         * @endcode
+         */
+        asio::awaitable<std::tuple<asio::error_code, std::vector<uint8_t>>> async_read() {
+            awaiting_reads = true;
+            while (read_queue.empty() && !read_error) {
+                asio::error_code ec;
+                read_signal.expires_at(asio::steady_timer::time_point::max());
+                co_await read_signal.async_wait(asio::redirect_error(asio::use_awaitable, ec));
+            }
+            if (read_queue.empty())
+                co_return std::make_tuple(read_error, std::vector<uint8_t>());
+
+            std::vector<uint8_t> message = std::move(read_queue.front());
+            read_queue.pop_front();
+            co_return std::make_tuple(asio::error_code(), std::move(message));
         }
+#endif
+
+        /**
+         * Set/Get how the byte stream is split into messages. Applied on the next 'connect()'.
+         * With a framing other than RAW, each complete message is passed to 'on_frame' or 'on_message_received',
+         * and 'write_frame()' adds the length prefix or delimiter. 'on_data' is not called.
+         *
+         * @par Example
+         * @code
+         * tcp_client_ssl_c client;
+         * client.framing.type = LENGTH_PREFIXED;
+         * client.framing.length_size = 2;
+         * @endcode
+         */
+        framing_t framing;
 
         /**
          * Initiate a connection on a given socket.
@@ -493,14 +1369,24 @@ namespace internetprotocol {
             if (net.ssl_socket.next_layer().is_open())
                 return false;
 
-            net.resolver.async_resolve(bind_opts.protocol == v4 ? tcp::v4() : tcp::v6(),
-                                        bind_opts.address,
-                                        bind_opts.port,
-                                        [&](const asio::error_code &ec, const tcp::resolver::results_type &results) {
-                                            resolve(ec, results);
-                                        });
-
-            asio::post(thread_pool, [&]{ run_context_thread(); });
+            bind_options = bind_opts;
+            reading_paused.store(false);
+            read_parked = false;
+            parked_work.reset();
+            codec = frame_codec_c(framing);
+#ifdef ASIO_HAS_CO_AWAIT
+            read_queue.clear();
+            read_error.clear();
+#endif
+            resolver_cache().async_resolve(net.resolver, resolve_protocol(bind_opts.protocol),
+                                            bind_opts.address,
+                                            bind_opts.port,
+                                            [&](const asio::error_code &ec, const tcp::resolver::results_type &results) {
+                                                resolve(ec, results);
+                                            }, bind_opts.use_resolver_cache);
+
+            if (net.owned_context)
+                asio::post(default_runtime().get_executor(), [&]{ run_context_thread(); });
             return true;
         }
 
@@ -510,11 +1396,12 @@ namespace internetprotocol {
          * @par Example
          * @code
          * tcp_client_ssl_c client({});
-         * client.close(false);
+         * client.close();
          * @endcode
          */
         void close() {
             is_closing.store(true);
+            connector.cancel();
             if (net.ssl_socket.next_layer().is_open()) {
                 std::lock_guard guard(mutex_error);
                 net.ssl_socket.lowest_layer().shutdown(asio::socket_base::shutdown_both, error_code);
@@ -531,15 +1418,99 @@ namespace internetprotocol {
                 if (error_code && on_error)
                     on_error(error_code);
             }
-            net.context.stop();
-            net.context.restart();
+            if (net.owned_context) {
+                net.context.stop();
+                net.context.restart();
+            }
             net.endpoint = tcp::endpoint();
-            net.ssl_socket = asio::ssl::stream<tcp::socket>(net.context, net.ssl_context);
+            net.ssl_socket = asio::ssl::stream<tcp::socket>(net.resolver.get_executor(), net.ssl_context);
             if (on_close)
                 on_close();
-            is_closing.store(true);
+            is_closing.store(false);
+        }
+
+        /**
+         * Set the send queue watermarks in bytes. 'on_backpressure' is triggered when the bytes waiting to be sent
+         * reach 'high', and 'on_drain' once they fall back to 'low' or below. A 'high' of 0 disables them.
+         *
+         * @param high Queued bytes at which the peer is considered to be falling behind.
+         *
+         * @param low Queued bytes at which writing may resume.
+         *
+         * @par Example
+         * @code
+         * tcp_client_ssl_c client;
+         * client.set_watermarks(1024 * 1024, 256 * 1024);
+         * @endcode
+         */
+        void set_watermarks(const size_t high, const size_t low) {
+            send_queue.set_watermarks(high, low,
+                                      [&]() {
+                                          if (on_backpressure)
+                                              on_backpressure();
+                                      },
+                                      [&]() {
+                                          if (on_drain)
+                                              on_drain();
+                                      });
+        }
+
+        /**
+         * Return the number of bytes written and not sent yet.
+         *
+         * @par Example
+         * @code
+         * tcp_client_ssl_c client;
+         * size_t queued = client.get_queued_bytes();
+         * @endcode
+         */
+        size_t get_queued_bytes() { return send_queue.queued_bytes(); }
+
+        /**
+         * Stop reading from the socket. The read already in progress still completes,
+         * after that nothing more is received until 'resume_reading()' is called.
+         *
+         * @par Example
+         * @code
+         * tcp_client_ssl_c client;
+         * client.pause_reading();
+         * @endcode
+         */
+        void pause_reading() { reading_paused.store(true); }
+
+        /**
+         * Start reading from the socket again after 'pause_reading()'.
+         *
+         * @par Example
+         * @code
+         * tcp_client_ssl_c client;
+         * client.resume_reading();
+         * @endcode
+         */
+        void resume_reading() {
+            reading_paused.store(false);
+            asio::post(net.ssl_socket.get_executor(), [&]() {
+                if (!read_parked)
+                    return;
+
+                read_parked = false;
+                parked_work.reset();
+                if (net.ssl_socket.next_layer().is_open())
+                    read_next();
+            });
         }
 
+        /**
+         * Return true if reading has been paused with 'pause_reading()'.
+         *
+         * @par Example
+         * @code
+         * tcp_client_ssl_c client;
+         * bool paused = client.is_reading_paused();
+         * @endcode
+         */
+        bool is_reading_paused() const { return reading_paused.load(); }
+
         /**
          * Adds the listener function to 'on_connected'.
          * This event will be triggered when socket start to listening.
@@ -568,6 +1539,69 @@ namespace internetprotocol {
          */
         std::function<void(const std::vector<uint8_t> &, const size_t)> on_message_received;
 
+        /**
+         * Adds the listener function to 'on_data'. When set, it is called instead of 'on_message_received'.
+         * It is not called when 'framing' is set to anything other than RAW, see 'on_frame'.
+         * It receives a read-only view of the receive buffer, without copying it, and returns how many bytes it consumed.
+         * Bytes left unconsumed stay buffered and are passed again, followed by the new data, on the next read.
+         * The view is only valid during the call.
+         *
+         * @par Example
+         * @code
+         * tcp_client_ssl_c client({});
+         * client.on_data = [&](const uint8_t *data, const size_t size) -> size_t {
+         *      // your code...
+         *      return size;
+         * };
+         * @endcode
+         */
+        std::function<size_t(const uint8_t *, const size_t)> on_data;
+
+        /**
+         * Adds the listener function to 'on_frame'.
+         * When framing is enabled, this event is triggered once per complete message with a read-only view of it
+         * inside the receive buffer, without copying it. The view is only valid during the call.
+         * If it is not set, each message is copied and passed to 'on_message_received' instead.
+         *
+         * @par Example
+         * @code
+         * tcp_client_ssl_c client;
+         * client.on_frame = [&](const uint8_t *data, const size_t size) {
+         *      // your code...
+         * };
+         * @endcode
+         */
+        std::function<void(const uint8_t *, const size_t)> on_frame;
+
+        /**
+         * Adds the listener function to 'on_backpressure'.
+         * This event will be triggered when the bytes waiting to be sent reach the high watermark, see 'set_watermarks()'.
+         * It runs on the thread that wrote the message.
+         *
+         * @par Example
+         * @code
+         * tcp_client_ssl_c client;
+         * client.on_backpressure = [&]() {
+         *      // stop writing until 'on_drain'...
+         * };
+         * @endcode
+         */
+        std::function<void()> on_backpressure;
+
+        /**
+         * Adds the listener function to 'on_drain'.
+         * This event will be triggered when the bytes waiting to be sent fall back to the low watermark after 'on_backpressure'.
+         *
+         * @par Example
+         * @code
+         * tcp_client_ssl_c client;
+         * client.on_drain = [&]() {
+         *      // your code...
+         * };
+         * @endcode
+         */
+        std::function<void()> on_drain;
+
         /**
          * Adds the listener function to 'on_close'.
          * This event will be triggered when socket is closed.
@@ -601,42 +1635,122 @@ namespace internetprotocol {
         std::mutex mutex_error;
         std::atomic<bool> is_closing = false;
         tcp_client_ssl_t net;
+        tcp_connector_c connector;
+        send_queue_c<asio::ssl::stream<tcp::socket>> send_queue{net.ssl_socket, true};
         asio::error_code error_code;
-        asio::streambuf recv_buffer;
+        client_bind_options_t bind_options;
+        frame_codec_c codec;
+        std::atomic<bool> reading_paused = false;
+        bool read_parked = false;
+        std::optional<asio::executor_work_guard<asio::io_context::executor_type>> parked_work;
+        pooled_streambuf_c recv_buffer{buffer_pool_c::get(net.ssl_socket.get_executor())};
+#ifdef ASIO_HAS_CO_AWAIT
+        bool awaiting_reads = false;
+        asio::steady_timer read_signal{net.resolver.get_executor()};
+        std::deque<std::vector<uint8_t>> read_queue;
+        asio::error_code read_error;
+
+        void wake_readers(const asio::error_code &error) {
+            read_error = error;
+            read_signal.cancel();
+        }
+#endif
+
+        void init(const security_context_opts &sec_opts) {
+            if (!sec_opts.private_key.empty()) {
+                const asio::const_buffer buffer(sec_opts.private_key.data(), sec_opts.private_key.size());
+                net.ssl_context.use_private_key(buffer, sec_opts.file_format);
+            }
+
+            if (!sec_opts.cert.empty()) {
+                const asio::const_buffer buffer(sec_opts.cert.data(), sec_opts.cert.size());
+                net.ssl_context.use_certificate(buffer, sec_opts.file_format);
+            }
+
+            if (!sec_opts.cert_chain.empty()) {
+                const asio::const_buffer buffer(sec_opts.cert_chain.data(), sec_opts.cert_chain.size());
+                net.ssl_context.use_certificate_chain(buffer);
+            }
+
+            if (!sec_opts.rsa_private_key.empty()) {
+                const asio::const_buffer buffer(sec_opts.rsa_private_key.data(), sec_opts.rsa_private_key.size());
+                net.ssl_context.use_rsa_private_key(buffer, sec_opts.file_format);
+            }
+
+            if (!sec_opts.host_name_verification.empty()) {
+                net.ssl_context.set_verify_callback(asio::ssl::host_name_verification(sec_opts.host_name_verification));
+            }
+
+            switch (sec_opts.verify_mode) {
+                case none:
+                    net.ssl_context.set_verify_mode(asio::ssl::verify_none);
+                    break;
+                case verify_peer:
+                    net.ssl_context.set_verify_mode(asio::ssl::verify_peer);
+                    break;
+                case verify_fail_if_no_peer_cert:
+                    net.ssl_context.set_verify_mode(asio::ssl::verify_fail_if_no_peer_cert);
+                    break;
+                case verify_client_once:
+                    net.ssl_context.set_verify_mode(asio::ssl::verify_client_once);
+                    break;
+                default:
+                    break;
+            }
+
+            net.ssl_socket = asio::ssl::stream<tcp::socket>(net.resolver.get_executor(), net.ssl_context);
+        }
 
         void run_context_thread() {
             std::lock_guard guard(mutex_io);
             error_code.clear();
-            net.context.run();
+            run_context(net.context, bind_options.busy_poll_us);
             if (!is_closing.load())
                 close();
         }
 
+        void close_after_error(const asio::error_code &error) {
+#ifdef ASIO_HAS_CO_AWAIT
+            wake_readers(error);
+#endif
+            // Private io_contexts are closed by run_context_thread once they run out of work
+            if (!net.owned_context && error != asio::error::operation_aborted && !is_closing.load())
+                close();
+        }
+
         void resolve(const asio::error_code &error, const tcp::resolver::results_type &results) {
             if (error) {
-                std::lock_guard guard(mutex_error);
-                error_code = error;
-                if (on_error)
-                    on_error(error);
+                {
+                    std::lock_guard guard(mutex_error);
+                    error_code = error;
+                    if (on_error)
+                        on_error(error);
+                }
+                close_after_error(error);
                 return;
             }
             net.endpoint = results.begin()->endpoint();
-            asio::async_connect(net.ssl_socket.lowest_layer(),
-                                results,
-                                [&](const asio::error_code &ec, const tcp::endpoint &ep) {
-                                    conn(ec);
-                                });
+            connector.async_connect(net.ssl_socket.next_layer(), results, std::chrono::milliseconds(bind_options.connect_attempt_delay_ms),
+                                    [&](const asio::error_code &ec, const tcp::endpoint &ep) {
+                                        conn(ec);
+                                    });
         }
 
         void conn(const asio::error_code &error) {
             if (error) {
-                std::lock_guard guard(mutex_error);
-                error_code = error;
-                if (on_error)
-                    on_error(error);
+                {
+                    std::lock_guard guard(mutex_error);
+                    error_code = error;
+                    if (on_error)
+                        on_error(error);
+                }
+                close_after_error(error);
                 return;
             }
 
+            set_busy_poll(net.ssl_socket.lowest_layer(), bind_options.so_busy_poll_us);
+            set_socket_options(net.ssl_socket.lowest_layer(), bind_options.socket_options);
+
             net.ssl_socket.async_handshake(asio::ssl::stream_base::client,
                                             [&](const asio::error_code &ec) {
                                                 ssl_handshake(ec);
@@ -645,10 +1759,13 @@ namespace internetprotocol {
 
         void ssl_handshake(const asio::error_code &error) {
             if (error) {
-                std::lock_guard guard(mutex_error);
-                error_code = error;
-                if (on_error)
-                    on_error(error);
+                {
+                    std::lock_guard guard(mutex_error);
+                    error_code = error;
+                    if (on_error)
+                        on_error(error);
+                }
+                close_after_error(error);
                 return;
             }
 
@@ -656,13 +1773,72 @@ namespace internetprotocol {
                 on_connected();
 
             consume_recv_buffer();
-            asio::async_read(net.ssl_socket,
-                            recv_buffer,
-                            asio::transfer_at_least(1),
-                            [&](const asio::error_code &ec, const size_t bytes_received) {
-                                read_cb(ec, bytes_received);
-                            });
+            async_read_pooled(net.ssl_socket, recv_buffer,
+                              [&](const asio::error_code &ec, const size_t bytes_received) {
+                                  read_cb(ec, bytes_received);
+                              });
+
+        }
+
+        bool push_frame(const uint8_t *data, const size_t size, const std::function<void(const asio::error_code &, const size_t)> &callback) {
+            std::vector<uint8_t> frame = send_queue.acquire(codec.overhead() + size);
+            if (!codec.encode(data, size, frame))
+                return false;
+
+            send_queue.push(std::move(frame), callback);
+            return true;
+        }
+
+        void dispatch_frame(const uint8_t *data, const size_t size) {
+#ifdef ASIO_HAS_CO_AWAIT
+            if (awaiting_reads) {
+                read_queue.emplace_back(data, data + size);
+                read_signal.cancel();
+                return;
+            }
+#endif
+            if (on_frame) {
+                on_frame(data, size);
+                return;
+            }
+            if (on_message_received)
+                on_message_received(std::vector<uint8_t>(data, data + size), size);
+        }
+
+        // Deliver every complete message in the receive buffer. Returns false if the peer broke the framing.
+        bool read_frames() {
+            asio::error_code ec;
+            const size_t consumed = codec.decode(static_cast<const uint8_t *>(recv_buffer.data().data()), recv_buffer.size(),
+                                                 [&](const uint8_t *data, const size_t size) {
+                                                     dispatch_frame(data, size);
+                                                 }, ec);
+            recv_buffer.consume(consumed);
+            if (!ec)
+                return true;
+
+            {
+                std::lock_guard guard(mutex_error);
+                error_code = ec;
+                if (on_error)
+                    on_error(error_code);
+            }
+            close_after_error(ec);
+            return false;
+        }
 
+        // Re-arm the read unless reading is paused, in which case 'resume_reading()' does it
+        void read_next() {
+            if (reading_paused.load()) {
+                read_parked = true;
+                // A private io_context would otherwise run out of work and close the connection
+                if (net.owned_context)
+                    parked_work.emplace(net.context.get_executor());
+                return;
+            }
+            async_read_pooled(net.ssl_socket, recv_buffer,
+                              [&](const asio::error_code &ec, const size_t bytes_received) {
+                                  read_cb(ec, bytes_received);
+                              });
         }
 
         void consume_recv_buffer() {
@@ -673,28 +1849,49 @@ namespace internetprotocol {
 
         void read_cb(const asio::error_code &error, const size_t bytes_recvd) {
             if (error) {
-                std::lock_guard guard(mutex_error);
-                error_code = error;
-                if (on_error)
-                    on_error(error);
+                {
+                    std::lock_guard guard(mutex_error);
+                    error_code = error;
+                    if (on_error)
+                        on_error(error);
+                }
+                close_after_error(error);
                 return;
             }
 
-            if (on_message_received) {
-                std::vector<uint8_t> buffer;
-                buffer.resize(bytes_recvd);
-                asio::buffer_copy(asio::buffer(buffer, bytes_recvd),
+            if (!codec.is_raw()) {
+                if (read_frames())
+                    read_next();
+                return;
+            }
+#ifdef ASIO_HAS_CO_AWAIT
+            if (awaiting_reads) {
+                std::vector<uint8_t> buf(bytes_recvd);
+                asio::buffer_copy(asio::buffer(buf, bytes_recvd),
                                   recv_buffer.data());
-                on_message_received(buffer, bytes_recvd);
+                read_queue.push_back(std::move(buf));
+                read_signal.cancel();
+                consume_recv_buffer();
+                read_next();
+                return;
             }
-
-            consume_recv_buffer();
-            asio::async_read(net.ssl_socket,
-                            recv_buffer,
-                            asio::transfer_at_least(1),
-                            [&](const asio::error_code &ec, const size_t bytes_received) {
-                                read_cb(ec, bytes_received);
-                            });
+#endif
+            if (on_data) {
+                const size_t size = recv_buffer.size();
+                const size_t consumed = on_data(static_cast<const uint8_t *>(recv_buffer.data().data()), size);
+                // Bytes left unconsumed stay buffered and are passed again with the next read
+                recv_buffer.consume(std::min(consumed, size));
+            } else {
+                if (on_message_received) {
+                    std::vector<uint8_t> buffer;
+                    buffer.resize(bytes_recvd);
+                    asio::buffer_copy(asio::buffer(buffer, bytes_recvd),
+                                      recv_buffer.data());
+                    on_message_received(buffer, bytes_recvd);
+                }
+                consume_recv_buffer();
+            }
+            read_next();
         }
     };
 #endif
@@ -0,0 +1,431 @@
+/**
+ * MIT License (MIT)
+ * Copyright © 2025 Nathan Miguel
+*/
+
+#pragma once
+
+#include "ip/tcp/tcpclient.hpp"
+
+namespace internetprotocol {
+    typedef enum : uint8_t {
+        /// Each write goes to the next connected member in turn.
+        ROUND_ROBIN = 0,
+        /// Each write goes to the connected member with the fewest bytes waiting to be sent.
+        LEAST_QUEUED = 1
+    } pool_balance_e;
+
+    /**
+     * Options of a tcp_client_pool_c.
+     *
+     * @par Example
+     * @code
+     * client_pool_options_t options;
+     * options.target = {"storage.local", "9000", v4};
+     * options.connections = 8;
+     * options.balance = LEAST_QUEUED;
+     * @endcode
+     */
+    struct client_pool_options_t {
+        /// Endpoint and socket options of every member.
+        client_bind_options_t target;
+        /// Number of connections held open to 'target'.
+        size_t connections = 4;
+        pool_balance_e balance = LEAST_QUEUED;
+        /// Milliseconds to wait before reconnecting a member that closed.
+        uint32_t replace_delay_ms = 1000;
+    };
+
+    /**
+     * Several tcp_client_c connections to the same endpoint, used as one.
+     * Writes are spread across the connected members, so traffic to a single server is not bound to one stream.
+     * A member that closes is connected again in the background after 'replace_delay_ms'.
+     * Members enabling 'target.reconnect' handle short outages themselves, the pool only replaces those that gave up.
+     * Messages are not ordered across members, a sequence that must arrive in order has to be written to one client.
+     */
+    class tcp_client_pool_c {
+    public:
+        /**
+         * Construct the pool on the io_context of the default runtime.
+         */
+        tcp_client_pool_c(): tcp_client_pool_c(default_runtime()) {}
+
+        /**
+         * Construct the pool on a shared io_context. Every member runs on it, each on its own strand.
+         * Keep the pool alive until 'io_context' has run the handlers cancelled by 'close()'.
+         *
+         * @param io_context Shared io_context used by the members.
+         *
+         * @par Example
+         * @code
+         * asio::io_context io_context;
+         * tcp_client_pool_c pool(io_context);
+         * @endcode
+         */
+        explicit tcp_client_pool_c(asio::io_context &io_context): context(io_context) {}
+
+        /**
+         * Construct the pool on the io_context of a runtime, see the io_context constructor.
+         *
+         * @param runtime Runtime whose threads run the members. Must outlive the pool.
+         *
+         * @par Example
+         * @code
+         * runtime_c runtime({ 4, "storage" });
+         * tcp_client_pool_c pool(runtime);
+         * @endcode
+         */
+        explicit tcp_client_pool_c(runtime_c &runtime): tcp_client_pool_c(runtime.context()) {}
+
+        ~tcp_client_pool_c() {
+            if (opened.load())
+                close();
+        }
+
+        /**
+         * Return true between 'open()' and 'close()'.
+         */
+        bool is_open() const { return opened.load(); }
+
+        /**
+         * Return the number of members currently connected.
+         *
+         * @par Example
+         * @code
+         * tcp_client_pool_c pool;
+         * size_t connected = pool.connected();
+         * @endcode
+         */
+        size_t connected() const {
+            size_t count = 0;
+            for (size_t i = 0; i < active; ++i) {
+                if (members[i]->usable())
+                    ++count;
+            }
+            return count;
+        }
+
+        /**
+         * Return the number of bytes written and not sent yet, across every member.
+         */
+        size_t get_queued_bytes() {
+            size_t queued = 0;
+            for (size_t i = 0; i < active; ++i)
+                queued += members[i]->client.get_queued_bytes();
+            return queued;
+        }
+
+        /**
+         * Sends string data on one of the members, see 'tcp_client_c::write()'.
+         * It returns false if no member can take it or if message is empty.
+         *
+         * @param message String to be send.
+         *
+         * @param callback An optional callback function reporting errors and the number of bytes sent.
+         *
+         * @par Example
+         * @code
+         * tcp_client_pool_c pool;
+         * pool.write("...");
+         * @endcode
+         */
+        bool write(const std::string &message, const std::function<void(const asio::error_code &, const size_t)> &callback = nullptr) {
+            tcp_client_c *client = pick();
+            return client && client->write(message, callback);
+        }
+
+        /**
+         * Sends buffer data on one of the members, see 'tcp_client_c::write_buffer()'.
+         * It returns false if no member can take it or if buffer is empty.
+         *
+         * @param buffer Buffer to be send.
+         *
+         * @param callback An optional callback function reporting errors and the number of bytes sent.
+         *
+         * @par Example
+         * @code
+         * tcp_client_pool_c pool;
+         *
+         * std::vector<uint8_t> buffer = { 0, 1, 2, ... };
+         * pool.write_buffer(buffer);
+         * @endcode
+         */
+        bool write_buffer(const std::vector<uint8_t> &buffer, const std::function<void(const asio::error_code &, const size_t)> &callback = nullptr) {
+            tcp_client_c *client = pick();
+            return client && client->write_buffer(buffer, callback);
+        }
+
+        /**
+         * Sends string data on one of the members as one message of the configured framing, see 'tcp_client_c::write_frame()'.
+         * It returns false if no member can take it, if message is empty or if it does not fit the framing.
+         *
+         * @param message String to be send.
+         *
+         * @param callback An optional callback function reporting errors and the number of bytes sent.
+         *
+         * @par Example
+         * @code
+         * tcp_client_pool_c pool;
+         * pool.framing.type = LENGTH_PREFIXED;
+         * pool.write_frame("...");
+         * @endcode
+         */
+        bool write_frame(const std::string &message, const std::function<void(const asio::error_code &, const size_t)> &callback = nullptr) {
+            tcp_client_c *client = pick();
+            return client && client->write_frame(message, callback);
+        }
+
+        /**
+         * Sends buffer data on one of the members as one message of the configured framing, see 'tcp_client_c::write_frame_buffer()'.
+         * It returns false if no member can take it, if buffer is empty or if it does not fit the framing.
+         *
+         * @param buffer Buffer to be send.
+         *
+         * @param callback An optional callback function reporting errors and the number of bytes sent.
+         *
+         * @par Example
+         * @code
+         * tcp_client_pool_c pool;
+         *
+         * std::vector<uint8_t> buffer = { 0, 1, 2, ... };
+         * pool.write_frame_buffer(buffer);
+         * @endcode
+         */
+        bool write_frame_buffer(const std::vector<uint8_t> &buffer, const std::function<void(const asio::error_code &, const size_t)> &callback = nullptr) {
+            tcp_client_c *client = pick();
+            return client && client->write_frame_buffer(buffer, callback);
+        }
+
+        /**
+         * Connect 'connections' members to 'target'.
+         * It returns false if the pool is already open or if 'connections' is 0.
+         * Members are created by the first call and kept, so a pool can be closed and opened again.
+         *
+         * @param options Target, size and balancing of the pool.
+         *
+         * @par Example
+         * @code
+         * tcp_client_pool_c pool;
+         * pool.open({{"localhost", "8080", v4}, 4});
+         * @endcode
+         */
+        bool open(const client_pool_options_t &options) {
+            if (opened.load() || options.connections == 0)
+                return false;
+
+            pool_options = options;
+            is_closing.store(false);
+            while (members.size() < options.connections) {
+                members.push_back(std::make_unique<member_t>(context));
+                bind_member(members.size() - 1);
+            }
+            active = options.connections;
+            next_member.store(0);
+            opened.store(true);
+
+            for (size_t i = 0; i < active; ++i) {
+                tcp_client_c &client = members[i]->client;
+                client.framing = framing;
+                client.on_frame = nullptr;
+                if (on_frame) {
+                    client.on_frame = [&](const uint8_t *data, const size_t size) {
+                        on_frame(data, size);
+                    };
+                }
+                client.connect(pool_options.target);
+            }
+            return true;
+        }
+
+        /**
+         * Close every member and stop replacing them. 'on_close' is triggered for each member.
+         *
+         * @par Example
+         * @code
+         * tcp_client_pool_c pool;
+         * pool.close();
+         * @endcode
+         */
+        void close() {
+            is_closing.store(true);
+            {
+                std::lock_guard guard(mutex_members);
+                for (size_t i = 0; i < active; ++i)
+                    members[i]->replace_timer.cancel();
+            }
+            for (size_t i = 0; i < active; ++i)
+                members[i]->client.close();
+            opened.store(false);
+        }
+
+        /// Framing applied to every member by 'open()', see 'tcp_client_c::framing'.
+        framing_t framing;
+
+        /**
+         * Adds the listener function to 'on_connected'.
+         * This event will be triggered each time a member connects, with the member index.
+         *
+         * @par Example
+         * @code
+         * tcp_client_pool_c pool;
+         * pool.on_connected = [&](const size_t member) {
+         *      // your code...
+         * };
+         * @endcode
+         */
+        std::function<void(const size_t)> on_connected;
+
+        /**
+         * Adds the listener function to 'on_message_received'.
+         * This event will be triggered when any member receives a message.
+         *
+         * @par Example
+         * @code
+         * tcp_client_pool_c pool;
+         * pool.on_message_received = [&](const std::vector<uint8_t> &buffer, const size_t bytes_recvd) {
+         *      // your code...
+         * };
+         * @endcode
+         */
+        std::function<void(const std::vector<uint8_t> &, const size_t)> on_message_received;
+
+        /**
+         * Adds the listener function to 'on_frame'.
+         * When set before 'open()', members pass each message without copying it, see 'tcp_client_c::on_frame'.
+         *
+         * @par Example
+         * @code
+         * tcp_client_pool_c pool;
+         * pool.on_frame = [&](const uint8_t *data, const size_t size) {
+         *      // your code...
+         * };
+         * @endcode
+         */
+        std::function<void(const uint8_t *, const size_t)> on_frame;
+
+        /**
+         * Adds the listener function to 'on_close'.
+         * This event will be triggered each time a connected member closes, with the member index.
+         *
+         * @par Example
+         * @code
+         * tcp_client_pool_c pool;
+         * pool.on_close = [&](const size_t member) {
+         *      // your code...
+         * };
+         * @endcode
+         */
+        std::function<void(const size_t)> on_close;
+
+        /**
+         * Adds the listener function to 'on_error'.
+         * This event will be triggered when any error occurs on a member, with the member index.
+         *
+         * @par Example
+         * @code
+         * tcp_client_pool_c pool;
+         * pool.on_error = [&](const size_t member, const asio::error_code &ec) {
+         *      std::cout << "member " << member << ": " << ec.message() << std::endl;
+         * };
+         * @endcode
+         */
+        std::function<void(const size_t, const asio::error_code &)> on_error;
+
+    private:
+        struct member_t {
+            explicit member_t(asio::io_context &io_context): client(io_context), replace_timer(asio::make_strand(io_context)) {
+            }
+
+            tcp_client_c client;
+            asio::steady_timer replace_timer;
+            std::atomic<bool> connected = false;
+
+            // Connected and not waiting for its own reconnect policy
+            bool usable() const { return connected.load() && !client.is_reconnecting(); }
+        };
+
+        asio::io_context &context;
+        std::atomic<bool> opened = false;
+        std::atomic<bool> is_closing = false;
+        client_pool_options_t pool_options;
+        // Guards the replace timers, which are armed from the member strands and cancelled by 'close()'
+        std::mutex mutex_members;
+        std::vector<std::unique_ptr<member_t>> members;
+        size_t active = 0;
+        std::atomic<size_t> next_member = 0;
+
+        void bind_member(const size_t index) {
+            member_t &member = *members[index];
+            member.client.on_connected = [&, index]() {
+                members[index]->connected.store(true);
+                if (on_connected)
+                    on_connected(index);
+            };
+            member.client.on_message_received = [&](const std::vector<uint8_t> &buffer, const size_t bytes_recvd) {
+                if (on_message_received)
+                    on_message_received(buffer, bytes_recvd);
+            };
+            member.client.on_error = [&, index](const asio::error_code &ec) {
+                if (on_error)
+                    on_error(index, ec);
+            };
+            member.client.on_close = [&, index]() {
+                // A failed attempt, or a late read error on a closed member, is not reported again
+                if (members[index]->connected.exchange(false) && on_close)
+                    on_close(index);
+                schedule_replace(index);
+            };
+        }
+
+        void schedule_replace(const size_t index) {
+            std::lock_guard guard(mutex_members);
+            if (is_closing.load() || !opened.load())
+                return;
+
+            member_t &member = *members[index];
+            member.replace_timer.expires_after(std::chrono::milliseconds(pool_options.replace_delay_ms));
+            member.replace_timer.async_wait([&, index](const asio::error_code &ec) {
+                if (ec || is_closing.load())
+                    return;
+                members[index]->client.connect(pool_options.target);
+            });
+        }
+
+        // Member for the next write. Members that are reconnecting hold writes, and are used when none is connected
+        tcp_client_c *pick() {
+            if (!opened.load() || active == 0)
+                return nullptr;
+
+            const size_t start = next_member.fetch_add(1) % active;
+            if (pool_options.balance == LEAST_QUEUED) {
+                member_t *least = nullptr;
+                size_t least_queued = 0;
+                for (size_t n = 0; n < active; ++n) {
+                    member_t &member = *members[(start + n) % active];
+                    if (!member.usable())
+                        continue;
+                    const size_t queued = member.client.get_queued_bytes();
+                    if (!least || queued < least_queued) {
+                        least = &member;
+                        least_queued = queued;
+                    }
+                }
+                if (least)
+                    return &least->client;
+            } else {
+                for (size_t n = 0; n < active; ++n) {
+                    member_t &member = *members[(start + n) % active];
+                    if (member.usable())
+                        return &member.client;
+                }
+            }
+
+            for (size_t n = 0; n < active; ++n) {
+                member_t &member = *members[(start + n) % active];
+                if (member.client.is_reconnecting())
+                    return &member.client;
+            }
+            return nullptr;
+        }
+    };
+}
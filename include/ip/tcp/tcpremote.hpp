@@ -12,7 +12,9 @@ using namespace asio::ip;
 namespace internetprotocol {
     class tcp_remote_c {
     public:
-        explicit tcp_remote_c(asio::io_context &io_context): socket(io_context) {
+        explicit tcp_remote_c(asio::io_context &io_context, const uint16_t timeout = 0, const framing_t &framing = {})
+            : socket(asio::make_strand(io_context)), idle_timer(io_context, socket.get_executor()), codec(framing) {
+            idle_timeout_seconds = timeout;
         }
 
         ~tcp_remote_c() {
@@ -56,6 +58,21 @@ namespace internetprotocol {
         /// Just ignore this function
         tcp::socket &get_socket() { return socket; }
 
+        /**
+         * Return the connection id the server gave this client, 0 until it has been accepted.
+         * Unlike the shared_ptr it can be stored anywhere, 'server.find(id)' returns the client while it is connected.
+         *
+         * @par Example
+         * @code
+         * tcp_remote_c client;
+         * connection_id_t id = client.get_id();
+         * @endcode
+         */
+        connection_id_t get_id() const { return id; }
+
+        /// Set by the server when the connection is accepted.
+        void set_id(const connection_id_t connection_id) { id = connection_id; }
+
         /**
          * Return a const ref of the latest error code returned by asio.
          *
@@ -83,54 +100,1050 @@ namespace internetprotocol {
          * client.write(message);
          * @endcode
          */
-        bool write(const std::string &message, const std::function<void(const asio::error_code &, const size_t)> &callback = nullptr) {
-            if (!socket.is_open() || message.empty())
-                return false;
+        bool write(const std::string &message, const std::function<void(const asio::error_code &, const size_t)> &callback = nullptr) {
+            if (!socket.is_open() || message.empty())
+                return false;
+
+            reset_idle_timer();
+
+            send_queue.push(message.data(), message.size(), callback);
+            return true;
+        }
+
+        /**
+         * Sends buffer data on the socket.
+         * It returns false if socket is closed or if buffer is empty.
+         *
+         * @param buffer String to be send.
+         *
+         * @param callback An optional callback function may be specified to as a way of reporting DNS errors or for determining when it is safe to reuse the buf object.
+         *
+         * @par Example
+         * @code
+         * tcp_remote_c client;
+         *
+         * std::vector<uint8_t> buffer = { 0, 1, 2, ... };
+         * client.write_buffer(buffer);
+         * @endcode
+         */
+        bool write_buffer(const std::vector<uint8_t> &buffer, const std::function<void(const asio::error_code &, const size_t)> &callback = nullptr) {
+            if (!socket.is_open() || buffer.empty())
+                return false;
+
+            reset_idle_timer();
+
+            send_queue.push(buffer.data(), buffer.size(), callback);
+            return true;
+        }
+
+        /**
+         * Sends string data on the socket as one message of the configured framing.
+         * The length prefix or delimiter is added for you. It returns false if socket is closed, if message is empty
+         * or if it does not fit the framing.
+         *
+         * @param message String to be send.
+         *
+         * @param callback An optional callback function may be specified to as a way of reporting DNS errors or for determining when it is safe to reuse the buf object.
+         *
+         * @par Example
+         * @code
+         * tcp_remote_c client;
+         *
+         * std::string message = "...";
+         * client.write_frame(message);
+         * @endcode
+         */
+        bool write_frame(const std::string &message, const std::function<void(const asio::error_code &, const size_t)> &callback = nullptr) {
+            if (!socket.is_open() || message.empty())
+                return false;
+
+            reset_idle_timer();
+
+            return push_frame(reinterpret_cast<const uint8_t *>(message.data()), message.size(), callback);
+        }
+
+        /**
+         * Sends buffer data on the socket as one message of the configured framing.
+         * The length prefix or delimiter is added for you. It returns false if socket is closed, if buffer is empty
+         * or if it does not fit the framing.
+         *
+         * @param buffer Buffer to be send.
+         *
+         * @param callback An optional callback function may be specified to as a way of reporting DNS errors or for determining when it is safe to reuse the buf object.
+         *
+         * @par Example
+         * @code
+         * tcp_remote_c client;
+         *
+         * std::vector<uint8_t> buffer = { 0, 1, 2, ... };
+         * client.write_frame_buffer(buffer);
+         * @endcode
+         */
+        bool write_frame_buffer(const std::vector<uint8_t> &buffer, const std::function<void(const asio::error_code &, const size_t)> &callback = nullptr) {
+            if (!socket.is_open() || buffer.empty())
+                return false;
+
+            reset_idle_timer();
+
+            return push_frame(buffer.data(), buffer.size(), callback);
+        }
+
+        /**
+         * Sends an already encoded message shared with other connections, without copying it.
+         * The bytes are written as they are: no framing is added. It returns false if socket is closed or if buffer is empty.
+         *
+         * @param buffer Shared message to be send. It must not be modified while queued.
+         *
+         * @param callback An optional callback function may be specified to as a way of reporting DNS errors or for determining when it is safe to reuse the buf object.
+         *
+         * @par Example
+         * @code
+         * tcp_remote_c client;
+         *
+         * shared_buffer_t buffer = std::make_shared<const std::vector<uint8_t>>(std::vector<uint8_t>{ 0, 1, 2, ... });
+         * client.write_shared(buffer);
+         * @endcode
+         */
+        bool write_shared(const shared_buffer_t &buffer, const std::function<void(const asio::error_code &, const size_t)> &callback = nullptr) {
+            if (!socket.is_open() || !buffer || buffer->empty())
+                return false;
+
+            reset_idle_timer();
+
+            send_queue.push(buffer, callback);
+            return true;
+        }
+
+#ifndef _WIN32
+        /**
+         * Sends part of a file on the socket, after the data already written.
+         * On Linux plain sockets the bytes go from the page cache to the socket with sendfile(2) and never enter user space.
+         * TLS connections, and other platforms, read the file in chunks.
+         * It returns false if socket is closed or if the file cannot be opened.
+         *
+         * @param path Path of the file to be send.
+         *
+         * @param offset First byte of the file to send.
+         *
+         * @param length Number of bytes to send. 0 sends up to the end of the file.
+         *
+         * @param callback An optional callback function reporting errors and the number of file bytes sent.
+         *
+         * @par Example
+         * @code
+         * tcp_remote_c client;
+         * client.send_file("artifact.tar.gz");
+         * @endcode
+         */
+        bool send_file(const std::string &path, const uint64_t offset = 0, const uint64_t length = 0,
+                       const std::function<void(const asio::error_code &, const size_t)> &callback = nullptr) {
+            if (!socket.is_open())
+                return false;
+
+            reset_idle_timer();
+
+            return send_queue.push_file(path, offset, length, callback);
+        }
+
+        /**
+         * Sends part of an open file on the socket, after the data already written. See 'send_file(path, ...)'.
+         * The descriptor is not closed and must stay open until the callback has been called.
+         *
+         * @param fd Open file descriptor.
+         *
+         * @param offset First byte of the file to send.
+         *
+         * @param length Number of bytes to send. 0 sends up to the end of the file.
+         *
+         * @param callback An optional callback function reporting errors and the number of file bytes sent.
+         *
+         * @par Example
+         * @code
+         * tcp_remote_c client;
+         * int fd = open("artifact.tar.gz", O_RDONLY);
+         * client.send_file(fd, 0, 0, [fd](const asio::error_code &ec, const size_t bytes_sent) {
+         *      close(fd);
+         * });
+         * @endcode
+         */
+        bool send_file(const int fd, const uint64_t offset = 0, const uint64_t length = 0,
+                       const std::function<void(const asio::error_code &, const size_t)> &callback = nullptr) {
+            if (!socket.is_open())
+                return false;
+
+            reset_idle_timer();
+
+            return send_queue.push_file(fd, offset, length, callback);
+        }
+#endif
+
+#ifdef ASIO_HAS_CO_AWAIT
+        /**
+         * Return the strand executor of the socket. Coroutines using the awaitable functions must run on it.
+         *
+         * @par Example
+         * @code
+         * server.on_client_accepted = [&](const std::shared_ptr<tcp_remote_c> &client) {
+         *      asio::co_spawn(client->get_executor(), session(client), asio::detached);
+         * };
+         * @endcode
+         */
+        asio::any_io_executor get_executor() { return socket.get_executor(); }
+
+        /**
+         * Awaitable version of 'write()'. The message is owned by the coroutine frame until it has been sent.
+         *
+         * @param message String to be send.
+         *
+         * @return A tuple with the error code and the number of bytes sent.
+         *
+         * @par Example
+         * @code
+         * tcp_remote_c client;
+         *
+         * auto [ec, bytes_sent] = co_await client.async_write("...");
+         * @endcode
+         */
+        asio::awaitable<std::tuple<asio::error_code, size_t>> async_write(const std::string message) {
+            if (!is_open())
+                co_return std::make_tuple(asio::error_code(asio::error::not_connected), size_t(0));
+
+            co_return co_await send_queue.async_push(message.data(), message.size());
+        }
+
+        /**
+         * Awaitable version of 'write_buffer()'. The buffer is owned by the coroutine frame until it has been sent.
+         *
+         * @param buffer Buffer to be send.
+         *
+         * @return A tuple with the error code and the number of bytes sent.
+         *
+         * @par Example
+         * @code
+         * tcp_remote_c client;
+         *
+         * std::vector<uint8_t> buffer = { 0, 1, 2, ... };
+         * auto [ec, bytes_sent] = co_await client.async_write_buffer(buffer);
+         * @endcode
+         */
+        asio::awaitable<std::tuple<asio::error_code, size_t>> async_write_buffer(const std::vector<uint8_t> buffer) {
+            if (!is_open())
+                co_return std::make_tuple(asio::error_code(asio::error::not_connected), size_t(0));
+
+            co_return co_await send_queue.async_push(buffer.data(), buffer.size());
+        }
+
+        /**
+         * Wait for the next message received on the socket.
+         * After the first call, received messages are queued for 'async_read()' instead of being passed to 'on_message_received'.
+         *
+         * @return A tuple with the error code and the message. The error code is set when the connection
+         * has failed or ended and no queued message is left.
+         *
+         * @par Example
+         * @code
+         * tcp_remote_c client;
+         *
+         * auto [ec, message] = co_await client.async_read();
+         * @endcode
+         */
+        asio::awaitable<std::tuple<asio::error_code, std::vector<uint8_t>>> async_read() {
+            awaiting_reads = true;
+            while (read_queue.empty() && !read_error) {
+                asio::error_code ec;
+                read_signal.expires_at(asio::steady_timer::time_point::max());
+                co_await read_signal.async_wait(asio::redirect_error(asio::use_awaitable, ec));
+            }
+            if (read_queue.empty())
+                co_return std::make_tuple(read_error, std::vector<uint8_t>());
+
+            std::vector<uint8_t> message = std::move(read_queue.front());
+            read_queue.pop_front();
+            co_return std::make_tuple(asio::error_code(), std::move(message));
+        }
+#endif
+
+        /// Ignore this function
+        void connect() {
+            start_idle_timer();
+            async_read_pooled(socket, recv_buffer,
+                              [&](const asio::error_code &ec, const size_t bytes_received) {
+                                  read_cb(ec, bytes_received);
+                              });
+        }
+
+        /**
+         * Close the underlying socket and stop listening for data on it. 'on_close' event will be triggered.
+         *
+         * @par Example
+         * @code
+         * tcp_remote_c client;
+         * client.close();
+         * @endcode
+         */
+        void close() {
+            idle_timer.cancel();
+            if (socket.is_open()) {
+                std::lock_guard guard(mutex_error);
+                socket.shutdown(tcp::socket::shutdown_both, error_code);
+                if (error_code && on_error)
+                    on_error(error_code);
+                socket.close(error_code);
+                if (error_code && on_error)
+                    on_error(error_code);
+            }
+            if (on_close)
+                on_close();
+        }
+
+        /**
+         * Shut down the sending side once every queued write has been sent, so the peer reads the end of the stream.
+         * The client keeps reading and 'on_close' event will be triggered when the peer closes its side too.
+         *
+         * @par Example
+         * @code
+         * tcp_remote_c client;
+         * client.write("bye");
+         * client.close_after_flush();
+         * @endcode
+         */
+        void close_after_flush() {
+            send_queue.when_flushed([&]() {
+                if (!socket.is_open())
+                    return;
+                std::lock_guard guard(mutex_error);
+                socket.shutdown(tcp::socket::shutdown_send, error_code);
+                if (error_code && on_error)
+                    on_error(error_code);
+            });
+        }
+
+        /**
+         * Set the send queue watermarks in bytes. 'on_backpressure' is triggered when the bytes waiting to be sent
+         * reach 'high', and 'on_drain' once they fall back to 'low' or below. A 'high' of 0 disables them.
+         *
+         * @param high Queued bytes at which the peer is considered to be falling behind.
+         *
+         * @param low Queued bytes at which writing may resume.
+         *
+         * @par Example
+         * @code
+         * tcp_remote_c client;
+         * client.set_watermarks(1024 * 1024, 256 * 1024);
+         * @endcode
+         */
+        void set_watermarks(const size_t high, const size_t low) {
+            send_queue.set_watermarks(high, low,
+                                      [&]() {
+                                          if (on_backpressure)
+                                              on_backpressure();
+                                      },
+                                      [&]() {
+                                          if (on_drain)
+                                              on_drain();
+                                      });
+        }
+
+        /**
+         * Return the number of bytes written and not sent yet.
+         *
+         * @par Example
+         * @code
+         * tcp_remote_c client;
+         * size_t queued = client.get_queued_bytes();
+         * @endcode
+         */
+        size_t get_queued_bytes() { return send_queue.queued_bytes(); }
+
+        /**
+         * Send messages of at least 'threshold' bytes with MSG_ZEROCOPY (Linux only).
+         * Their callback runs once the kernel has released the buffer, not when the data was queued to the socket.
+         * Returns false if the system does not support it. A 'threshold' of 0 disables it.
+         *
+         * @par Example
+         * @code
+         * tcp_remote_c client;
+         * client.set_zerocopy_threshold(64 * 1024);
+         * @endcode
+         */
+        bool set_zerocopy_threshold(const size_t threshold) { return send_queue.set_zerocopy_threshold(threshold); }
+
+        /**
+         * Stop reading from the socket. The read already in progress still completes,
+         * after that nothing more is received until 'resume_reading()' is called.
+         *
+         * @par Example
+         * @code
+         * tcp_remote_c client;
+         * client.pause_reading();
+         * @endcode
+         */
+        void pause_reading() { reading_paused.store(true); }
+
+        /**
+         * Start reading from the socket again after 'pause_reading()'.
+         *
+         * @par Example
+         * @code
+         * tcp_remote_c client;
+         * client.resume_reading();
+         * @endcode
+         */
+        void resume_reading() {
+            reading_paused.store(false);
+            asio::post(socket.get_executor(), [&]() {
+                if (!read_parked)
+                    return;
+
+                read_parked = false;
+                if (socket.is_open())
+                    read_next();
+            });
+        }
+
+        /**
+         * Return true if reading has been paused with 'pause_reading()'.
+         *
+         * @par Example
+         * @code
+         * tcp_remote_c client;
+         * bool paused = client.is_reading_paused();
+         * @endcode
+         */
+        bool is_reading_paused() const { return reading_paused.load(); }
+
+        /**
+         * Adds the listener function to 'on_message_received'.
+         * This event will be triggered when a message has been received.
+         *
+         * @par Example
+         * @code
+         * tcp_remote_c client;
+         * client.on_message_received = [&](const std::vector<uint8_t> &buffer, const size_t bytes_recvd) {
+         *      // your code...
+         * };
+         * @endcode
+         */
+        std::function<void(const std::vector<uint8_t> &, const size_t)> on_message_received;
+
+        /**
+         * Adds the listener function to 'on_data'. When set, it is called instead of 'on_message_received'.
+         * It is not called when the server uses a framing other than RAW, see 'on_frame'.
+         * It receives a read-only view of the receive buffer, without copying it, and returns how many bytes it consumed.
+         * Bytes left unconsumed stay buffered and are passed again, followed by the new data, on the next read.
+         * The view is only valid during the call.
+         *
+         * @par Example
+         * @code
+         * tcp_remote_c client;
+         * client.on_data = [&](const uint8_t *data, const size_t size) -> size_t {
+         *      // your code...
+         *      return size;
+         * };
+         * @endcode
+         */
+        std::function<size_t(const uint8_t *, const size_t)> on_data;
+
+        /**
+         * Adds the listener function to 'on_frame'.
+         * When framing is enabled, this event is triggered once per complete message with a read-only view of it
+         * inside the receive buffer, without copying it. The view is only valid during the call.
+         * If it is not set, each message is copied and passed to 'on_message_received' instead.
+         *
+         * @par Example
+         * @code
+         * tcp_remote_c client;
+         * client.on_frame = [&](const uint8_t *data, const size_t size) {
+         *      // your code...
+         * };
+         * @endcode
+         */
+        std::function<void(const uint8_t *, const size_t)> on_frame;
+
+        /**
+         * Adds the listener function to 'on_backpressure'.
+         * This event will be triggered when the bytes waiting to be sent reach the high watermark, see 'set_watermarks()'.
+         * It runs on the thread that wrote the message.
+         *
+         * @par Example
+         * @code
+         * tcp_remote_c client;
+         * client.on_backpressure = [&]() {
+         *      // stop writing until 'on_drain'...
+         * };
+         * @endcode
+         */
+        std::function<void()> on_backpressure;
+
+        /**
+         * Adds the listener function to 'on_drain'.
+         * This event will be triggered when the bytes waiting to be sent fall back to the low watermark after 'on_backpressure'.
+         *
+         * @par Example
+         * @code
+         * tcp_remote_c client;
+         * client.on_drain = [&]() {
+         *      // your code...
+         * };
+         * @endcode
+         */
+        std::function<void()> on_drain;
+
+        /**
+         * Adds the listener function to 'on_close'.
+         * This event will be triggered when socket is closed.
+         *
+         * @par Example
+         * @code
+         * tcp_remote_c client;
+         * client.on_close = [&]() {
+         *      // your code...
+         * };
+         * @endcode
+         */
+        std::function<void()> on_close;
+
+        /**
+         * Adds the listener function to 'on_error'.
+         * This event will be triggered when any error has been returned by asio.
+         *
+         * @par Example
+         * @code
+         * tcp_remote_c client;
+         * client.on_error = [&](const asio::error_code &ec) {
+         *      // your code...
+         * };
+         * @endcode
+         */
+        std::function<void(const asio::error_code &)> on_error;
+
+    private:
+        connection_id_t id = 0;
+        std::mutex mutex_error;
+        tcp::socket socket;
+        send_queue_c<tcp::socket> send_queue{socket};
+        wheel_timer_c idle_timer;
+        uint16_t idle_timeout_seconds = 0;
+        frame_codec_c codec;
+        std::atomic<bool> reading_paused = false;
+        bool read_parked = false;
+        asio::error_code error_code;
+        pooled_streambuf_c recv_buffer{buffer_pool_c::get(socket.get_executor())};
+#ifdef ASIO_HAS_CO_AWAIT
+        bool awaiting_reads = false;
+        asio::steady_timer read_signal{socket.get_executor()};
+        std::deque<std::vector<uint8_t>> read_queue;
+        asio::error_code read_error;
+
+        void wake_readers(const asio::error_code &error) {
+            read_error = error;
+            read_signal.cancel();
+        }
+#endif
+
+        void start_idle_timer() {
+            if (idle_timeout_seconds == 0)
+                return;
+
+            idle_timer.start(std::chrono::seconds(idle_timeout_seconds), [&]() {
+                close();
+            });
+        }
+
+        void reset_idle_timer() {
+            if (idle_timeout_seconds == 0)
+                return;
+
+            idle_timer.refresh();
+        }
+
+        bool push_frame(const uint8_t *data, const size_t size, const std::function<void(const asio::error_code &, const size_t)> &callback) {
+            std::vector<uint8_t> frame = send_queue.acquire(codec.overhead() + size);
+            if (!codec.encode(data, size, frame))
+                return false;
+
+            send_queue.push(std::move(frame), callback);
+            return true;
+        }
+
+        void dispatch_frame(const uint8_t *data, const size_t size) {
+#ifdef ASIO_HAS_CO_AWAIT
+            if (awaiting_reads) {
+                read_queue.emplace_back(data, data + size);
+                read_signal.cancel();
+                return;
+            }
+#endif
+            if (on_frame) {
+                on_frame(data, size);
+                return;
+            }
+            if (on_message_received)
+                on_message_received(std::vector<uint8_t>(data, data + size), size);
+        }
+
+        // Deliver every complete message in the receive buffer. Returns false if the peer broke the framing.
+        bool read_frames() {
+            asio::error_code ec;
+            const size_t consumed = codec.decode(static_cast<const uint8_t *>(recv_buffer.data().data()), recv_buffer.size(),
+                                                 [&](const uint8_t *data, const size_t size) {
+                                                     dispatch_frame(data, size);
+                                                 }, ec);
+            recv_buffer.consume(consumed);
+            if (!ec)
+                return true;
+
+            idle_timer.cancel();
+#ifdef ASIO_HAS_CO_AWAIT
+            wake_readers(ec);
+#endif
+            {
+                std::lock_guard guard(mutex_error);
+                error_code = ec;
+            }
+            if (on_error)
+                on_error(ec);
+            close();
+            return false;
+        }
+
+        // Re-arm the read unless reading is paused, in which case 'resume_reading()' does it
+        void read_next() {
+            if (reading_paused.load()) {
+                read_parked = true;
+                return;
+            }
+            async_read_pooled(socket, recv_buffer,
+                              [&](const asio::error_code &ec, const size_t bytes_received) {
+                                  read_cb(ec, bytes_received);
+                              });
+        }
+
+        void consume_recv_buffer() {
+            const size_t size = recv_buffer.size();
+            if (size > 0)
+                recv_buffer.consume(size);
+        }
+
+        void read_cb(const asio::error_code &error, std::size_t bytes_recvd) {
+            if (error) {
+                idle_timer.cancel();
+#ifdef ASIO_HAS_CO_AWAIT
+                wake_readers(error);
+#endif
+                if (error == asio::error::eof) {
+                    if (on_close)
+                        on_close();
+                    return;
+                }
+                if (on_error)
+                    on_error(error);
+                if (on_close)
+                    on_close();
+                return;
+            }
+
+            reset_idle_timer();
+
+            if (!codec.is_raw()) {
+                if (read_frames())
+                    read_next();
+                return;
+            }
+#ifdef ASIO_HAS_CO_AWAIT
+            if (awaiting_reads) {
+                std::vector<uint8_t> buf(bytes_recvd);
+                asio::buffer_copy(asio::buffer(buf, bytes_recvd),
+                                  recv_buffer.data());
+                read_queue.push_back(std::move(buf));
+                read_signal.cancel();
+                consume_recv_buffer();
+                read_next();
+                return;
+            }
+#endif
+            if (on_data) {
+                const size_t size = recv_buffer.size();
+                const size_t consumed = on_data(static_cast<const uint8_t *>(recv_buffer.data().data()), size);
+                // Bytes left unconsumed stay buffered and are passed again with the next read
+                recv_buffer.consume(std::min(consumed, size));
+            } else {
+                if (on_message_received) {
+                    std::vector<uint8_t> buf;
+                    buf.resize(bytes_recvd);
+                    asio::buffer_copy(asio::buffer(buf, bytes_recvd),
+                                      recv_buffer.data());
+                    on_message_received(buf, bytes_recvd);
+                }
+                consume_recv_buffer();
+            }
+            read_next();
+        }
+    };
+
+#ifdef ENABLE_SSL
+    class tcp_remote_ssl_c {
+    public:
+        tcp_remote_ssl_c(asio::io_context &io_context, asio::ssl::context &ssl_context, const uint16_t timeout = 0,
+                         const framing_t &framing = {})
+            : ssl_socket(asio::make_strand(io_context), ssl_context), idle_timer(io_context, ssl_socket.get_executor()),
+              codec(framing) {
+            idle_timeout_seconds = timeout;
+        }
+
+        ~tcp_remote_ssl_c() {
+            if (ssl_socket.next_layer().is_open())
+                close();
+        }
+
+        /**
+         * Return true if socket is open.
+         *
+         * @par Example
+         * @code
+         * tcp_remote_ssl_c client;
+         * bool is_open = client.is_open();
+         * @endcode
+         */
+        bool is_open() const { return ssl_socket.next_layer().is_open(); }
+
+        /**
+         * Get the local endpoint of the socket. Use this function only after open connection.
+         *
+         * @par Example
+         * @code
+         * tcp_remote_ssl_c client;
+         * asio::ip::tcp::endpoint ep = client.local_endpoint();
+         * @endcode
+         */
+        tcp::endpoint local_endpoint() const { return ssl_socket.next_layer().local_endpoint(); }
+
+        /**
+         * Get the remote endpoint of the socket. Use this function only after open connection.
+         *
+         * @par Example
+         * @code
+         * tcp_remote_ssl_c client;
+         * asio::ip::tcp::endpoint ep = client.remote_endpoint();
+         * @endcode
+         */
+        tcp::endpoint remote_endpoint() const { return ssl_socket.next_layer().remote_endpoint(); }
+
+        /// Just ignore this function
+        asio::ssl::stream<tcp::socket> &get_socket() { return ssl_socket; }
+
+        /**
+         * Return the connection id the server gave this client, 0 until it has been accepted.
+         * Unlike the shared_ptr it can be stored anywhere, 'server.find(id)' returns the client while it is connected.
+         *
+         * @par Example
+         * @code
+         * tcp_remote_ssl_c client;
+         * connection_id_t id = client.get_id();
+         * @endcode
+         */
+        connection_id_t get_id() const { return id; }
+
+        /// Set by the server when the connection is accepted.
+        void set_id(const connection_id_t connection_id) { id = connection_id; }
+
+        /**
+         * Return a const ref of the latest error code returned by asio.
+         *
+         * @par Example
+         * @code
+         * tcp_remote_ssl_c client;
+         * asio::error_code ec = client.get_error_code();
+         * @endcode
+         */
+        const asio::error_code &get_error_code() const { return error_code; }
+
+        /**
+         * Sends string data on the socket.
+         * It returns false if socket is closed or if buffer is empty.
+         *
+         * @param message String to be send.
+         *
+         * @param callback An optional callback function may be specified to as a way of reporting DNS errors or for determining when it is safe to reuse the buf object.
+         *
+         * @par Example
+         * @code
+         * tcp_remote_ssl_c client;
+         *
+         * std::string message = "...";
+         * client.write(message);
+         * @endcode
+         */
+        bool write(const std::string &message, const std::function<void(const asio::error_code &, const size_t)> &callback = nullptr) {
+            if (!ssl_socket.next_layer().is_open() || message.empty())
+                return false;
+
+            reset_idle_timer();
+
+            send_queue.push(message.data(), message.size(), callback);
+            return true;
+        }
+
+        /**
+         * Sends buffer data on the socket.
+         * It returns false if socket is closed or if buffer is empty.
+         *
+         * @param buffer String to be send.
+         *
+         * @param callback An optional callback function may be specified to as a way of reporting DNS errors or for determining when it is safe to reuse the buf object.
+         *
+         * @par Example
+         * @code
+         * tcp_remote_ssl_c client;
+         *
+         * std::vector<uint8_t> buffer = { 0, 1, 2, ... };
+         * client.write_buffer(buffer);
+         * @endcode
+         */
+        bool write_buffer(const std::vector<uint8_t> &buffer, const std::function<void(const asio::error_code &, const size_t)> &callback = nullptr) {
+            if (!ssl_socket.next_layer().is_open() || buffer.empty())
+                return false;
+
+            reset_idle_timer();
+
+            send_queue.push(buffer.data(), buffer.size(), callback);
+            return true;
+        }
+
+        /**
+         * Sends string data on the socket as one message of the configured framing.
+         * The length prefix or delimiter is added for you. It returns false if socket is closed, if message is empty
+         * or if it does not fit the framing.
+         *
+         * @param message String to be send.
+         *
+         * @param callback An optional callback function may be specified to as a way of reporting DNS errors or for determining when it is safe to reuse the buf object.
+         *
+         * @par Example
+         * @code
+         * tcp_remote_ssl_c client;
+         *
+         * std::string message = "...";
+         * client.write_frame(message);
+         * @endcode
+         */
+        bool write_frame(const std::string &message, const std::function<void(const asio::error_code &, const size_t)> &callback = nullptr) {
+            if (!ssl_socket.next_layer().is_open() || message.empty())
+                return false;
+
+            reset_idle_timer();
+
+            return push_frame(reinterpret_cast<const uint8_t *>(message.data()), message.size(), callback);
+        }
+
+        /**
+         * Sends buffer data on the socket as one message of the configured framing.
+         * The length prefix or delimiter is added for you. It returns false if socket is closed, if buffer is empty
+         * or if it does not fit the framing.
+         *
+         * @param buffer Buffer to be send.
+         *
+         * @param callback An optional callback function may be specified to as a way of reporting DNS errors or for determining when it is safe to reuse the buf object.
+         *
+         * @par Example
+         * @code
+         * tcp_remote_ssl_c client;
+         *
+         * std::vector<uint8_t> buffer = { 0, 1, 2, ... };
+         * client.write_frame_buffer(buffer);
+         * @endcode
+         */
+        bool write_frame_buffer(const std::vector<uint8_t> &buffer, const std::function<void(const asio::error_code &, const size_t)> &callback = nullptr) {
+            if (!ssl_socket.next_layer().is_open() || buffer.empty())
+                return false;
+
+            reset_idle_timer();
+
+            return push_frame(buffer.data(), buffer.size(), callback);
+        }
+
+        /**
+         * Sends an already encoded message shared with other connections, without copying it.
+         * The bytes are written as they are: no framing is added. It returns false if socket is closed or if buffer is empty.
+         *
+         * @param buffer Shared message to be send. It must not be modified while queued.
+         *
+         * @param callback An optional callback function may be specified to as a way of reporting DNS errors or for determining when it is safe to reuse the buf object.
+         *
+         * @par Example
+         * @code
+         * tcp_remote_ssl_c client;
+         *
+         * shared_buffer_t buffer = std::make_shared<const std::vector<uint8_t>>(std::vector<uint8_t>{ 0, 1, 2, ... });
+         * client.write_shared(buffer);
+         * @endcode
+         */
+        bool write_shared(const shared_buffer_t &buffer, const std::function<void(const asio::error_code &, const size_t)> &callback = nullptr) {
+            if (!ssl_socket.next_layer().is_open() || !buffer || buffer->empty())
+                return false;
+
+            reset_idle_timer();
+
+            send_queue.push(buffer, callback);
+            return true;
+        }
+
+#ifndef _WIN32
+        /**
+         * Sends part of a file on the socket, after the data already written.
+         * On Linux plain sockets the bytes go from the page cache to the socket with sendfile(2) and never enter user space.
+         * TLS connections, and other platforms, read the file in chunks.
+         * It returns false if socket is closed or if the file cannot be opened.
+         *
+         * @param path Path of the file to be send.
+         *
+         * @param offset First byte of the file to send.
+         *
+         * @param length Number of bytes to send. 0 sends up to the end of the file.
+         *
+         * @param callback An optional callback function reporting errors and the number of file bytes sent.
+         *
+         * @par Example
+         * @code
+         * tcp_remote_ssl_c client;
+         * client.send_file("artifact.tar.gz");
+         * @endcode
+         */
+        bool send_file(const std::string &path, const uint64_t offset = 0, const uint64_t length = 0,
+                       const std::function<void(const asio::error_code &, const size_t)> &callback = nullptr) {
+            if (!ssl_socket.next_layer().is_open())
+                return false;
+
+            reset_idle_timer();
+
+            return send_queue.push_file(path, offset, length, callback);
+        }
+
+        /**
+         * Sends part of an open file on the socket, after the data already written. See 'send_file(path, ...)'.
+         * The descriptor is not closed and must stay open until the callback has been called.
+         *
+         * @param fd Open file descriptor.
+         *
+         * @param offset First byte of the file to send.
+         *
+         * @param length Number of bytes to send. 0 sends up to the end of the file.
+         *
+         * @param callback An optional callback function reporting errors and the number of file bytes sent.
+         *
+         * @par Example
+         * @code
+         * tcp_remote_ssl_c client;
+         * int fd = open("artifact.tar.gz", O_RDONLY);
+         * client.send_file(fd, 0, 0, [fd](const asio::error_code &ec, const size_t bytes_sent) {
+         *      close(fd);
+         * });
+         * @endcode
+         */
+        bool send_file(const int fd, const uint64_t offset = 0, const uint64_t length = 0,
+                       const std::function<void(const asio::error_code &, const size_t)> &callback = nullptr) {
+            if (!ssl_socket.next_layer().is_open())
+                return false;
+
+            reset_idle_timer();
+
+            return send_queue.push_file(fd, offset, length, callback);
+        }
+#endif
+
+#ifdef ASIO_HAS_CO_AWAIT
+        /**
+         * Return the strand executor of the socket. Coroutines using the awaitable functions must run on it.
+         *
+         * @par Example
+         * @code
+         * server.on_client_accepted = [&](const std::shared_ptr<tcp_remote_ssl_c> &client) {
+         *      asio::co_spawn(client->get_executor(), session(client), asio::detached);
+         * };
+         * @endcode
+         */
+        asio::any_io_executor get_executor() { return ssl_socket.get_executor(); }
+
+        /**
+         * Awaitable version of 'write()'. The message is owned by the coroutine frame until it has been sent.
+         *
+         * @param message String to be send.
+         *
+         * @return A tuple with the error code and the number of bytes sent.
+         *
+         * @par Example
+         * @code
+         * tcp_remote_ssl_c client;
+         *
+         * auto [ec, bytes_sent] = co_await client.async_write("...");
+         * @endcode
+         */
+        asio::awaitable<std::tuple<asio::error_code, size_t>> async_write(const std::string message) {
+            if (!is_open())
+                co_return std::make_tuple(asio::error_code(asio::error::not_connected), size_t(0));
+
+            co_return co_await send_queue.async_push(message.data(), message.size());
+        }
+
+        /**
+         * Awaitable version of 'write_buffer()'. The buffer is owned by the coroutine frame until it has been sent.
+         *
+         * @param buffer Buffer to be send.
+         *
+         * @return A tuple with the error code and the number of bytes sent.
+         *
+         * @par Example
+         * @code
+         * tcp_remote_ssl_c client;
+         *
+         * std::vector<uint8_t> buffer = { 0, 1, 2, ... };
+         * auto [ec, bytes_sent] = co_await client.async_write_buffer(buffer);
+         * @endcode
+         */
+        asio::awaitable<std::tuple<asio::error_code, size_t>> async_write_buffer(const std::vector<uint8_t> buffer) {
+            if (!is_open())
+                co_return std::make_tuple(asio::error_code(asio::error::not_connected), size_t(0));
 
-            asio::async_write(socket,
-                              asio::buffer(message.c_str(), message.size()),
-                              [&, callback](const asio::error_code &ec, const size_t bytes_sent) {
-                                  if (callback) callback(ec, bytes_sent);
-                              });
-            return true;
+            co_return co_await send_queue.async_push(buffer.data(), buffer.size());
         }
 
         /**
-         * Sends buffer data on the socket.
-         * It returns false if socket is closed or if buffer is empty.
-         *
-         * @param buffer String to be send.
+         * Wait for the next message received on the socket.
+         * After the first call, received messages are queued for 'async_read()' instead of being passed to 'on_message_received'.
          *
-         * @param callback An optional callback function may be specified to as a way of reporting DNS errors or for determining when it is safe to reuse the buf object.
+         * @return A tuple with the error code and the message. The error code is set when the connection
+         * has failed or ended and no queued message is left.
          *
          * @par Example
          * @code
-         * tcp_remote_c client;
+         * tcp_remote_ssl_c client;
          *
-         * std::vector<uint8_t> buffer = { 0, 1, 2, ... };
-         * client.write_buffer(buffer);
+         * auto [ec, message] = co_await client.async_read();
          * @endcode
          */
-        bool write_buffer(const std::vector<uint8_t> &buffer, const std::function<void(const asio::error_code &, const size_t)> &callback = nullptr) {
-            if (!socket.is_open() || buffer.empty())
-                return false;
+        asio::awaitable<std::tuple<asio::error_code, std::vector<uint8_t>>> async_read() {
+            awaiting_reads = true;
+            while (read_queue.empty() && !read_error) {
+                asio::error_code ec;
+                read_signal.expires_at(asio::steady_timer::time_point::max());
+                co_await read_signal.async_wait(asio::redirect_error(asio::use_awaitable, ec));
+            }
+            if (read_queue.empty())
+                co_return std::make_tuple(read_error, std::vector<uint8_t>());
 
-            asio::async_write(socket,
-                              asio::buffer(buffer.data(), buffer.size()),
-                              [&, callback](const asio::error_code &ec, const size_t bytes_sent) {
-                                  if (callback) callback(ec, bytes_sent);
-                              });
-            return true;
+            std::vector<uint8_t> message = std::move(read_queue.front());
+            read_queue.pop_front();
+            co_return std::make_tuple(asio::error_code(), std::move(message));
         }
+#endif
 
         /// Ignore this function
         void connect() {
-            asio::async_read(socket,
-                             recv_buffer,
-                             asio::transfer_at_least(1),
-                             [&](const asio::error_code &ec, const size_t bytes_received) {
-                                 read_cb(ec, bytes_received);
-                             });
+            start_idle_timer();
+            ssl_socket.async_handshake(asio::ssl::stream_base::server,
+                                       [&](const asio::error_code &ec) {
+                                           ssl_handshake(ec);
+                                       });
         }
 
         /**
@@ -138,17 +1151,25 @@ namespace internetprotocol {
          *
          * @par Example
          * @code
-         * tcp_remote_c client;
+         * tcp_remote_ssl_c client;
          * client.close();
          * @endcode
          */
         void close() {
-            if (socket.is_open()) {
+            idle_timer.cancel();
+            if (ssl_socket.next_layer().is_open()) {
                 std::lock_guard guard(mutex_error);
-                socket.shutdown(tcp::socket::shutdown_both, error_code);
+                ssl_socket.lowest_layer().shutdown(asio::socket_base::shutdown_both, error_code);
                 if (error_code && on_error)
                     on_error(error_code);
-                socket.close(error_code);
+                ssl_socket.lowest_layer().close(error_code);
+                if (error_code && on_error)
+                    on_error(error_code);
+
+                ssl_socket.shutdown(error_code);
+                if (error_code && on_error)
+                    on_error(error_code);
+                ssl_socket.next_layer().close(error_code);
                 if (error_code && on_error)
                     on_error(error_code);
             }
@@ -157,257 +1178,178 @@ namespace internetprotocol {
         }
 
         /**
-         * Adds the listener function to 'on_message_received'.
-         * This event will be triggered when a message has been received.
+         * Close the connection once every queued write has been sent. 'on_close' event will be triggered.
          *
          * @par Example
          * @code
-         * tcp_remote_c client;
-         * client.on_message_received = [&](const std::vector<uint8_t> &buffer, const size_t bytes_recvd) {
-         *      // your code...
-         * };
+         * tcp_remote_ssl_c client;
+         * client.write("bye");
+         * client.close_after_flush();
          * @endcode
          */
-        std::function<void(const std::vector<uint8_t> &, const size_t)> on_message_received;
+        void close_after_flush() {
+            send_queue.when_flushed([&]() {
+                close();
+            });
+        }
 
         /**
-         * Adds the listener function to 'on_close'.
-         * This event will be triggered when socket is closed.
+         * Set the send queue watermarks in bytes. 'on_backpressure' is triggered when the bytes waiting to be sent
+         * reach 'high', and 'on_drain' once they fall back to 'low' or below. A 'high' of 0 disables them.
+         *
+         * @param high Queued bytes at which the peer is considered to be falling behind.
+         *
+         * @param low Queued bytes at which writing may resume.
          *
          * @par Example
          * @code
-         * tcp_remote_c client;
-         * client.on_close = [&]() {
-         *      // your code...
-         * };
+         * tcp_remote_ssl_c client;
+         * client.set_watermarks(1024 * 1024, 256 * 1024);
          * @endcode
          */
-        std::function<void()> on_close;
+        void set_watermarks(const size_t high, const size_t low) {
+            send_queue.set_watermarks(high, low,
+                                      [&]() {
+                                          if (on_backpressure)
+                                              on_backpressure();
+                                      },
+                                      [&]() {
+                                          if (on_drain)
+                                              on_drain();
+                                      });
+        }
 
         /**
-         * Adds the listener function to 'on_error'.
-         * This event will be triggered when any error has been returned by asio.
+         * Return the number of bytes written and not sent yet.
          *
          * @par Example
          * @code
-         * tcp_remote_c client;
-         * client.on_error = [&](const asio::error_code &ec) {
-         *      // your code...
-         * };
+         * tcp_remote_ssl_c client;
+         * size_t queued = client.get_queued_bytes();
          * @endcode
          */
-        std::function<void(const asio::error_code &)> on_error;
-
-    private:
-        std::mutex mutex_error;
-        tcp::socket socket;
-        asio::error_code error_code;
-        asio::streambuf recv_buffer;
-
-        void consume_recv_buffer() {
-            const size_t size = recv_buffer.size();
-            if (size > 0)
-                recv_buffer.consume(size);
-        }
-
-        void read_cb(const asio::error_code &error, std::size_t bytes_recvd) {
-            if (error) {
-                if (error == asio::error::eof) {
-                    if (on_close)
-                        on_close();
-                    return;
-                }
-                if (on_error)
-                    on_error(error);
-                if (on_close)
-                    on_close();
-                return;
-            }
-
-            if (on_message_received) {
-                std::vector<uint8_t> buf;
-                buf.resize(bytes_recvd);
-                asio::buffer_copy(asio::buffer(buf, bytes_recvd),
-                                  recv_buffer.data());
-                on_message_received(buf, bytes_recvd);
-            }
-
-            consume_recv_buffer();
-            asio::async_read(socket,
-                             recv_buffer,
-                             asio::transfer_at_least(1),
-                             [&](const asio::error_code &ec, const size_t bytes_received) {
-                                 read_cb(ec, bytes_received);
-                             });
-        }
-    };
-
-#ifdef ENABLE_SSL
-    class tcp_remote_ssl_c {
-    public:
-        tcp_remote_ssl_c(asio::io_context &io_context, asio::ssl::context &ssl_context)
-            : ssl_socket(io_context, ssl_context) {
-        }
-
-        ~tcp_remote_ssl_c() {
-            if (ssl_socket.next_layer().is_open())
-                close();
-        }
+        size_t get_queued_bytes() { return send_queue.queued_bytes(); }
 
         /**
-         * Return true if socket is open.
+         * Stop reading from the socket. The read already in progress still completes,
+         * after that nothing more is received until 'resume_reading()' is called.
          *
          * @par Example
          * @code
          * tcp_remote_ssl_c client;
-         * bool is_open = client.is_open();
+         * client.pause_reading();
          * @endcode
          */
-        bool is_open() const { return ssl_socket.next_layer().is_open(); }
+        void pause_reading() { reading_paused.store(true); }
 
         /**
-         * Get the local endpoint of the socket. Use this function only after open connection.
+         * Start reading from the socket again after 'pause_reading()'.
          *
          * @par Example
          * @code
          * tcp_remote_ssl_c client;
-         * asio::ip::tcp::endpoint ep = client.local_endpoint();
+         * client.resume_reading();
          * @endcode
          */
-        tcp::endpoint local_endpoint() const { return ssl_socket.next_layer().local_endpoint(); }
+        void resume_reading() {
+            reading_paused.store(false);
+            asio::post(ssl_socket.get_executor(), [&]() {
+                if (!read_parked)
+                    return;
+
+                read_parked = false;
+                if (ssl_socket.next_layer().is_open())
+                    read_next();
+            });
+        }
 
         /**
-         * Get the remote endpoint of the socket. Use this function only after open connection.
+         * Return true if reading has been paused with 'pause_reading()'.
          *
          * @par Example
          * @code
          * tcp_remote_ssl_c client;
-         * asio::ip::tcp::endpoint ep = client.remote_endpoint();
+         * bool paused = client.is_reading_paused();
          * @endcode
          */
-        tcp::endpoint remote_endpoint() const { return ssl_socket.next_layer().remote_endpoint(); }
-
-        /// Just ignore this function
-        asio::ssl::stream<tcp::socket> &get_socket() { return ssl_socket; }
+        bool is_reading_paused() const { return reading_paused.load(); }
 
         /**
-         * Return a const ref of the latest error code returned by asio.
+         * Adds the listener function to 'on_message_received'.
+         * This event will be triggered when a message has been received.
          *
          * @par Example
          * @code
          * tcp_remote_ssl_c client;
-         * asio::error_code ec = client.get_error_code();
+         * client.on_message_received = [&](const std::vector<uint8_t> &buffer, const size_t bytes_recvd) {
+         *      // your code...
+         * };
          * @endcode
          */
-        const asio::error_code &get_error_code() const { return error_code; }
+        std::function<void(const std::vector<uint8_t> &, const size_t)> on_message_received;
 
         /**
-         * Sends string data on the socket.
-         * It returns false if socket is closed or if buffer is empty.
-         *
-         * @param message String to be send.
-         *
-         * @param callback An optional callback function may be specified to as a way of reporting DNS errors or for determining when it is safe to reuse the buf object.
+         * Adds the listener function to 'on_data'. When set, it is called instead of 'on_message_received'.
+         * It is not called when the server uses a framing other than RAW, see 'on_frame'.
+         * It receives a read-only view of the receive buffer, without copying it, and returns how many bytes it consumed.
+         * Bytes left unconsumed stay buffered and are passed again, followed by the new data, on the next read.
+         * The view is only valid during the call.
          *
          * @par Example
          * @code
          * tcp_remote_ssl_c client;
-         *
-         * std::string message = "...";
-         * client.write(message);
+         * client.on_data = [&](const uint8_t *data, const size_t size) -> size_t {
+         *      // your code...
+         *      return size;
+         * };
          * @endcode
          */
-        bool write(const std::string &message, const std::function<void(const asio::error_code &, const size_t)> &callback = nullptr) {
-            if (!ssl_socket.next_layer().is_open() || message.empty())
-                return false;
-
-            asio::async_write(ssl_socket,
-                              asio::buffer(message.c_str(), message.size()),
-                              [&](const asio::error_code &ec, const size_t bytes_sent) {
-                                  if (callback) callback(ec, bytes_sent);
-                              });
-            return true;
-        }
+        std::function<size_t(const uint8_t *, const size_t)> on_data;
 
         /**
-         * Sends buffer data on the socket.
-         * It returns false if socket is closed or if buffer is empty.
-         *
-         * @param buffer String to be send.
-         *
-         * @param callback An optional callback function may be specified to as a way of reporting DNS errors or for determining when it is safe to reuse the buf object.
+         * Adds the listener function to 'on_frame'.
+         * When framing is enabled, this event is triggered once per complete message with a read-only view of it
+         * inside the receive buffer, without copying it. The view is only valid during the call.
+         * If it is not set, each message is copied and passed to 'on_message_received' instead.
          *
          * @par Example
          * @code
          * tcp_remote_ssl_c client;
-         *
-         * std::vector<uint8_t> buffer = { 0, 1, 2, ... };
-         * client.write_buffer(buffer);
+         * client.on_frame = [&](const uint8_t *data, const size_t size) {
+         *      // your code...
+         * };
          * @endcode
          */
-        bool write_buffer(const std::vector<uint8_t> &buffer, const std::function<void(const asio::error_code &, const size_t)> &callback = nullptr) {
-            if (!ssl_socket.next_layer().is_open() || buffer.empty())
-                return false;
-
-            asio::async_write(ssl_socket,
-                              asio::buffer(buffer.data(), buffer.size()),
-                              [&](const asio::error_code &ec, const size_t bytes_sent) {
-                                  if (callback) callback(ec, bytes_sent);
-                              });
-            return true;
-        }
-
-        /// Ignore this function
-        void connect() {
-            ssl_socket.async_handshake(asio::ssl::stream_base::server,
-                                       [&](const asio::error_code &ec) {
-                                           ssl_handshake(ec);
-                                       });
-        }
+        std::function<void(const uint8_t *, const size_t)> on_frame;
 
         /**
-         * Close the underlying socket and stop listening for data on it. 'on_close' event will be triggered.
+         * Adds the listener function to 'on_backpressure'.
+         * This event will be triggered when the bytes waiting to be sent reach the high watermark, see 'set_watermarks()'.
+         * It runs on the thread that wrote the message.
          *
          * @par Example
          * @code
          * tcp_remote_ssl_c client;
-         * client.close();
+         * client.on_backpressure = [&]() {
+         *      // stop writing until 'on_drain'...
+         * };
          * @endcode
          */
-        void close() {
-            if (ssl_socket.next_layer().is_open()) {
-                std::lock_guard guard(mutex_error);
-                ssl_socket.lowest_layer().shutdown(asio::socket_base::shutdown_both, error_code);
-                if (error_code && on_error)
-                    on_error(error_code);
-                ssl_socket.lowest_layer().close(error_code);
-                if (error_code && on_error)
-                    on_error(error_code);
-
-                ssl_socket.shutdown(error_code);
-                if (error_code && on_error)
-                    on_error(error_code);
-                ssl_socket.next_layer().close(error_code);
-                if (error_code && on_error)
-                    on_error(error_code);
-            }
-            if (on_close)
-                on_close();
-        }
+        std::function<void()> on_backpressure;
 
         /**
-         * Adds the listener function to 'on_message_received'.
-         * This event will be triggered when a message has been received.
+         * Adds the listener function to 'on_drain'.
+         * This event will be triggered when the bytes waiting to be sent fall back to the low watermark after 'on_backpressure'.
          *
          * @par Example
          * @code
          * tcp_remote_ssl_c client;
-         * client.on_message_received = [&](const std::vector<uint8_t> &buffer, const size_t bytes_recvd) {
+         * client.on_drain = [&]() {
          *      // your code...
          * };
          * @endcode
          */
-        std::function<void(const std::vector<uint8_t> &, const size_t)> on_message_received;
+        std::function<void()> on_drain;
 
         /**
          * Adds the listener function to 'on_close'.
@@ -438,13 +1380,34 @@ namespace internetprotocol {
         std::function<void(const asio::error_code &)> on_error;
 
     private:
+        connection_id_t id = 0;
         std::mutex mutex_error;
         asio::ssl::stream<tcp::socket> ssl_socket;
+        send_queue_c<asio::ssl::stream<tcp::socket>> send_queue{ssl_socket, true};
+        wheel_timer_c idle_timer;
+        uint16_t idle_timeout_seconds = 0;
+        frame_codec_c codec;
+        std::atomic<bool> reading_paused = false;
+        bool read_parked = false;
         asio::error_code error_code;
-        asio::streambuf recv_buffer;
+        pooled_streambuf_c recv_buffer{buffer_pool_c::get(ssl_socket.get_executor())};
+#ifdef ASIO_HAS_CO_AWAIT
+        bool awaiting_reads = false;
+        asio::steady_timer read_signal{ssl_socket.get_executor()};
+        std::deque<std::vector<uint8_t>> read_queue;
+        asio::error_code read_error;
+
+        void wake_readers(const asio::error_code &error) {
+            read_error = error;
+            read_signal.cancel();
+        }
+#endif
 
         void ssl_handshake(const asio::error_code &error) {
             if (error) {
+#ifdef ASIO_HAS_CO_AWAIT
+                wake_readers(error);
+#endif
                 std::lock_guard guard(mutex_error);
                 error_code = error;
                 if (on_error) on_error(error);
@@ -453,12 +1416,88 @@ namespace internetprotocol {
             }
 
             consume_recv_buffer();
-            asio::async_read(ssl_socket,
-                             recv_buffer,
-                             asio::transfer_at_least(1),
-                             [&](const asio::error_code &ec, const size_t bytes_received) {
-                                 read_cb(ec, bytes_received);
-                             });
+            async_read_pooled(ssl_socket, recv_buffer,
+                              [&](const asio::error_code &ec, const size_t bytes_received) {
+                                  read_cb(ec, bytes_received);
+                              });
+        }
+
+        void start_idle_timer() {
+            if (idle_timeout_seconds == 0)
+                return;
+
+            idle_timer.start(std::chrono::seconds(idle_timeout_seconds), [&]() {
+                close();
+            });
+        }
+
+        void reset_idle_timer() {
+            if (idle_timeout_seconds == 0)
+                return;
+
+            idle_timer.refresh();
+        }
+
+        bool push_frame(const uint8_t *data, const size_t size, const std::function<void(const asio::error_code &, const size_t)> &callback) {
+            std::vector<uint8_t> frame = send_queue.acquire(codec.overhead() + size);
+            if (!codec.encode(data, size, frame))
+                return false;
+
+            send_queue.push(std::move(frame), callback);
+            return true;
+        }
+
+        void dispatch_frame(const uint8_t *data, const size_t size) {
+#ifdef ASIO_HAS_CO_AWAIT
+            if (awaiting_reads) {
+                read_queue.emplace_back(data, data + size);
+                read_signal.cancel();
+                return;
+            }
+#endif
+            if (on_frame) {
+                on_frame(data, size);
+                return;
+            }
+            if (on_message_received)
+                on_message_received(std::vector<uint8_t>(data, data + size), size);
+        }
+
+        // Deliver every complete message in the receive buffer. Returns false if the peer broke the framing.
+        bool read_frames() {
+            asio::error_code ec;
+            const size_t consumed = codec.decode(static_cast<const uint8_t *>(recv_buffer.data().data()), recv_buffer.size(),
+                                                 [&](const uint8_t *data, const size_t size) {
+                                                     dispatch_frame(data, size);
+                                                 }, ec);
+            recv_buffer.consume(consumed);
+            if (!ec)
+                return true;
+
+            idle_timer.cancel();
+#ifdef ASIO_HAS_CO_AWAIT
+            wake_readers(ec);
+#endif
+            {
+                std::lock_guard guard(mutex_error);
+                error_code = ec;
+            }
+            if (on_error)
+                on_error(ec);
+            close();
+            return false;
+        }
+
+        // Re-arm the read unless reading is paused, in which case 'resume_reading()' does it
+        void read_next() {
+            if (reading_paused.load()) {
+                read_parked = true;
+                return;
+            }
+            async_read_pooled(ssl_socket, recv_buffer,
+                              [&](const asio::error_code &ec, const size_t bytes_received) {
+                                  read_cb(ec, bytes_received);
+                              });
         }
 
         void consume_recv_buffer() {
@@ -469,6 +1508,10 @@ namespace internetprotocol {
 
         void read_cb(const asio::error_code &error, std::size_t bytes_recvd) {
             if (error) {
+                idle_timer.cancel();
+#ifdef ASIO_HAS_CO_AWAIT
+                wake_readers(error);
+#endif
                 if (error == asio::error::eof) {
                     close();
                     if (on_close) on_close();
@@ -480,21 +1523,41 @@ namespace internetprotocol {
                 return;
             }
 
-            if (on_message_received) {
-                std::vector<uint8_t> buf;
-                buf.resize(bytes_recvd);
+            reset_idle_timer();
+
+            if (!codec.is_raw()) {
+                if (read_frames())
+                    read_next();
+                return;
+            }
+#ifdef ASIO_HAS_CO_AWAIT
+            if (awaiting_reads) {
+                std::vector<uint8_t> buf(bytes_recvd);
                 asio::buffer_copy(asio::buffer(buf, bytes_recvd),
                                   recv_buffer.data());
-                on_message_received(buf, bytes_recvd);
+                read_queue.push_back(std::move(buf));
+                read_signal.cancel();
+                consume_recv_buffer();
+                read_next();
+                return;
             }
-
-            consume_recv_buffer();
-            asio::async_read(ssl_socket,
-                             recv_buffer,
-                             asio::transfer_at_least(1),
-                             [&](const asio::error_code &ec, const size_t bytes_received) {
-                                 read_cb(ec, bytes_received);
-                             });
+#endif
+            if (on_data) {
+                const size_t size = recv_buffer.size();
+                const size_t consumed = on_data(static_cast<const uint8_t *>(recv_buffer.data().data()), size);
+                // Bytes left unconsumed stay buffered and are passed again with the next read
+                recv_buffer.consume(std::min(consumed, size));
+            } else {
+                if (on_message_received) {
+                    std::vector<uint8_t> buf;
+                    buf.resize(bytes_recvd);
+                    asio::buffer_copy(asio::buffer(buf, bytes_recvd),
+                                      recv_buffer.data());
+                    on_message_received(buf, bytes_recvd);
+                }
+                consume_recv_buffer();
+            }
+            read_next();
         }
     };
 #endif
@@ -13,12 +13,54 @@ namespace internetprotocol {
     public:
         tcp_server_c() {}
 
+        /**
+         * Construct the server on a runtime instead of the default one.
+         * Every run loop of the server (io_threads per shard) occupies one runtime thread while the server is open.
+         * 'open()' fails with 'invalid_argument' if the runtime has fewer threads than shards * io_threads.
+         *
+         * @param runtime Runtime hosting the server run loops. Must outlive the server.
+         *
+         * @par Example
+         * @code
+         * runtime_c runtime({ 4, "server", { 0xF0 } });
+         * tcp_server_c server(runtime);
+         * @endcode
+         */
+        explicit tcp_server_c(runtime_c &runtime): runtime(runtime) {}
+
         ~tcp_server_c() {
-            if (net.acceptor.is_open()) {
+            if (net.acceptor.is_open() || draining.load()) {
                 close();
             }
         }
 
+        /**
+         * Set/Get the idle timeout for the connection in seconds.
+         * A connection with no read or write during that time is closed. A value of 0 disables the idle timeout.
+         *
+         * @par Example
+         * @code
+         * tcp_server_c server;
+         * // Close clients silent for 30 seconds
+         * server.idle_timeout = 30;
+         * @endcode
+         */
+        uint16_t idle_timeout = 0;
+
+        /**
+         * Set/Get how the byte stream of each client is split into messages. Applied to clients accepted after it is set.
+         * With a framing other than RAW, each complete message is passed to the client 'on_frame' or 'on_message_received'.
+         *
+         * @par Example
+         * @code
+         * tcp_server_c server;
+         * // Newline-terminated messages
+         * server.framing.type = DELIMITED;
+         * server.framing.delimiter = "\r\n";
+         * @endcode
+         */
+        framing_t framing;
+
         /**
          * Set/Get the maximum number of simultaneous client connections the server will accept in queue.
          *
@@ -39,6 +81,23 @@ namespace internetprotocol {
          */
         int backlog = 2147483647;
 
+        /**
+         * Set/Get the number of threads running the server io_context.
+         *
+         * Every accepted connection is bound to its own strand, so the handlers of a single
+         * connection never run concurrently even when io_threads is greater than 1.
+         * Values lower than 1 are treated as 1. Must be set before 'open()'.
+         *
+         * @par Example
+         * @code
+         * tcp_server_c server;
+         * // Spread accepts, reads and callbacks over 4 threads
+         * server.io_threads = 4;
+         * server.open({"", 8080});
+         * @endcode
+         */
+        uint16_t io_threads = 1;
+
         /**
          * Return true if socket is open.
          *
@@ -62,13 +121,13 @@ namespace internetprotocol {
         tcp::endpoint local_endpoint() const { return net.acceptor.local_endpoint(); }
 
         /**
-         * Gets a constant reference to the set of clients connected to the server.
+         * Gets a copy of the set of clients connected to the server.
          *
          * This method returns a std::set containing shared pointers to all tcp_remote_c
-         * clients currently connected to the server. Useful for monitoring active
+         * clients currently connected to the server, across every shard. Useful for monitoring active
          * connections or performing operations on all connected clients.
          *
-         * @return A constant reference to the std::set of connected clients.
+         * @return A std::set with the connected clients.
          *
          * @par Example
          * @code
@@ -85,7 +144,131 @@ namespace internetprotocol {
          * }
          * @endcode
          */
-        const std::set<std::shared_ptr<tcp_remote_c>> &clients() const { return net.clients; }
+        std::set<std::shared_ptr<tcp_remote_c>> clients() {
+            std::set<std::shared_ptr<tcp_remote_c>> all_clients;
+            for_each([&](const std::shared_ptr<tcp_remote_c> &client) {
+                all_clients.insert(client);
+            });
+            return all_clients;
+        }
+
+        /**
+         * Return the client with the connection id 'id', or nullptr if it is no longer connected.
+         * The lookup is O(1) and thread-safe. The id of a client is returned by its 'get_id()'.
+         *
+         * @par Example
+         * @code
+         * tcp_server_c server;
+         *
+         * std::shared_ptr<tcp_remote_c> client = server.find(id);
+         * if (client)
+         *     client->write("...");
+         * @endcode
+         */
+        std::shared_ptr<tcp_remote_c> find(const connection_id_t id) {
+            tcp_server_t<tcp_remote_c> *shard = shard_of(id);
+            if (!shard)
+                return nullptr;
+
+            std::lock_guard guard(shard->clients_mutex);
+            return shard->clients.find(id);
+        }
+
+        /**
+         * Call 'fn' for every connected client, across every shard.
+         * The clients are collected under the registry locks and 'fn' runs after they are released,
+         * so it may write to or close the clients.
+         *
+         * @par Example
+         * @code
+         * tcp_server_c server;
+         *
+         * server.for_each([&](const std::shared_ptr<tcp_remote_c> &client) {
+         *     // your code...
+         * });
+         * @endcode
+         */
+        void for_each(const std::function<void(const std::shared_ptr<tcp_remote_c> &)> &fn) {
+            std::vector<std::shared_ptr<tcp_remote_c>> all_clients;
+            {
+                std::lock_guard guard(net.clients_mutex);
+                all_clients.reserve(net.clients.size());
+                net.clients.for_each([&](const std::shared_ptr<tcp_remote_c> &client) { all_clients.push_back(client); });
+            }
+            for (const std::unique_ptr<tcp_server_t<tcp_remote_c>> &shard : net.shards) {
+                std::lock_guard guard(shard->clients_mutex);
+                shard->clients.for_each([&](const std::shared_ptr<tcp_remote_c> &client) { all_clients.push_back(client); });
+            }
+            for (const std::shared_ptr<tcp_remote_c> &client : all_clients)
+                fn(client);
+        }
+
+        /**
+         * Run 'fn' on the strand of the client with the connection id 'id', so it never races the client's own handlers.
+         * It can be called from any thread. It returns false if the client is no longer connected.
+         *
+         * @par Example
+         * @code
+         * tcp_server_c server;
+         *
+         * server.post_to(id, [](const std::shared_ptr<tcp_remote_c> &client) {
+         *     // your code...
+         * });
+         * @endcode
+         */
+        bool post_to(const connection_id_t id, const std::function<void(const std::shared_ptr<tcp_remote_c> &)> &fn) {
+            std::shared_ptr<tcp_remote_c> client = find(id);
+            if (!client || !fn)
+                return false;
+
+            asio::post(client->get_socket().get_executor(), [client, fn]() {
+                fn(client);
+            });
+            return true;
+        }
+
+        /**
+         * Sends the same message to every connected client, or to those 'filter' returns true for.
+         * The message is encoded once, with the server 'framing' when it is not RAW, and the same immutable buffer
+         * is queued on every client, without copying it. Each shard walks its own clients on its own run loop,
+         * so the fan-out is spread over the shards and this call returns without waiting for it. 'filter' runs on those run loops.
+         * It returns false if the server is closed, if message is empty or if it does not fit the framing.
+         *
+         * @param message String to be send.
+         *
+         * @param filter Optional predicate selecting the clients to send to.
+         *
+         * @par Example
+         * @code
+         * tcp_server_c server;
+         *
+         * server.broadcast("tick\n", [](const std::shared_ptr<tcp_remote_c> &client) {
+         *     return !client->is_reading_paused();
+         * });
+         * @endcode
+         */
+        bool broadcast(const std::string &message, const std::function<bool(const std::shared_ptr<tcp_remote_c> &)> &filter = nullptr) {
+            return broadcast_frame(reinterpret_cast<const uint8_t *>(message.data()), message.size(), filter);
+        }
+
+        /**
+         * Sends the same buffer to every connected client, or to those 'filter' returns true for. See 'broadcast()'.
+         *
+         * @param buffer Buffer to be send.
+         *
+         * @param filter Optional predicate selecting the clients to send to.
+         *
+         * @par Example
+         * @code
+         * tcp_server_c server;
+         *
+         * std::vector<uint8_t> buffer = { 0, 1, 2, ... };
+         * server.broadcast_buffer(buffer);
+         * @endcode
+         */
+        bool broadcast_buffer(const std::vector<uint8_t> &buffer, const std::function<bool(const std::shared_ptr<tcp_remote_c> &)> &filter = nullptr) {
+            return broadcast_frame(buffer.data(), buffer.size(), filter);
+        }
 
         /**
          * Return a const ref of the latest error code returned by asio.
@@ -122,52 +305,102 @@ namespace internetprotocol {
          * @endcode
          */
         bool open(const server_bind_options_t &bind_opts = { "", 8080, v4, true }) {
-            if (net.acceptor.is_open())
+            if (net.acceptor.is_open() || draining.load())
                 return false;
 
-            net.acceptor.open(bind_opts.protocol == v4
-                                  ? tcp::v4()
-                                  : tcp::v6(),
-                                  error_code);
+            bind_options = bind_opts;
+            admission.reset(bind_opts.admission);
 
-            if (error_code && on_error) {
-                std::lock_guard guard(mutex_error);
-                on_error(error_code);
+            const bool listening = bind_opts.listen_handles.empty() ? bind_listeners(bind_opts) : adopt_listeners(bind_opts);
+            if (!listening)
                 return false;
-            }
 
-            net.acceptor.set_option(asio::socket_base::reuse_address(bind_opts.reuse_address), error_code);
-            if (error_code && on_error) {
+            // Every run loop blocks a runtime thread until the server closes, a loop with no thread left never runs
+            const uint16_t threads = io_threads > 0 ? io_threads : 1;
+            if (runtime.thread_count() < threads * (net.shards.size() + 1)) {
+                asio::error_code ec;
+                net.acceptor.close(ec);
+                net.shards.clear();
                 std::lock_guard guard(mutex_error);
-                on_error(error_code);
+                error_code = asio::error::invalid_argument;
+                if (on_error) on_error(error_code);
                 return false;
             }
 
-            const tcp::endpoint endpoint = bind_opts.address.empty() ?
-                                        tcp::endpoint(bind_opts.protocol == v4
-                                                        ? tcp::v4()
-                                                        : tcp::v6(),
-                                                        bind_opts.port) :
-                                        tcp::endpoint(make_address(bind_opts.address), bind_opts.port);
+            if (on_listening)
+                on_listening();
 
-            net.acceptor.bind(endpoint, error_code);
-            if (error_code && on_error) {
-                std::lock_guard guard(mutex_error);
-                on_error(error_code);
-                return false;
-            }
+            error_code.clear();
+            running_threads.store(static_cast<uint32_t>(threads * (net.shards.size() + 1)));
+            start_shard(net, threads);
+            for (const std::unique_ptr<tcp_server_t<tcp_remote_c>> &shard : net.shards)
+                start_shard(*shard, threads);
+            return true;
+        }
 
-            net.acceptor.listen(backlog, error_code);
-            if (error_code && on_error) {
-                std::lock_guard guard(mutex_error);
-                on_error(error_code);
-                return false;
+        /**
+         * Return the listening sockets of every shard, to hand them over to the process replacing this one
+         * with 'listen_handoff_c' or 'export_listen_handles()'. They stay owned by the server, the other process gets copies
+         * and keeps accepting on them after this server closes. Empty if the server is not open.
+         *
+         * @par Example
+         * @code
+         * tcp_server_c server;
+         * std::vector<tcp::acceptor::native_handle_type> handles = server.listen_handles();
+         * @endcode
+         */
+        std::vector<tcp::acceptor::native_handle_type> listen_handles() {
+            std::vector<tcp::acceptor::native_handle_type> handles;
+            if (!net.acceptor.is_open())
+                return handles;
+
+            handles.push_back(net.acceptor.native_handle());
+            for (const std::unique_ptr<tcp_server_t<tcp_remote_c>> &shard : net.shards) {
+                if (shard->acceptor.is_open())
+                    handles.push_back(shard->acceptor.native_handle());
             }
+            return handles;
+        }
 
-            if (on_listening)
-                on_listening();
+        /**
+         * Stop accepting and let the connected clients finish before closing. 'on_close' event will be triggered once every client is gone.
+         * Every client finishes sending what it has queued, then its sending side is shut down and it closes once the peer closes its side.
+         * Clients still connected when 'timeout' expires are closed. Returns false if the server is not open or is already draining.
+         *
+         * @param timeout Time given to the clients to finish.
+         *
+         * @par Example
+         * @code
+         * tcp_server_c server;
+         * server.on_close = [&]() {
+         *      // every client has been disconnected
+         * };
+         * server.drain(std::chrono::seconds(30));
+         * @endcode
+         */
+        bool drain(const std::chrono::steady_clock::duration timeout) {
+            if (!net.acceptor.is_open() || draining.exchange(true))
+                return false;
 
-            asio::post(thread_pool, [&]{ run_context_thread(); });
+            {
+                std::lock_guard guard(mutex_drain);
+                drain_timer.expires_after(timeout);
+                drain_timer.async_wait([&](const asio::error_code &ec) {
+                    if (!ec && draining.load())
+                        drain_expired();
+                });
+            }
+            for (const std::unique_ptr<tcp_server_t<tcp_remote_c>> &shard : net.shards)
+                stop_accepting(*shard);
+            stop_accepting(net);
+            for_each([](const std::shared_ptr<tcp_remote_c> &client) {
+                asio::post(client->get_socket().get_executor(), [client]() {
+                    client->close_after_flush();
+                });
+            });
+            // Clients closing from now on cancel the deadline when they are the last one
+            if (admission.live_connections() == 0)
+                cancel_drain_timer();
             return true;
         }
 
@@ -177,29 +410,18 @@ namespace internetprotocol {
          * @par Example
          * @code
          * tcp_server_c server;
-         * server.close(false);
+         * server.close();
          * @endcode
          */
         void close() {
             is_closing.store(true);
-            if (net.acceptor.is_open()) {
-                std::lock_guard guard(mutex_error);
-                net.acceptor.close(error_code);
-                if (on_error) on_error(error_code);
-            }
-            if (!net.clients.empty()) {
-                std::lock_guard guard(mutex_error);
-                for (const auto &client : net.clients) {
-                    if (client)
-                        client->close();
-                }
-                net.clients.clear();
-            }
-            net.context.stop();
-            net.context.restart();
-            net.acceptor = tcp::acceptor(net.context);
+            cancel_drain_timer();
+            for (const std::unique_ptr<tcp_server_t<tcp_remote_c>> &shard : net.shards)
+                close_shard(*shard);
+            close_shard(net);
             if (on_close)
                 on_close();
+            draining.store(false);
             is_closing.store(false);
         }
 
@@ -260,57 +482,385 @@ namespace internetprotocol {
         std::function<void(const asio::error_code &)> on_error;
 
     private:
-        std::mutex mutex_io;
         std::mutex mutex_error;
+        runtime_c &runtime = default_runtime();
         std::atomic<bool> is_closing = false;
+        std::atomic<uint32_t> running_threads = 0;
         tcp_server_t<tcp_remote_c> net;
         asio::error_code error_code;
+        server_bind_options_t bind_options;
+        admission_control_c admission;
+        std::atomic<bool> draining = false;
+        std::mutex mutex_drain;
+        asio::steady_timer drain_timer{net.context};
 
-        void run_context_thread() {
-            std::lock_guard guard(mutex_io);
-            error_code.clear();
-            std::shared_ptr<tcp_remote_c> client_socket = std::make_shared<tcp_remote_c>(net.context);
-            net.acceptor.async_accept(client_socket->get_socket(),
+        bool broadcast_frame(const uint8_t *data, const size_t size, const std::function<bool(const std::shared_ptr<tcp_remote_c> &)> &filter) {
+            if (!net.acceptor.is_open() || size == 0)
+                return false;
+
+            std::vector<uint8_t> payload;
+            if (!frame_codec_c(framing).encode(data, size, payload))
+                return false;
+            const shared_buffer_t shared = std::make_shared<const std::vector<uint8_t>>(std::move(payload));
+            fan_out(net, shared, filter);
+            for (const std::unique_ptr<tcp_server_t<tcp_remote_c>> &shard : net.shards)
+                fan_out(*shard, shared, filter);
+            return true;
+        }
+
+        // Shard that handed out 'id', see connection_id_t
+        tcp_server_t<tcp_remote_c> *shard_of(const connection_id_t id) {
+            const uint16_t index = connection_shard(id);
+            if (index == 0)
+                return &net;
+            if (index > net.shards.size())
+                return nullptr;
+            return net.shards[index - 1].get();
+        }
+
+        // Queue 'buffer' on the clients of 'shard' from its own run loop
+        void fan_out(tcp_server_t<tcp_remote_c> &shard, const shared_buffer_t &buffer, const std::function<bool(const std::shared_ptr<tcp_remote_c> &)> &filter) {
+            asio::post(shard.context, [&shard, buffer, filter]() {
+                std::vector<std::shared_ptr<tcp_remote_c>> targets;
+                {
+                    std::lock_guard guard(shard.clients_mutex);
+                    targets.reserve(shard.clients.size());
+                    shard.clients.for_each([&](const std::shared_ptr<tcp_remote_c> &client) { targets.push_back(client); });
+                }
+                for (const std::shared_ptr<tcp_remote_c> &client : targets) {
+                    if (!filter || filter(client))
+                        client->write_shared(buffer);
+                }
+            });
+        }
+
+        void run_context_thread(tcp_server_t<tcp_remote_c> &shard) {
+            run_context(shard.context, bind_options.busy_poll_us);
+            if (running_threads.fetch_sub(1) == 1 && !is_closing.load())
+                close();
+        }
+
+        // Open and bind the acceptor of every shard
+        bool bind_listeners(const server_bind_options_t &bind_opts) {
+            const tcp::endpoint endpoint = bind_opts.address.empty() ?
+                                        tcp::endpoint(bind_opts.protocol == v4
+                                                        ? tcp::v4()
+                                                        : tcp::v6(),
+                                                        bind_opts.port) :
+                                        tcp::endpoint(make_address(bind_opts.address), bind_opts.port);
+
+#ifdef SO_REUSEPORT
+            const bool reuse_port = bind_opts.shards > 1;
+#else
+            const bool reuse_port = false;
+#endif
+            if (!open_acceptor(net.acceptor, bind_opts, endpoint, reuse_port))
+                return false;
+
+            net.shards.clear();
+            if (reuse_port) {
+                // Every shard binds the port picked by the first acceptor, so port 0 works too
+                const tcp::endpoint shard_endpoint = net.acceptor.local_endpoint();
+                for (uint16_t i = 1; i < bind_opts.shards; ++i) {
+                    net.shards.push_back(std::make_unique<tcp_server_t<tcp_remote_c>>());
+                    net.shards.back()->clients.set_shard(i);
+                    if (!open_acceptor(net.shards.back()->acceptor, bind_opts, shard_endpoint, reuse_port)) {
+                        asio::error_code ec;
+                        net.acceptor.close(ec);
+                        net.shards.clear();
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+
+        // Serve on sockets that are listening already, one shard each
+        bool adopt_listeners(const server_bind_options_t &bind_opts) {
+            net.shards.clear();
+            for (size_t i = 0; i < bind_opts.listen_handles.size(); ++i) {
+                if (i > 0) {
+                    net.shards.push_back(std::make_unique<tcp_server_t<tcp_remote_c>>());
+                    net.shards.back()->clients.set_shard(static_cast<uint16_t>(i));
+                }
+                tcp::acceptor &acceptor = i == 0 ? net.acceptor : net.shards.back()->acceptor;
+                if (!adopt_acceptor(acceptor, bind_opts.listen_handles[i], backlog, error_code)) {
+                    {
+                        std::lock_guard guard(mutex_error);
+                        if (on_error) on_error(error_code);
+                    }
+                    // The handles belong to the server, close the ones adopted so far and the ones left
+                    asio::error_code ec;
+                    net.acceptor.close(ec);
+                    net.shards.clear();
+                    for (size_t j = i; j < bind_opts.listen_handles.size(); ++j) {
+                        asio::detail::socket_ops::state_type state = 0;
+                        asio::detail::socket_ops::close(bind_opts.listen_handles[j], state, true, ec);
+                    }
+                    return false;
+                }
+                set_busy_poll(acceptor, bind_opts.so_busy_poll_us);
+                set_listener_options(acceptor, bind_opts.socket_options);
+            }
+            return true;
+        }
+
+        bool open_acceptor(tcp::acceptor &acceptor, const server_bind_options_t &bind_opts,
+                           const tcp::endpoint &endpoint, const bool reuse_port) {
+            acceptor.open(bind_opts.protocol == v4
+                          ? tcp::v4()
+                          : tcp::v6(),
+                          error_code);
+            if (error_code) {
+                std::lock_guard guard(mutex_error);
+                if (on_error) on_error(error_code);
+                return false;
+            }
+
+            acceptor.set_option(asio::socket_base::reuse_address(bind_opts.reuse_address), error_code);
+            if (error_code) {
+                std::lock_guard guard(mutex_error);
+                if (on_error) on_error(error_code);
+                return false;
+            }
+            set_busy_poll(acceptor, bind_opts.so_busy_poll_us);
+            set_listener_options(acceptor, bind_opts.socket_options);
+
+#ifdef SO_REUSEPORT
+            if (reuse_port) {
+                acceptor.set_option(reuse_port_t(true), error_code);
+                if (error_code) {
+                    std::lock_guard guard(mutex_error);
+                    if (on_error) on_error(error_code);
+                    return false;
+                }
+            }
+#endif
+
+            acceptor.bind(endpoint, error_code);
+            if (error_code) {
+                std::lock_guard guard(mutex_error);
+                if (on_error) on_error(error_code);
+                return false;
+            }
+
+            acceptor.listen(backlog, error_code);
+            if (error_code) {
+                std::lock_guard guard(mutex_error);
+                if (on_error) on_error(error_code);
+                return false;
+            }
+            return true;
+        }
+
+        // Arm one more accept, with the connection object it will hand the socket to constructed up front.
+        // 'client_socket' reuses the one of a rejected connection.
+        void async_accept(tcp_server_t<tcp_remote_c> &shard, std::shared_ptr<tcp_remote_c> client_socket = nullptr) {
+            const std::chrono::steady_clock::duration delay = admission.reserve_accept();
+            if (delay > std::chrono::steady_clock::duration::zero()) {
+                // Out of accept tokens, arm it once the bucket has refilled
+                std::shared_ptr<asio::steady_timer> timer = std::make_shared<asio::steady_timer>(shard.context, delay);
+                timer->async_wait([&, timer, client_socket](const asio::error_code &ec) {
+                    if (!ec && shard.acceptor.is_open())
+                        async_accept(shard, client_socket);
+                });
+                return;
+            }
+            if (!client_socket)
+                client_socket = std::make_shared<tcp_remote_c>(shard.context, idle_timeout, framing);
+            shard.acceptor.async_accept(client_socket->get_socket(),
                                         [&, client_socket](const asio::error_code &ec) {
-                                            accept(ec, client_socket);
+                                            accept(ec, client_socket, shard);
                                         });
-            net.context.run();
-            if (!is_closing.load())
-                close();
         }
 
-        void accept(const asio::error_code &error, const std::shared_ptr<tcp_remote_c> &client) {
+        void start_shard(tcp_server_t<tcp_remote_c> &shard, const uint16_t threads) {
+            for (uint16_t i = 0; i < std::max<uint16_t>(bind_options.pending_accepts, 1); ++i)
+                async_accept(shard);
+            for (uint16_t i = 0; i < threads; ++i)
+                asio::post(runtime.get_executor(), [&]{ run_context_thread(shard); });
+        }
+
+        void close_shard(tcp_server_t<tcp_remote_c> &shard) {
+            if (shard.acceptor.is_open()) {
+                std::lock_guard guard(mutex_error);
+                shard.acceptor.close(error_code);
+                if (on_error) on_error(error_code);
+            }
+            std::vector<std::shared_ptr<tcp_remote_c>> clients_to_close;
+            {
+                std::lock_guard guard(shard.clients_mutex);
+                clients_to_close = shard.clients.take_all();
+            }
+            if (!clients_to_close.empty()) {
+                std::lock_guard guard(mutex_error);
+                for (const auto &client : clients_to_close) {
+                    if (client)
+                        client->close();
+                }
+            }
+            shard.context.stop();
+            shard.context.restart();
+            shard.acceptor = tcp::acceptor(shard.context);
+        }
+
+        // Close the acceptor of 'shard' and leave its clients connected
+        void stop_accepting(tcp_server_t<tcp_remote_c> &shard) {
+            if (!shard.acceptor.is_open())
+                return;
+            std::lock_guard guard(mutex_error);
+            shard.acceptor.close(error_code);
+            if (error_code && on_error) on_error(error_code);
+        }
+
+        void cancel_drain_timer() {
+            std::lock_guard guard(mutex_drain);
+            drain_timer.cancel();
+        }
+
+        // Drain deadline: close whatever is still connected
+        void drain_expired() {
+            for_each([](const std::shared_ptr<tcp_remote_c> &client) {
+                asio::post(client->get_socket().get_executor(), [client]() {
+                    client->close();
+                });
+            });
+        }
+
+        void accept(const asio::error_code &error, const std::shared_ptr<tcp_remote_c> &client, tcp_server_t<tcp_remote_c> &shard) {
             if (error) {
                 std::lock_guard guard(mutex_error);
                 error_code = error;
                 client->close();
-                if (net.acceptor.is_open()) {
-                    std::shared_ptr<tcp_remote_c> client_socket = std::make_shared<tcp_remote_c>(net.context);
-                    net.acceptor.async_accept(client_socket->get_socket(),
-                                                [&, client_socket](const asio::error_code &ec) {
-                                                    accept(ec, client_socket);
-                                                });
-                }
+                if (shard.acceptor.is_open())
+                    async_accept(shard);
                 return;
             }
-            net.clients.insert(client);
-            client->on_close = [&, client]() { net.clients.erase(client); };
+            asio::error_code endpoint_error;
+            const asio::ip::address address = client->get_socket().remote_endpoint(endpoint_error).address();
+            if (endpoint_error || !admission.admit(address)) {
+                // Over a limit: drop it before anything is set up for it, its remote takes the next connection
+                client->get_socket().close(endpoint_error);
+                if (shard.acceptor.is_open())
+                    async_accept(shard, client);
+                return;
+            }
+            if (bind_options.balance_shards && !net.shards.empty()) {
+                tcp_server_t<tcp_remote_c> &owner = least_loaded_shard(shard);
+                add_client(&owner == &shard ? client : hand_over(client, owner), owner, address);
+            } else {
+                add_client(client, shard, address);
+            }
+            if (shard.acceptor.is_open())
+                async_accept(shard);
+        }
+
+        void add_client(const std::shared_ptr<tcp_remote_c> &client, tcp_server_t<tcp_remote_c> &shard, const asio::ip::address &address) {
+            if (!client) {
+                admission.release(address);
+                return;
+            }
+
+            set_socket_options(client->get_socket(), bind_options.socket_options);
+            client->set_zerocopy_threshold(bind_options.socket_options.zerocopy_threshold);
+            connection_id_t id;
+            {
+                std::lock_guard guard(shard.clients_mutex);
+                id = shard.clients.insert(client);
+            }
+            if (id == 0) {
+                // Registry full: its close could not find it, so its admission slots would never be given back
+                asio::error_code ec;
+                client->get_socket().close(ec);
+                admission.release(address);
+                return;
+            }
+            client->set_id(id);
+            client->on_close = [&, client, address]() {
+                bool registered;
+                {
+                    std::lock_guard guard(shard.clients_mutex);
+                    registered = shard.clients.erase(client->get_id());
+                }
+                // 'on_close' may run more than once, the connection is given back only the first time
+                if (registered) {
+                    admission.release(address);
+                    if (draining.load() && admission.live_connections() == 0)
+                        cancel_drain_timer();
+                }
+            };
             if (on_client_accepted)
                 on_client_accepted(client);
             client->connect();
-            if (net.acceptor.is_open()) {
-                std::shared_ptr<tcp_remote_c> client_socket = std::make_shared<tcp_remote_c>(net.context);
-                net.acceptor.async_accept(client_socket->get_socket(),
-                                        [&, client_socket](const asio::error_code &ec) {
-                                            accept(ec, client_socket);
-                                        });
+            // Accepted while draining, after 'drain()' went over the clients
+            if (draining.load())
+                client->close_after_flush();
+        }
+
+        // Shard with the fewest clients, the accepting one on a tie
+        tcp_server_t<tcp_remote_c> &least_loaded_shard(tcp_server_t<tcp_remote_c> &accepting) {
+            tcp_server_t<tcp_remote_c> *least_loaded = &accepting;
+            size_t least_clients;
+            {
+                std::lock_guard guard(accepting.clients_mutex);
+                least_clients = accepting.clients.size();
+            }
+            const auto consider = [&](tcp_server_t<tcp_remote_c> &shard) {
+                std::lock_guard guard(shard.clients_mutex);
+                if (shard.clients.size() < least_clients) {
+                    least_loaded = &shard;
+                    least_clients = shard.clients.size();
+                }
+            };
+            consider(net);
+            for (const std::unique_ptr<tcp_server_t<tcp_remote_c>> &shard : net.shards)
+                consider(*shard);
+            return *least_loaded;
+        }
+
+        // Move an accepted socket onto the run loops of 'target'. Returns nullptr, with the socket closed, if it was lost on the way.
+        std::shared_ptr<tcp_remote_c> hand_over(const std::shared_ptr<tcp_remote_c> &client, tcp_server_t<tcp_remote_c> &target) {
+            asio::error_code ec;
+            const tcp::endpoint endpoint = client->get_socket().local_endpoint(ec);
+            tcp::socket::native_handle_type handle{};
+            if (!ec)
+                handle = client->get_socket().release(ec);
+            if (ec) {
+                // Still bound to the accepting shard, it cannot be registered in 'target'
+                asio::error_code ignored;
+                client->get_socket().close(ignored);
+                return nullptr;
+            }
+
+            std::shared_ptr<tcp_remote_c> moved = std::make_shared<tcp_remote_c>(target.context, idle_timeout, framing);
+            moved->get_socket().assign(endpoint.protocol(), handle, ec);
+            if (ec) {
+                asio::detail::socket_ops::state_type state = 0;
+                asio::detail::socket_ops::close(handle, state, true, ec);
+                return nullptr;
             }
+            return moved;
         }
     };
 #ifdef ENABLE_SSL
     class tcp_server_ssl_c {
     public:
-        tcp_server_ssl_c(const security_context_opts sec_opts = {}) {
+        tcp_server_ssl_c(const security_context_opts sec_opts = {}): tcp_server_ssl_c(default_runtime(), sec_opts) {}
+
+        /**
+         * Construct the server on a runtime instead of the default one.
+         * Every run loop of the server (io_threads per shard) occupies one runtime thread while the server is open.
+         * 'open()' fails with 'invalid_argument' if the runtime has fewer threads than shards * io_threads.
+         *
+         * @param runtime Runtime hosting the server run loops. Must outlive the server.
+         *
+         * @par Example
+         * @code
+         * runtime_c runtime({ 4, "server", { 0xF0 } });
+         * tcp_server_ssl_c server(runtime, {});
+         * @endcode
+         */
+        tcp_server_ssl_c(runtime_c &runtime, const security_context_opts sec_opts = {}): runtime(runtime) {
             if (!sec_opts.private_key.empty()) {
                 const asio::const_buffer buffer(sec_opts.private_key.data(), sec_opts.private_key.size());
                 net.ssl_context.use_private_key(buffer, sec_opts.file_format);
@@ -351,10 +901,37 @@ namespace internetprotocol {
         }
 
         ~tcp_server_ssl_c() {
-            if (net.acceptor.is_open())
+            if (net.acceptor.is_open() || draining.load())
                 close();
         }
 
+        /**
+         * Set/Get the idle timeout for the connection in seconds.
+         * A connection with no read or write during that time is closed. A value of 0 disables the idle timeout.
+         *
+         * @par Example
+         * @code
+         * tcp_server_ssl_c server({});
+         * // Close clients silent for 30 seconds
+         * server.idle_timeout = 30;
+         * @endcode
+         */
+        uint16_t idle_timeout = 0;
+
+        /**
+         * Set/Get how the byte stream of each client is split into messages. Applied to clients accepted after it is set.
+         * With a framing other than RAW, each complete message is passed to the client 'on_frame' or 'on_message_received'.
+         *
+         * @par Example
+         * @code
+         * tcp_server_ssl_c server;
+         * // Newline-terminated messages
+         * server.framing.type = DELIMITED;
+         * server.framing.delimiter = "\r\n";
+         * @endcode
+         */
+        framing_t framing;
+
         /**
          * Set/Get the maximum number of simultaneous client connections the server will accept in queue.
          *
@@ -375,6 +952,23 @@ namespace internetprotocol {
          */
         int backlog = 2147483647;
 
+        /**
+         * Set/Get the number of threads running the server io_context.
+         *
+         * Every accepted connection is bound to its own strand, so the handlers of a single
+         * connection never run concurrently even when io_threads is greater than 1.
+         * Values lower than 1 are treated as 1. Must be set before 'open()'.
+         *
+         * @par Example
+         * @code
+         * tcp_server_ssl_c server({});
+         * // Spread accepts, reads and callbacks over 4 threads
+         * server.io_threads = 4;
+         * server.open({"", 8080});
+         * @endcode
+         */
+        uint16_t io_threads = 1;
+
         /**
          * Return true if socket is open.
          *
@@ -398,13 +992,13 @@ namespace internetprotocol {
         tcp::endpoint local_endpoint() const { return net.acceptor.local_endpoint(); }
 
         /**
-         * Gets a constant reference to the set of clients connected to the server.
+         * Gets a copy of the set of clients connected to the server.
          *
          * This method returns a std::set containing shared pointers to all tcp_remote_c
-         * clients currently connected to the server. Useful for monitoring active
+         * clients currently connected to the server, across every shard. Useful for monitoring active
          * connections or performing operations on all connected clients.
          *
-         * @return A constant reference to the std::set of connected clients.
+         * @return A std::set with the connected clients.
          *
          * @par Example
          * @code
@@ -421,7 +1015,131 @@ namespace internetprotocol {
          * }
          * @endcode
          */
-        const std::set<std::shared_ptr<tcp_remote_ssl_c>> &clients() const { return net.ssl_clients; }
+        std::set<std::shared_ptr<tcp_remote_ssl_c>> clients() {
+            std::set<std::shared_ptr<tcp_remote_ssl_c>> all_clients;
+            for_each([&](const std::shared_ptr<tcp_remote_ssl_c> &client) {
+                all_clients.insert(client);
+            });
+            return all_clients;
+        }
+
+        /**
+         * Return the client with the connection id 'id', or nullptr if it is no longer connected.
+         * The lookup is O(1) and thread-safe. The id of a client is returned by its 'get_id()'.
+         *
+         * @par Example
+         * @code
+         * tcp_server_ssl_c server;
+         *
+         * std::shared_ptr<tcp_remote_ssl_c> client = server.find(id);
+         * if (client)
+         *     client->write("...");
+         * @endcode
+         */
+        std::shared_ptr<tcp_remote_ssl_c> find(const connection_id_t id) {
+            tcp_server_ssl_t<tcp_remote_ssl_c> *shard = shard_of(id);
+            if (!shard)
+                return nullptr;
+
+            std::lock_guard guard(shard->clients_mutex);
+            return shard->ssl_clients.find(id);
+        }
+
+        /**
+         * Call 'fn' for every connected client, across every shard.
+         * The clients are collected under the registry locks and 'fn' runs after they are released,
+         * so it may write to or close the clients.
+         *
+         * @par Example
+         * @code
+         * tcp_server_ssl_c server;
+         *
+         * server.for_each([&](const std::shared_ptr<tcp_remote_ssl_c> &client) {
+         *     // your code...
+         * });
+         * @endcode
+         */
+        void for_each(const std::function<void(const std::shared_ptr<tcp_remote_ssl_c> &)> &fn) {
+            std::vector<std::shared_ptr<tcp_remote_ssl_c>> all_clients;
+            {
+                std::lock_guard guard(net.clients_mutex);
+                all_clients.reserve(net.ssl_clients.size());
+                net.ssl_clients.for_each([&](const std::shared_ptr<tcp_remote_ssl_c> &client) { all_clients.push_back(client); });
+            }
+            for (const std::unique_ptr<tcp_server_ssl_t<tcp_remote_ssl_c>> &shard : net.shards) {
+                std::lock_guard guard(shard->clients_mutex);
+                shard->ssl_clients.for_each([&](const std::shared_ptr<tcp_remote_ssl_c> &client) { all_clients.push_back(client); });
+            }
+            for (const std::shared_ptr<tcp_remote_ssl_c> &client : all_clients)
+                fn(client);
+        }
+
+        /**
+         * Run 'fn' on the strand of the client with the connection id 'id', so it never races the client's own handlers.
+         * It can be called from any thread. It returns false if the client is no longer connected.
+         *
+         * @par Example
+         * @code
+         * tcp_server_ssl_c server;
+         *
+         * server.post_to(id, [](const std::shared_ptr<tcp_remote_ssl_c> &client) {
+         *     // your code...
+         * });
+         * @endcode
+         */
+        bool post_to(const connection_id_t id, const std::function<void(const std::shared_ptr<tcp_remote_ssl_c> &)> &fn) {
+            std::shared_ptr<tcp_remote_ssl_c> client = find(id);
+            if (!client || !fn)
+                return false;
+
+            asio::post(client->get_socket().get_executor(), [client, fn]() {
+                fn(client);
+            });
+            return true;
+        }
+
+        /**
+         * Sends the same message to every connected client, or to those 'filter' returns true for.
+         * The message is encoded once, with the server 'framing' when it is not RAW, and the same immutable buffer
+         * is queued on every client, without copying it. Each shard walks its own clients on its own run loop,
+         * so the fan-out is spread over the shards and this call returns without waiting for it. 'filter' runs on those run loops.
+         * It returns false if the server is closed, if message is empty or if it does not fit the framing.
+         *
+         * @param message String to be send.
+         *
+         * @param filter Optional predicate selecting the clients to send to.
+         *
+         * @par Example
+         * @code
+         * tcp_server_ssl_c server;
+         *
+         * server.broadcast("tick\n", [](const std::shared_ptr<tcp_remote_ssl_c> &client) {
+         *     return !client->is_reading_paused();
+         * });
+         * @endcode
+         */
+        bool broadcast(const std::string &message, const std::function<bool(const std::shared_ptr<tcp_remote_ssl_c> &)> &filter = nullptr) {
+            return broadcast_frame(reinterpret_cast<const uint8_t *>(message.data()), message.size(), filter);
+        }
+
+        /**
+         * Sends the same buffer to every connected client, or to those 'filter' returns true for. See 'broadcast()'.
+         *
+         * @param buffer Buffer to be send.
+         *
+         * @param filter Optional predicate selecting the clients to send to.
+         *
+         * @par Example
+         * @code
+         * tcp_server_ssl_c server;
+         *
+         * std::vector<uint8_t> buffer = { 0, 1, 2, ... };
+         * server.broadcast_buffer(buffer);
+         * @endcode
+         */
+        bool broadcast_buffer(const std::vector<uint8_t> &buffer, const std::function<bool(const std::shared_ptr<tcp_remote_ssl_c> &)> &filter = nullptr) {
+            return broadcast_frame(buffer.data(), buffer.size(), filter);
+        }
 
         /**
          * Return a const ref of the latest error code returned by asio.
@@ -459,86 +1177,123 @@ namespace internetprotocol {
          * @endcode
          */
         bool open(const server_bind_options_t &bind_opts = { "", 8080, v4, true }) {
-            if (net.acceptor.is_open())
+            if (net.acceptor.is_open() || draining.load())
                 return false;
 
-            net.acceptor.open(bind_opts.protocol == v4
-                                  ? tcp::v4()
-                                  : tcp::v6(),
-                                  error_code);
+            bind_options = bind_opts;
+            admission.reset(bind_opts.admission);
 
-            if (error_code && on_error) {
-                std::lock_guard guard(mutex_error);
-                on_error(error_code);
+            const bool listening = bind_opts.listen_handles.empty() ? bind_listeners(bind_opts) : adopt_listeners(bind_opts);
+            if (!listening)
                 return false;
-            }
 
-            net.acceptor.set_option(asio::socket_base::reuse_address(bind_opts.reuse_address), error_code);
-            if (error_code && on_error) {
+            // Every run loop blocks a runtime thread until the server closes, a loop with no thread left never runs
+            const uint16_t threads = io_threads > 0 ? io_threads : 1;
+            if (runtime.thread_count() < threads * (net.shards.size() + 1)) {
+                asio::error_code ec;
+                net.acceptor.close(ec);
+                net.shards.clear();
                 std::lock_guard guard(mutex_error);
-                on_error(error_code);
+                error_code = asio::error::invalid_argument;
+                if (on_error) on_error(error_code);
                 return false;
             }
 
-            const tcp::endpoint endpoint = bind_opts.address.empty() ?
-                                        tcp::endpoint(bind_opts.protocol == v4
-                                                        ? tcp::v4()
-                                                        : tcp::v6(),
-                                                        bind_opts.port) :
-                                        tcp::endpoint(make_address(bind_opts.address), bind_opts.port);
+            if (on_listening)
+                on_listening();
 
-            net.acceptor.bind(endpoint, error_code);
-            if (error_code && on_error) {
-                std::lock_guard guard(mutex_error);
-                on_error(error_code);
-                return false;
+            error_code.clear();
+            running_threads.store(static_cast<uint32_t>(threads * (net.shards.size() + 1)));
+            start_shard(net, threads);
+            for (const std::unique_ptr<tcp_server_ssl_t<tcp_remote_ssl_c>> &shard : net.shards)
+                start_shard(*shard, threads);
+            return true;
+        }
+
+        /**
+         * Return the listening sockets of every shard, to hand them over to the process replacing this one
+         * with 'listen_handoff_c' or 'export_listen_handles()'. They stay owned by the server, the other process gets copies
+         * and keeps accepting on them after this server closes. Empty if the server is not open.
+         *
+         * @par Example
+         * @code
+         * tcp_server_ssl_c server({});
+         * std::vector<tcp::acceptor::native_handle_type> handles = server.listen_handles();
+         * @endcode
+         */
+        std::vector<tcp::acceptor::native_handle_type> listen_handles() {
+            std::vector<tcp::acceptor::native_handle_type> handles;
+            if (!net.acceptor.is_open())
+                return handles;
+
+            handles.push_back(net.acceptor.native_handle());
+            for (const std::unique_ptr<tcp_server_ssl_t<tcp_remote_ssl_c>> &shard : net.shards) {
+                if (shard->acceptor.is_open())
+                    handles.push_back(shard->acceptor.native_handle());
             }
+            return handles;
+        }
 
-            net.acceptor.listen(backlog, error_code);
-            if (error_code && on_error) {
-                std::lock_guard guard(mutex_error);
-                on_error(error_code);
+        /**
+         * Stop accepting and let the connected clients finish before closing. 'on_close' event will be triggered once every client is gone.
+         * Every client finishes sending what it has queued and then closes.
+         * Clients still connected when 'timeout' expires are closed. Returns false if the server is not open or is already draining.
+         *
+         * @param timeout Time given to the clients to finish.
+         *
+         * @par Example
+         * @code
+         * tcp_server_ssl_c server({});
+         * server.on_close = [&]() {
+         *      // every client has been disconnected
+         * };
+         * server.drain(std::chrono::seconds(30));
+         * @endcode
+         */
+        bool drain(const std::chrono::steady_clock::duration timeout) {
+            if (!net.acceptor.is_open() || draining.exchange(true))
                 return false;
-            }
 
-            if (on_listening)
-                on_listening();
-            
-            asio::post(thread_pool, [&]{ run_context_thread(); });
+            {
+                std::lock_guard guard(mutex_drain);
+                drain_timer.expires_after(timeout);
+                drain_timer.async_wait([&](const asio::error_code &ec) {
+                    if (!ec && draining.load())
+                        drain_expired();
+                });
+            }
+            for (const std::unique_ptr<tcp_server_ssl_t<tcp_remote_ssl_c>> &shard : net.shards)
+                stop_accepting(*shard);
+            stop_accepting(net);
+            for_each([](const std::shared_ptr<tcp_remote_ssl_c> &client) {
+                asio::post(client->get_socket().get_executor(), [client]() {
+                    client->close_after_flush();
+                });
+            });
+            // Clients closing from now on cancel the deadline when they are the last one
+            if (admission.live_connections() == 0)
+                cancel_drain_timer();
             return true;
         }
 
         /**
          * Close the underlying socket and stop listening for data on it. 'on_close' event will be triggered.
          *
-         * @param force Cancel all asynchronous operations associated with the client sockets if true.
-         *
          * @par Example
          * @code
          * tcp_server_ssl_c server({});
-         * server.close(false);
+         * server.close();
          * @endcode
          */
         void close() {
             is_closing.store(true);
-            if (net.acceptor.is_open()) {
-                std::lock_guard guard(mutex_error);
-                net.acceptor.close(error_code);
-                if (on_error) on_error(error_code);
-            }
-            if (!net.ssl_clients.empty()) {
-                std::lock_guard guard(mutex_error);
-                for (const auto &client : net.ssl_clients) {
-                    if (client)
-                        client->close();
-                }
-                net.ssl_clients.clear();
-            }
-            net.context.stop();
-            net.context.restart();
-            net.acceptor = tcp::acceptor(net.context);
+            cancel_drain_timer();
+            for (const std::unique_ptr<tcp_server_ssl_t<tcp_remote_ssl_c>> &shard : net.shards)
+                close_shard(*shard);
+            close_shard(net);
             if (on_close)
                 on_close();
+            draining.store(false);
             is_closing.store(false);
         }
 
@@ -599,51 +1354,363 @@ namespace internetprotocol {
         std::function<void(const asio::error_code &)> on_error;
 
     private:
-        std::mutex mutex_io;
         std::mutex mutex_error;
+        runtime_c &runtime = default_runtime();
         std::atomic<bool> is_closing = false;
+        std::atomic<uint32_t> running_threads = 0;
         tcp_server_ssl_t<tcp_remote_ssl_c> net;
         asio::error_code error_code;
+        server_bind_options_t bind_options;
+        admission_control_c admission;
+        std::atomic<bool> draining = false;
+        std::mutex mutex_drain;
+        asio::steady_timer drain_timer{net.context};
 
-        void run_context_thread() {
-            std::lock_guard guard(mutex_io);
-            error_code.clear();
-            std::shared_ptr<tcp_remote_ssl_c> client_socket = std::make_shared<tcp_remote_ssl_c>(net.context, net.ssl_context);
-            net.acceptor.async_accept(client_socket->get_socket().lowest_layer(),
+        bool broadcast_frame(const uint8_t *data, const size_t size, const std::function<bool(const std::shared_ptr<tcp_remote_ssl_c> &)> &filter) {
+            if (!net.acceptor.is_open() || size == 0)
+                return false;
+
+            std::vector<uint8_t> payload;
+            if (!frame_codec_c(framing).encode(data, size, payload))
+                return false;
+            const shared_buffer_t shared = std::make_shared<const std::vector<uint8_t>>(std::move(payload));
+            fan_out(net, shared, filter);
+            for (const std::unique_ptr<tcp_server_ssl_t<tcp_remote_ssl_c>> &shard : net.shards)
+                fan_out(*shard, shared, filter);
+            return true;
+        }
+
+        // Shard that handed out 'id', see connection_id_t
+        tcp_server_ssl_t<tcp_remote_ssl_c> *shard_of(const connection_id_t id) {
+            const uint16_t index = connection_shard(id);
+            if (index == 0)
+                return &net;
+            if (index > net.shards.size())
+                return nullptr;
+            return net.shards[index - 1].get();
+        }
+
+        // Queue 'buffer' on the clients of 'shard' from its own run loop
+        void fan_out(tcp_server_ssl_t<tcp_remote_ssl_c> &shard, const shared_buffer_t &buffer, const std::function<bool(const std::shared_ptr<tcp_remote_ssl_c> &)> &filter) {
+            asio::post(shard.context, [&shard, buffer, filter]() {
+                std::vector<std::shared_ptr<tcp_remote_ssl_c>> targets;
+                {
+                    std::lock_guard guard(shard.clients_mutex);
+                    targets.reserve(shard.ssl_clients.size());
+                    shard.ssl_clients.for_each([&](const std::shared_ptr<tcp_remote_ssl_c> &client) { targets.push_back(client); });
+                }
+                for (const std::shared_ptr<tcp_remote_ssl_c> &client : targets) {
+                    if (!filter || filter(client))
+                        client->write_shared(buffer);
+                }
+            });
+        }
+
+        void run_context_thread(tcp_server_ssl_t<tcp_remote_ssl_c> &shard) {
+            run_context(shard.context, bind_options.busy_poll_us);
+            if (running_threads.fetch_sub(1) == 1 && !is_closing.load())
+                close();
+        }
+
+        // Open and bind the acceptor of every shard
+        bool bind_listeners(const server_bind_options_t &bind_opts) {
+            const tcp::endpoint endpoint = bind_opts.address.empty() ?
+                                        tcp::endpoint(bind_opts.protocol == v4
+                                                        ? tcp::v4()
+                                                        : tcp::v6(),
+                                                        bind_opts.port) :
+                                        tcp::endpoint(make_address(bind_opts.address), bind_opts.port);
+
+#ifdef SO_REUSEPORT
+            const bool reuse_port = bind_opts.shards > 1;
+#else
+            const bool reuse_port = false;
+#endif
+            if (!open_acceptor(net.acceptor, bind_opts, endpoint, reuse_port))
+                return false;
+
+            net.shards.clear();
+            if (reuse_port) {
+                // Every shard binds the port picked by the first acceptor, so port 0 works too
+                const tcp::endpoint shard_endpoint = net.acceptor.local_endpoint();
+                for (uint16_t i = 1; i < bind_opts.shards; ++i) {
+                    net.shards.push_back(std::make_unique<tcp_server_ssl_t<tcp_remote_ssl_c>>());
+                    net.shards.back()->ssl_clients.set_shard(i);
+                    if (!open_acceptor(net.shards.back()->acceptor, bind_opts, shard_endpoint, reuse_port)) {
+                        asio::error_code ec;
+                        net.acceptor.close(ec);
+                        net.shards.clear();
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+
+        // Serve on sockets that are listening already, one shard each
+        bool adopt_listeners(const server_bind_options_t &bind_opts) {
+            net.shards.clear();
+            for (size_t i = 0; i < bind_opts.listen_handles.size(); ++i) {
+                if (i > 0) {
+                    net.shards.push_back(std::make_unique<tcp_server_ssl_t<tcp_remote_ssl_c>>());
+                    net.shards.back()->ssl_clients.set_shard(static_cast<uint16_t>(i));
+                }
+                tcp::acceptor &acceptor = i == 0 ? net.acceptor : net.shards.back()->acceptor;
+                if (!adopt_acceptor(acceptor, bind_opts.listen_handles[i], backlog, error_code)) {
+                    {
+                        std::lock_guard guard(mutex_error);
+                        if (on_error) on_error(error_code);
+                    }
+                    // The handles belong to the server, close the ones adopted so far and the ones left
+                    asio::error_code ec;
+                    net.acceptor.close(ec);
+                    net.shards.clear();
+                    for (size_t j = i; j < bind_opts.listen_handles.size(); ++j) {
+                        asio::detail::socket_ops::state_type state = 0;
+                        asio::detail::socket_ops::close(bind_opts.listen_handles[j], state, true, ec);
+                    }
+                    return false;
+                }
+                set_busy_poll(acceptor, bind_opts.so_busy_poll_us);
+                set_listener_options(acceptor, bind_opts.socket_options);
+            }
+            return true;
+        }
+
+        bool open_acceptor(tcp::acceptor &acceptor, const server_bind_options_t &bind_opts,
+                           const tcp::endpoint &endpoint, const bool reuse_port) {
+            acceptor.open(bind_opts.protocol == v4
+                          ? tcp::v4()
+                          : tcp::v6(),
+                          error_code);
+            if (error_code) {
+                std::lock_guard guard(mutex_error);
+                if (on_error) on_error(error_code);
+                return false;
+            }
+
+            acceptor.set_option(asio::socket_base::reuse_address(bind_opts.reuse_address), error_code);
+            if (error_code) {
+                std::lock_guard guard(mutex_error);
+                if (on_error) on_error(error_code);
+                return false;
+            }
+            set_busy_poll(acceptor, bind_opts.so_busy_poll_us);
+            set_listener_options(acceptor, bind_opts.socket_options);
+
+#ifdef SO_REUSEPORT
+            if (reuse_port) {
+                acceptor.set_option(reuse_port_t(true), error_code);
+                if (error_code) {
+                    std::lock_guard guard(mutex_error);
+                    if (on_error) on_error(error_code);
+                    return false;
+                }
+            }
+#endif
+
+            acceptor.bind(endpoint, error_code);
+            if (error_code) {
+                std::lock_guard guard(mutex_error);
+                if (on_error) on_error(error_code);
+                return false;
+            }
+
+            acceptor.listen(backlog, error_code);
+            if (error_code) {
+                std::lock_guard guard(mutex_error);
+                if (on_error) on_error(error_code);
+                return false;
+            }
+            return true;
+        }
+
+        // Arm one more accept, with the connection object it will hand the socket to constructed up front.
+        // 'client_socket' reuses the one of a rejected connection.
+        void async_accept(tcp_server_ssl_t<tcp_remote_ssl_c> &shard, std::shared_ptr<tcp_remote_ssl_c> client_socket = nullptr) {
+            const std::chrono::steady_clock::duration delay = admission.reserve_accept();
+            if (delay > std::chrono::steady_clock::duration::zero()) {
+                // Out of accept tokens, arm it once the bucket has refilled
+                std::shared_ptr<asio::steady_timer> timer = std::make_shared<asio::steady_timer>(shard.context, delay);
+                timer->async_wait([&, timer, client_socket](const asio::error_code &ec) {
+                    if (!ec && shard.acceptor.is_open())
+                        async_accept(shard, client_socket);
+                });
+                return;
+            }
+            if (!client_socket)
+                client_socket = std::make_shared<tcp_remote_ssl_c>(shard.context, net.ssl_context, idle_timeout, framing);
+            shard.acceptor.async_accept(client_socket->get_socket().lowest_layer(),
                                         [&, client_socket](const asio::error_code &ec) {
-                                            accept(ec, client_socket);
+                                            accept(ec, client_socket, shard);
                                         });
-            net.context.run();
-            if (!is_closing.load())
-                close();
         }
 
-        void accept(const asio::error_code &error, const std::shared_ptr<tcp_remote_ssl_c> &client) {
+        void start_shard(tcp_server_ssl_t<tcp_remote_ssl_c> &shard, const uint16_t threads) {
+            for (uint16_t i = 0; i < std::max<uint16_t>(bind_options.pending_accepts, 1); ++i)
+                async_accept(shard);
+            for (uint16_t i = 0; i < threads; ++i)
+                asio::post(runtime.get_executor(), [&]{ run_context_thread(shard); });
+        }
+
+        void close_shard(tcp_server_ssl_t<tcp_remote_ssl_c> &shard) {
+            if (shard.acceptor.is_open()) {
+                std::lock_guard guard(mutex_error);
+                shard.acceptor.close(error_code);
+                if (on_error) on_error(error_code);
+            }
+            std::vector<std::shared_ptr<tcp_remote_ssl_c>> clients_to_close;
+            {
+                std::lock_guard guard(shard.clients_mutex);
+                clients_to_close = shard.ssl_clients.take_all();
+            }
+            if (!clients_to_close.empty()) {
+                std::lock_guard guard(mutex_error);
+                for (const auto &client : clients_to_close) {
+                    if (client)
+                        client->close();
+                }
+            }
+            shard.context.stop();
+            shard.context.restart();
+            shard.acceptor = tcp::acceptor(shard.context);
+        }
+
+        // Close the acceptor of 'shard' and leave its clients connected
+        void stop_accepting(tcp_server_ssl_t<tcp_remote_ssl_c> &shard) {
+            if (!shard.acceptor.is_open())
+                return;
+            std::lock_guard guard(mutex_error);
+            shard.acceptor.close(error_code);
+            if (error_code && on_error) on_error(error_code);
+        }
+
+        void cancel_drain_timer() {
+            std::lock_guard guard(mutex_drain);
+            drain_timer.cancel();
+        }
+
+        // Drain deadline: close whatever is still connected
+        void drain_expired() {
+            for_each([](const std::shared_ptr<tcp_remote_ssl_c> &client) {
+                asio::post(client->get_socket().get_executor(), [client]() {
+                    client->close();
+                });
+            });
+        }
+
+        void accept(const asio::error_code &error, const std::shared_ptr<tcp_remote_ssl_c> &client, tcp_server_ssl_t<tcp_remote_ssl_c> &shard) {
             if (error) {
                 std::lock_guard guard(mutex_error);
                 error_code = error;
                 client->close();
-                if (net.acceptor.is_open()) {
-                    std::shared_ptr<tcp_remote_ssl_c> client_socket = std::make_shared<tcp_remote_ssl_c>(net.context, net.ssl_context);
-                    net.acceptor.async_accept(client_socket->get_socket().lowest_layer(),
-                                                [&, client_socket](const asio::error_code &ec) {
-                                                    accept(ec, client_socket);
-                                                });
-                }
+                if (shard.acceptor.is_open())
+                    async_accept(shard);
+                return;
+            }
+            asio::error_code endpoint_error;
+            const asio::ip::address address = client->get_socket().lowest_layer().remote_endpoint(endpoint_error).address();
+            if (endpoint_error || !admission.admit(address)) {
+                // Over a limit: drop it before anything is set up for it, its remote takes the next connection
+                client->get_socket().lowest_layer().close(endpoint_error);
+                if (shard.acceptor.is_open())
+                    async_accept(shard, client);
                 return;
             }
-            net.ssl_clients.insert(client);
-            client->on_close = [&, client]() { net.ssl_clients.erase(client); };
+            if (bind_options.balance_shards && !net.shards.empty()) {
+                tcp_server_ssl_t<tcp_remote_ssl_c> &owner = least_loaded_shard(shard);
+                add_client(&owner == &shard ? client : hand_over(client, owner), owner, address);
+            } else {
+                add_client(client, shard, address);
+            }
+            if (shard.acceptor.is_open())
+                async_accept(shard);
+        }
+
+        void add_client(const std::shared_ptr<tcp_remote_ssl_c> &client, tcp_server_ssl_t<tcp_remote_ssl_c> &shard, const asio::ip::address &address) {
+            if (!client) {
+                admission.release(address);
+                return;
+            }
+
+            set_socket_options(client->get_socket().lowest_layer(), bind_options.socket_options);
+            connection_id_t id;
+            {
+                std::lock_guard guard(shard.clients_mutex);
+                id = shard.ssl_clients.insert(client);
+            }
+            if (id == 0) {
+                // Registry full: its close could not find it, so its admission slots would never be given back
+                asio::error_code ec;
+                client->get_socket().lowest_layer().close(ec);
+                admission.release(address);
+                return;
+            }
+            client->set_id(id);
+            client->on_close = [&, client, address]() {
+                bool registered;
+                {
+                    std::lock_guard guard(shard.clients_mutex);
+                    registered = shard.ssl_clients.erase(client->get_id());
+                }
+                // 'on_close' may run more than once, the connection is given back only the first time
+                if (registered) {
+                    admission.release(address);
+                    if (draining.load() && admission.live_connections() == 0)
+                        cancel_drain_timer();
+                }
+            };
             if (on_client_accepted)
                 on_client_accepted(client);
             client->connect();
-            if (net.acceptor.is_open()) {
-                std::shared_ptr<tcp_remote_ssl_c> client_socket = std::make_shared<tcp_remote_ssl_c>(net.context, net.ssl_context);
-                net.acceptor.async_accept(client_socket->get_socket().lowest_layer(),
-                                            [&, client_socket](const asio::error_code &ec) {
-                                                accept(ec, client_socket);
-                                            });
+            // Accepted while draining, after 'drain()' went over the clients
+            if (draining.load())
+                client->close_after_flush();
+        }
+
+        // Shard with the fewest clients, the accepting one on a tie
+        tcp_server_ssl_t<tcp_remote_ssl_c> &least_loaded_shard(tcp_server_ssl_t<tcp_remote_ssl_c> &accepting) {
+            tcp_server_ssl_t<tcp_remote_ssl_c> *least_loaded = &accepting;
+            size_t least_clients;
+            {
+                std::lock_guard guard(accepting.clients_mutex);
+                least_clients = accepting.ssl_clients.size();
+            }
+            const auto consider = [&](tcp_server_ssl_t<tcp_remote_ssl_c> &shard) {
+                std::lock_guard guard(shard.clients_mutex);
+                if (shard.ssl_clients.size() < least_clients) {
+                    least_loaded = &shard;
+                    least_clients = shard.ssl_clients.size();
+                }
+            };
+            consider(net);
+            for (const std::unique_ptr<tcp_server_ssl_t<tcp_remote_ssl_c>> &shard : net.shards)
+                consider(*shard);
+            return *least_loaded;
+        }
+
+        // Move an accepted socket onto the run loops of 'target'. Returns nullptr, with the socket closed, if it was lost on the way.
+        std::shared_ptr<tcp_remote_ssl_c> hand_over(const std::shared_ptr<tcp_remote_ssl_c> &client, tcp_server_ssl_t<tcp_remote_ssl_c> &target) {
+            asio::error_code ec;
+            const tcp::endpoint endpoint = client->get_socket().lowest_layer().local_endpoint(ec);
+            tcp::socket::native_handle_type handle{};
+            if (!ec)
+                handle = client->get_socket().lowest_layer().release(ec);
+            if (ec) {
+                // Still bound to the accepting shard, it cannot be registered in 'target'
+                asio::error_code ignored;
+                client->get_socket().lowest_layer().close(ignored);
+                return nullptr;
+            }
+
+            std::shared_ptr<tcp_remote_ssl_c> moved = std::make_shared<tcp_remote_ssl_c>(target.context, net.ssl_context, idle_timeout, framing);
+            moved->get_socket().lowest_layer().assign(endpoint.protocol(), handle, ec);
+            if (ec) {
+                asio::detail::socket_ops::state_type state = 0;
+                asio::detail::socket_ops::close(handle, state, true, ec);
+                return nullptr;
             }
+            return moved;
         }
     };
 #endif
@@ -15,6 +15,38 @@ namespace internetprotocol {
     public:
         udp_client_c() { recv_buffer.reserve(recv_buffer_size); }
 
+        /**
+         * Construct the client on a shared io_context instead of a private one.
+         * No runtime thread is reserved for this client, the owner of 'io_context' is responsible
+         * for running it, so many clients can be multiplexed over a few threads. Handlers of the
+         * client are serialized on its own strand.
+         * Keep the client alive until 'io_context' has run the handlers cancelled by 'close()'.
+         *
+         * @param io_context Shared io_context used by the socket, resolver and timers.
+         *
+         * @par Example
+         * @code
+         * asio::io_context io_context;
+         * udp_client_c client(io_context);
+         * client.connect({"localhost", "8080", v4});
+         * io_context.run();
+         * @endcode
+         */
+        explicit udp_client_c(asio::io_context &io_context): net(io_context) { recv_buffer.reserve(recv_buffer_size); }
+
+        /**
+         * Construct the client on the io_context of a runtime, see the io_context constructor.
+         *
+         * @param runtime Runtime whose threads run the client handlers. Must outlive the client.
+         *
+         * @par Example
+         * @code
+         * runtime_c runtime({ 2, "client" });
+         * udp_client_c client(runtime);
+         * @endcode
+         */
+        explicit udp_client_c(runtime_c &runtime): udp_client_c(runtime.context()) {}
+
         ~udp_client_c() {
             net.resolver.cancel();
             if (net.socket.is_open()) close();
@@ -167,13 +199,15 @@ namespace internetprotocol {
             if (net.socket.is_open())
                 return false;
 
+            bind_options = bind_opts;
             net.resolver.async_resolve(bind_opts.protocol == v4 ? udp::v4() : udp::v6(),
                                         bind_opts.address, bind_opts.port,
                                         [&](const asio::error_code &ec, const udp::resolver::results_type &results) {
                                             resolve(ec, results);
                                         });
 
-            asio::post(thread_pool, [&]{ run_context_thread(); });
+            if (net.owned_context)
+                asio::post(default_runtime().get_executor(), [&]{ run_context_thread(); });
             return true;
         }
 
@@ -197,8 +231,10 @@ namespace internetprotocol {
                 if (error_code && on_error)
                     on_error(error_code);
             }
-            net.context.stop();
-            net.context.restart();
+            if (net.owned_context) {
+                net.context.stop();
+                net.context.restart();
+            }
             if (on_close)
                 on_close();
             is_closing.store(false);
@@ -266,22 +302,32 @@ namespace internetprotocol {
         std::atomic<bool> is_closing = false;
         udp_client_t net;
         asio::error_code error_code;
+        client_bind_options_t bind_options;
         size_t recv_buffer_size = 16384;
         std::vector<uint8_t> recv_buffer;
 
         void run_context_thread() {
             std::lock_guard guard(mutex_io);
             error_code.clear();
-            net.context.run();
+            run_context(net.context, bind_options.busy_poll_us);
             if (net.socket.is_open() && !is_closing.load())
                 close();
         }
 
+        void close_after_error(const asio::error_code &error) {
+            // Private io_contexts are closed by run_context_thread once they run out of work
+            if (!net.owned_context && error != asio::error::operation_aborted && !is_closing.load())
+                close();
+        }
+
         void resolve(const asio::error_code &error, const udp::resolver::results_type &results) {
             if (error) {
-                std::lock_guard guard(mutex_error);
-                error_code = error;
-                if (on_error) on_error(error);
+                {
+                    std::lock_guard guard(mutex_error);
+                    error_code = error;
+                    if (on_error) on_error(error);
+                }
+                close_after_error(error);
                 return;
             }
             net.endpoint = results.begin()->endpoint();
@@ -293,12 +339,17 @@ namespace internetprotocol {
 
         void conn(const asio::error_code &error) {
             if (error) {
-                std::lock_guard guard(mutex_error);
-                error_code = error;
-                if (on_error) on_error(error);
+                {
+                    std::lock_guard guard(mutex_error);
+                    error_code = error;
+                    if (on_error) on_error(error);
+                }
+                close_after_error(error);
                 return;
             }
 
+            set_busy_poll(net.socket, bind_options.so_busy_poll_us);
+
             if (on_connected)
                 on_connected();
 
@@ -322,9 +373,12 @@ namespace internetprotocol {
 
         void receive_from_cb(const asio::error_code &error, const size_t bytes_recvd) {
             if (error) {
-                std::lock_guard guard(mutex_error);
-                error_code = error;
-                if (on_error) on_error(error);
+                {
+                    std::lock_guard guard(mutex_error);
+                    error_code = error;
+                    if (on_error) on_error(error);
+                }
+                close_after_error(error);
                 return;
             }
 
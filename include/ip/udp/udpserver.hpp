@@ -14,6 +14,20 @@ namespace internetprotocol {
     public:
         udp_server_c() { recv_buffer.reserve(recv_buffer_size); }
 
+        /**
+         * Construct the server on a runtime instead of the default one.
+         * Every run loop of the server (io_threads per shard) occupies one runtime thread while the server is open.
+         *
+         * @param runtime Runtime hosting the server run loops. Must outlive the server.
+         *
+         * @par Example
+         * @code
+         * runtime_c runtime({ 4, "server", { 0xF0 } });
+         * udp_server_c server(runtime);
+         * @endcode
+         */
+        explicit udp_server_c(runtime_c &runtime): runtime(runtime) { recv_buffer.reserve(recv_buffer_size); }
+
         ~udp_server_c() {
             if (net.socket.is_open()) close();
         }
@@ -170,6 +184,7 @@ namespace internetprotocol {
             if (net.socket.is_open())
                 return false;
 
+            bind_options = bind_opts;
             net.socket.open(bind_opts.protocol == v4 ? udp::v4() : udp::v6(),
                             error_code);
             if (error_code) {
@@ -178,6 +193,7 @@ namespace internetprotocol {
                 return false;
             }
             net.socket.set_option(asio::socket_base::reuse_address(bind_opts.reuse_address));
+            set_busy_poll(net.socket, bind_opts.so_busy_poll_us);
             const udp::endpoint endpoint = bind_opts.address.empty() ?
                                         udp::endpoint(bind_opts.protocol == v4
                                                         ? udp::v4()
@@ -197,7 +213,7 @@ namespace internetprotocol {
             if (on_listening)
                 on_listening();
 
-            asio::post(thread_pool, [&]{ run_context_thread(); });
+            asio::post(runtime.get_executor(), [&]{ run_context_thread(); });
             return true;
         }
 
@@ -287,9 +303,11 @@ namespace internetprotocol {
     private:
         std::mutex mutex_io;
         std::mutex mutex_error;
+        runtime_c &runtime = default_runtime();
         std::atomic<bool> is_closing = false;
         udp_server_t net;
         asio::error_code error_code;
+        server_bind_options_t bind_options;
         size_t recv_buffer_size = 16384;
         std::vector<uint8_t> recv_buffer;
 
@@ -300,7 +318,7 @@ namespace internetprotocol {
             net.socket.async_receive_from(asio::buffer(recv_buffer, recv_buffer.size()),
                                           net.remote_endpoint,
                                           [&](const asio::error_code &ec, const size_t bytes_recvd) { receive_from_cb(ec, bytes_recvd); });
-            net.context.run();
+            run_context(net.context, bind_options.busy_poll_us);
             if (net.socket.is_open() && !is_closing.load())
                 close();
         }
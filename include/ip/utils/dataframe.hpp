@@ -85,12 +85,9 @@ namespace internetprotocol {
         return string_buffer;
     }
 
-    inline std::vector<uint8_t>
-    encode_buffer_payload(const std::vector<uint8_t> &payload, const dataframe_t &dataframe) {
-        std::vector<uint8_t> buffer;
-
-        uint64_t payload_length = payload.size();
-        uint64_t header_size = 2;
+    /// Size of the frame header 'encode_payload' writes for a payload of 'payload_length' bytes.
+    inline size_t frame_header_size(const uint64_t payload_length, const dataframe_t &dataframe) {
+        size_t header_size = 2;
         if (payload_length > 125 && payload_length <= 65535) {
             header_size += 2;
         } else if (payload_length > 65535) {
@@ -99,8 +96,14 @@ namespace internetprotocol {
         if (dataframe.mask) {
             header_size += 4;
         }
+        return header_size;
+    }
 
-        buffer.reserve(header_size + payload_length);
+    /// Append the frame for 'size' bytes at 'data' to 'buffer'. Lets callers encode into a pooled block.
+    inline void encode_payload(const uint8_t *data, const size_t size, const dataframe_t &dataframe,
+                               std::vector<uint8_t> &buffer) {
+        const uint64_t payload_length = size;
+        buffer.reserve(buffer.size() + frame_header_size(payload_length, dataframe) + payload_length);
 
         // FIN, RSV, Opcode
         uint8_t byte1 = uint8_t(dataframe.fin ? 0x80 : 0x00);
@@ -128,24 +131,26 @@ namespace internetprotocol {
             }
         }
 
-        std::array<uint8_t, 4> masking_key{};
-        if (dataframe.mask) {
-            masking_key = mask_gen();
-            for (uint8_t key: masking_key) {
-                buffer.push_back(key);
-            }
+        if (!dataframe.mask) {
+            buffer.insert(buffer.end(), data, data + size);
+            return;
         }
 
-        if (!payload.empty()) {
-            // payload data and mask
-            for (size_t i = 0; i < payload.size(); ++i) {
-                if (dataframe.mask) {
-                    buffer.push_back(payload[i] ^ masking_key[i % 4]);
-                } else {
-                    buffer.push_back(payload[i]);
-                }
-            }
+        const std::array<uint8_t, 4> masking_key = mask_gen();
+        for (uint8_t key: masking_key) {
+            buffer.push_back(key);
+        }
+
+        // payload data and mask
+        for (size_t i = 0; i < size; ++i) {
+            buffer.push_back(data[i] ^ masking_key[i % 4]);
         }
+    }
+
+    inline std::vector<uint8_t>
+    encode_buffer_payload(const std::vector<uint8_t> &payload, const dataframe_t &dataframe) {
+        std::vector<uint8_t> buffer;
+        encode_payload(payload.data(), payload.size(), dataframe, buffer);
 
         if (buffer.capacity() > buffer.size())
             buffer.shrink_to_fit();
@@ -15,7 +15,6 @@ namespace internetprotocol {
     class ws_client_c {
     public:
         ws_client_c() {
-            idle_timer = std::make_unique<asio::steady_timer>(net.context, 5);
             handshake.path = "/chat";
             handshake.headers.insert_or_assign("Connection", "Upgrade");
             handshake.headers.insert_or_assign("Sec-WebSocket-Key", "dGhlIHNhbXBsZSBub25jZQ==");
@@ -23,6 +22,44 @@ namespace internetprotocol {
             handshake.headers.insert_or_assign("Upgrade", "websocket");
         }
 
+        /**
+         * Construct the client on a shared io_context instead of a private one.
+         * No runtime thread is reserved for this client, the owner of 'io_context' is responsible
+         * for running it, so many clients can be multiplexed over a few threads. Handlers of the
+         * client are serialized on its own strand.
+         * Keep the client alive until 'io_context' has run the handlers cancelled by 'close()'.
+         *
+         * @param io_context Shared io_context used by the socket, resolver and timers.
+         *
+         * @par Example
+         * @code
+         * asio::io_context io_context;
+         * ws_client_c client(io_context);
+         * client.connect({"localhost", "8080", v4});
+         * io_context.run();
+         * @endcode
+         */
+        explicit ws_client_c(asio::io_context &io_context): net(io_context) {
+            handshake.path = "/chat";
+            handshake.headers.insert_or_assign("Connection", "Upgrade");
+            handshake.headers.insert_or_assign("Sec-WebSocket-Key", "dGhlIHNhbXBsZSBub25jZQ==");
+            handshake.headers.insert_or_assign("Sec-WebSocket-Version", "13");
+            handshake.headers.insert_or_assign("Upgrade", "websocket");
+        }
+
+        /**
+         * Construct the client on the io_context of a runtime, see the io_context constructor.
+         *
+         * @param runtime Runtime whose threads run the client handlers. Must outlive the client.
+         *
+         * @par Example
+         * @code
+         * runtime_c runtime({ 2, "client" });
+         * ws_client_c client(runtime);
+         * @endcode
+         */
+        explicit ws_client_c(runtime_c &runtime): ws_client_c(runtime.context()) {}
+
         ~ws_client_c() {
             if (net.socket.is_open())
                 close(1000, "Normal closure");
@@ -109,12 +146,9 @@ namespace internetprotocol {
             dataframe_t frame = dataframe;
             frame.opcode = TEXT_FRAME;
             frame.mask = true;
-            std::string payload = encode_string_payload(message, frame);
-            asio::async_write(net.socket,
-                              asio::buffer(payload.data(), payload.size()),
-                              [&, callback](const asio::error_code &ec, const size_t bytes_sent) {
-                                  if (callback) callback(ec, bytes_sent);
-                              });
+            std::vector<uint8_t> payload = send_queue.acquire(frame_header_size(message.size(), frame) + message.size());
+            encode_payload(reinterpret_cast<const uint8_t *>(message.data()), message.size(), frame, payload);
+            send_queue.push(std::move(payload), callback);
             return true;
         }
 
@@ -144,12 +178,9 @@ namespace internetprotocol {
             dataframe_t frame = dataframe;
             frame.opcode = BINARY_FRAME;
             frame.mask = true;
-            std::vector<uint8_t> payload = encode_buffer_payload(buffer, frame);
-            asio::async_write(net.socket,
-                              asio::buffer(payload.data(), payload.size()),
-                              [&, callback](const asio::error_code &ec, const size_t bytes_sent) {
-                                  if (callback) callback(ec, bytes_sent);
-                              });
+            std::vector<uint8_t> payload = send_queue.acquire(frame_header_size(buffer.size(), frame) + buffer.size());
+            encode_payload(buffer.data(), buffer.size(), frame, payload);
+            send_queue.push(std::move(payload), callback);
             return true;
         }
 
@@ -169,12 +200,9 @@ namespace internetprotocol {
 
             dataframe_t dataframe;
             dataframe.opcode = PING;
-            std::vector<uint8_t> payload = encode_buffer_payload({}, dataframe);
-            asio::async_write(net.socket,
-                              asio::buffer(payload.data(), payload.size()),
-                              [&, callback](const asio::error_code &ec, const size_t bytes_sent) {
-                                  if (callback) callback(ec, bytes_sent);
-                              });
+            std::vector<uint8_t> payload = send_queue.acquire(frame_header_size(0, dataframe));
+            encode_payload(nullptr, 0, dataframe, payload);
+            send_queue.push(std::move(payload), callback);
             return true;
         }
 
@@ -194,12 +222,9 @@ namespace internetprotocol {
 
             dataframe_t dataframe;
             dataframe.opcode = PONG;
-            std::vector<uint8_t> payload = encode_buffer_payload({}, dataframe);
-            asio::async_write(net.socket,
-                              asio::buffer(payload.data(), payload.size()),
-                              [&](const asio::error_code &ec, const size_t bytes_sent) {
-                                  if (callback) callback(ec, bytes_sent);
-                              });
+            std::vector<uint8_t> payload = send_queue.acquire(frame_header_size(0, dataframe));
+            encode_payload(nullptr, 0, dataframe, payload);
+            send_queue.push(std::move(payload), callback);
             return true;
         }
 
@@ -221,14 +246,19 @@ namespace internetprotocol {
             if (net.socket.is_open())
                 return false;
 
+            bind_options = bind_opts;
+            reading_paused.store(false);
+            read_parked = false;
+            parked_work.reset();
             close_state.store(OPEN);
-            net.resolver.async_resolve(bind_opts.protocol == v4 ? tcp::v4() : tcp::v6(),
-                                       bind_opts.address, bind_opts.port,
-                                       [&](const asio::error_code &ec, const tcp::resolver::results_type &results) {
-                                           resolve(ec, results);
-                                       });
-
-            asio::post(thread_pool, [&] { run_context_thread(); });
+            resolver_cache().async_resolve(net.resolver, resolve_protocol(bind_opts.protocol),
+                                           bind_opts.address, bind_opts.port,
+                                           [&](const asio::error_code &ec, const tcp::resolver::results_type &results) {
+                                               resolve(ec, results);
+                                           }, bind_opts.use_resolver_cache);
+
+            if (net.owned_context)
+                asio::post(default_runtime().get_executor(), [&]{ run_context_thread(); });
             return true;
         }
 
@@ -276,6 +306,8 @@ namespace internetprotocol {
 
             close_state.store(CLOSED);
             wait_close_frame_response.store(true);
+            idle_timer.cancel();
+            connector.cancel();
 
             if (net.socket.is_open()) {
                 bool is_locked = mutex_error.try_lock();
@@ -290,8 +322,10 @@ namespace internetprotocol {
                 if (is_locked)
                     mutex_error.unlock();
             }
-            net.context.stop();
-            net.context.restart();
+            if (net.owned_context) {
+                net.context.stop();
+                net.context.restart();
+            }
             net.endpoint = tcp::endpoint();
 
             if (on_close) {
@@ -299,6 +333,88 @@ namespace internetprotocol {
             }
         }
 
+        /**
+         * Set the send queue watermarks in bytes. 'on_backpressure' is triggered when the bytes waiting to be sent
+         * reach 'high', and 'on_drain' once they fall back to 'low' or below. A 'high' of 0 disables them.
+         *
+         * @param high Queued bytes at which the peer is considered to be falling behind.
+         *
+         * @param low Queued bytes at which writing may resume.
+         *
+         * @par Example
+         * @code
+         * ws_client_c client;
+         * client.set_watermarks(1024 * 1024, 256 * 1024);
+         * @endcode
+         */
+        void set_watermarks(const size_t high, const size_t low) {
+            send_queue.set_watermarks(high, low,
+                                      [&]() {
+                                          if (on_backpressure)
+                                              on_backpressure();
+                                      },
+                                      [&]() {
+                                          if (on_drain)
+                                              on_drain();
+                                      });
+        }
+
+        /**
+         * Return the number of bytes written and not sent yet.
+         *
+         * @par Example
+         * @code
+         * ws_client_c client;
+         * size_t queued = client.get_queued_bytes();
+         * @endcode
+         */
+        size_t get_queued_bytes() { return send_queue.queued_bytes(); }
+
+        /**
+         * Stop reading from the socket. The read already in progress still completes,
+         * after that nothing more is received until 'resume_reading()' is called.
+         *
+         * @par Example
+         * @code
+         * ws_client_c client;
+         * client.pause_reading();
+         * @endcode
+         */
+        void pause_reading() { reading_paused.store(true); }
+
+        /**
+         * Start reading from the socket again after 'pause_reading()'.
+         *
+         * @par Example
+         * @code
+         * ws_client_c client;
+         * client.resume_reading();
+         * @endcode
+         */
+        void resume_reading() {
+            reading_paused.store(false);
+            asio::post(net.socket.get_executor(), [&]() {
+                if (!read_parked)
+                    return;
+
+                read_parked = false;
+                parked_work.reset();
+                if (close_state == OPEN)
+                    read_next();
+            });
+        }
+
+        /**
+         * Return true if reading has been paused with 'pause_reading()'.
+         *
+         * @par Example
+         * @code
+         * ws_client_c client;
+         * bool paused = client.is_reading_paused();
+         * @endcode
+         */
+        bool is_reading_paused() const { return reading_paused.load(); }
+
         /**
          * Adds the listener function to 'on_connected'.
          * This event will be triggered when socket start to listening.
@@ -369,6 +485,35 @@ namespace internetprotocol {
          */
         std::function<void()> on_pong;
 
+        /**
+         * Adds the listener function to 'on_backpressure'.
+         * This event will be triggered when the bytes waiting to be sent reach the high watermark, see 'set_watermarks()'.
+         * It runs on the thread that wrote the message.
+         *
+         * @par Example
+         * @code
+         * ws_client_c client;
+         * client.on_backpressure = [&]() {
+         *      // stop writing until 'on_drain'...
+         * };
+         * @endcode
+         */
+        std::function<void()> on_backpressure;
+
+        /**
+         * Adds the listener function to 'on_drain'.
+         * This event will be triggered when the bytes waiting to be sent fall back to the low watermark after 'on_backpressure'.
+         *
+         * @par Example
+         * @code
+         * ws_client_c client;
+         * client.on_drain = [&]() {
+         *      // your code...
+         * };
+         * @endcode
+         */
+        std::function<void()> on_drain;
+
         /**
          * Adds the listener function to 'on_close'.
          * This event will be triggered when socket is closed.
@@ -402,17 +547,19 @@ namespace internetprotocol {
         std::mutex mutex_error;
         std::atomic<close_state_e> close_state = CLOSED;
         std::atomic<bool> wait_close_frame_response = true;
-        std::unique_ptr<asio::steady_timer> idle_timer;
+        std::atomic<bool> reading_paused = false;
+        bool read_parked = false;
+        std::optional<asio::executor_work_guard<asio::io_context::executor_type>> parked_work;
         tcp_client_t net;
+        tcp_connector_c connector;
+        send_queue_c<tcp::socket> send_queue{net.socket};
+        wheel_timer_c idle_timer{net.context, net.resolver.get_executor()};
         asio::error_code error_code;
-        asio::streambuf recv_buffer;
+        client_bind_options_t bind_options;
+        pooled_streambuf_c recv_buffer{buffer_pool_c::get(net.socket.get_executor())};
 
         void start_idle_timer() {
-            idle_timer->expires_after(std::chrono::seconds(5));
-            idle_timer->async_wait([&](const asio::error_code &ec) {
-                if (ec == asio::error::operation_aborted)
-                    return;
-
+            idle_timer.start(std::chrono::seconds(5), [&]() {
                 if (close_state.load() == CLOSED)
                     return;
 
@@ -444,12 +591,12 @@ namespace internetprotocol {
             if (close_payload.capacity() > close_payload.size())
                 close_payload.shrink_to_fit();
 
-            std::vector<uint8_t> encoded_payload = encode_buffer_payload(close_payload, dataframe);
-            asio::async_write(net.socket,
-                              asio::buffer(encoded_payload.data(), encoded_payload.size()),
-                              [this, code, reason](const asio::error_code &ec, const size_t bytes_sent) {
-                                  close_frame_sent_cb(ec, bytes_sent, code, reason);
-                              });
+            std::vector<uint8_t> encoded_payload = send_queue.acquire(frame_header_size(close_payload.size(), dataframe) + close_payload.size());
+            encode_payload(close_payload.data(), close_payload.size(), dataframe, encoded_payload);
+            send_queue.push(std::move(encoded_payload),
+                            [this, code, reason](const asio::error_code &ec, const size_t bytes_sent) {
+                                close_frame_sent_cb(ec, bytes_sent, code, reason);
+                            });
         }
 
         // Callback for close frame
@@ -467,47 +614,59 @@ namespace internetprotocol {
                 return;
             }
             start_idle_timer();
-            asio::async_read(net.socket,
-                             recv_buffer,
-                             asio::transfer_at_least(1),
-                             [&](const asio::error_code &ec, const size_t bytes_recvd) {
-                                 read_cb(ec, bytes_recvd);
-                             });
+            async_read_pooled(net.socket, recv_buffer,
+                              [&](const asio::error_code &ec, const size_t bytes_recvd) {
+                                  read_cb(ec, bytes_recvd);
+                              });
         }
 
         void run_context_thread() {
             std::lock_guard guard(mutex_io);
             error_code.clear();
-            net.context.run();
+            run_context(net.context, bind_options.busy_poll_us);
             if (close_state.load() == OPEN) {
                 close(1006, "Abnormal closure");
             }
             close_state.store(CLOSED);
         }
 
+        void close_after_error(const asio::error_code &error) {
+            // Private io_contexts are closed by run_context_thread once they run out of work
+            if (!net.owned_context && error != asio::error::operation_aborted && close_state.load() != CLOSED)
+                close(1006, "Abnormal closure");
+        }
+
         void resolve(const asio::error_code &error, const tcp::resolver::results_type &results) {
             if (error) {
-                std::lock_guard guard(mutex_error);
-                error_code = error;
-                if (on_error) on_error(error);
+                {
+                    std::lock_guard guard(mutex_error);
+                    error_code = error;
+                    if (on_error) on_error(error);
+                }
+                close_after_error(error);
                 return;
             }
             net.endpoint = results.begin()->endpoint();
-            asio::async_connect(net.socket,
-                                results,
-                                [&](const asio::error_code &ec, const tcp::endpoint &ep) {
-                                    conn(ec);
-                                });
+            connector.async_connect(net.socket, results, std::chrono::milliseconds(bind_options.connect_attempt_delay_ms),
+                                    [&](const asio::error_code &ec, const tcp::endpoint &ep) {
+                                        conn(ec);
+                                    });
         }
 
         void conn(const asio::error_code &error) {
             if (error) {
-                std::lock_guard lock(mutex_error);
-                error_code = error;
-                if (on_error) on_error(error);
+                {
+                    std::lock_guard lock(mutex_error);
+                    error_code = error;
+                    if (on_error) on_error(error);
+                }
+                close_after_error(error);
                 return;
             }
 
+            set_busy_poll(net.socket, bind_options.so_busy_poll_us);
+            set_socket_options(net.socket, bind_options.socket_options);
+
             std::string request = prepare_request(handshake, net.socket.remote_endpoint().address().to_string(),
                                                   net.socket.remote_endpoint().port());
 
@@ -527,7 +686,7 @@ namespace internetprotocol {
             }
 
             asio::async_read_until(net.socket,
-                                   recv_buffer, "\r\n",
+                                   recv_buffer.dynamic(), "\r\n",
                                    [&](const asio::error_code &ec, const size_t bytes_received) {
                                        read_handshake_cb(ec, bytes_received);
                                    });
@@ -535,10 +694,13 @@ namespace internetprotocol {
 
         void read_handshake_cb(const asio::error_code &error, const size_t bytes_recvd) {
             if (error) {
-                std::lock_guard lock(mutex_error);
-                consume_recv_buffer();
-                error_code = error;
-                if (on_error) on_error(error);
+                {
+                    std::lock_guard lock(mutex_error);
+                    consume_recv_buffer();
+                    error_code = error;
+                    if (on_error) on_error(error);
+                }
+                close_after_error(error);
                 return;
             }
 
@@ -568,16 +730,19 @@ namespace internetprotocol {
             }
 
             asio::async_read_until(net.socket,
-                                   recv_buffer, "\r\n\r\n",
+                                   recv_buffer.dynamic(), "\r\n\r\n",
                                    std::bind(&ws_client_c::read_headers, this, asio::placeholders::error, response));
         }
 
         void read_headers(const asio::error_code &error, http_response_t &response) {
             if (error) {
-                std::lock_guard lock(mutex_error);
-                consume_recv_buffer();
-                error_code = error;
-                if (on_error) on_error(error);
+                {
+                    std::lock_guard lock(mutex_error);
+                    consume_recv_buffer();
+                    error_code = error;
+                    if (on_error) on_error(error);
+                }
+                close_after_error(error);
                 return;
             }
             std::istream response_stream(&recv_buffer);
@@ -596,12 +761,25 @@ namespace internetprotocol {
 
             if (on_connected) on_connected(response);
 
-            asio::async_read(net.socket,
-                             recv_buffer,
-                             asio::transfer_at_least(1),
-                             [&](const asio::error_code &ec, const size_t bytes_recvd) {
-                                 read_cb(ec, bytes_recvd);
-                             });
+            async_read_pooled(net.socket, recv_buffer,
+                              [&](const asio::error_code &ec, const size_t bytes_recvd) {
+                                  read_cb(ec, bytes_recvd);
+                              });
+        }
+
+        // Re-arm the read unless reading is paused, in which case 'resume_reading()' does it
+        void read_next() {
+            if (reading_paused.load()) {
+                read_parked = true;
+                // A private io_context would otherwise run out of work and close the connection
+                if (net.owned_context)
+                    parked_work.emplace(net.context.get_executor());
+                return;
+            }
+            async_read_pooled(net.socket, recv_buffer,
+                              [&](const asio::error_code &ec, const size_t bytes_received) {
+                                  read_cb(ec, bytes_received);
+                              });
         }
 
         void consume_recv_buffer() {
@@ -612,9 +790,12 @@ namespace internetprotocol {
 
         void read_cb(const asio::error_code &error, const size_t bytes_recvd) {
             if (error) {
-                std::lock_guard lock(mutex_error);
-                consume_recv_buffer();
-                if (on_error) on_error(error);
+                {
+                    std::lock_guard lock(mutex_error);
+                    consume_recv_buffer();
+                    if (on_error) on_error(error);
+                }
+                close_after_error(error);
                 return;
             }
 
@@ -667,12 +848,7 @@ namespace internetprotocol {
             consume_recv_buffer();
 
             if (close_state == OPEN) {
-                asio::async_read(net.socket,
-                                 recv_buffer,
-                                 asio::transfer_at_least(1),
-                                 [&](const asio::error_code &ec, const size_t bytes_received) {
-                                     read_cb(ec, bytes_received);
-                                 });
+                read_next();
             }
         }
     };
@@ -681,54 +857,43 @@ namespace internetprotocol {
     class ws_client_ssl_c {
     public:
         ws_client_ssl_c(const security_context_opts sec_opts = {}) {
-            idle_timer = std::make_unique<asio::steady_timer>(net.context, 5);
-            if (!sec_opts.private_key.empty()) {
-                const asio::const_buffer buffer(sec_opts.private_key.data(), sec_opts.private_key.size());
-                net.ssl_context.use_private_key(buffer, sec_opts.file_format);
-            }
-
-            if (!sec_opts.cert.empty()) {
-                const asio::const_buffer buffer(sec_opts.cert.data(), sec_opts.cert.size());
-                net.ssl_context.use_certificate(buffer, sec_opts.file_format);
-            }
-
-            if (!sec_opts.cert_chain.empty()) {
-                const asio::const_buffer buffer(sec_opts.cert_chain.data(), sec_opts.cert_chain.size());
-                net.ssl_context.use_certificate_chain(buffer);
-            }
-
-            if (!sec_opts.rsa_private_key.empty()) {
-                const asio::const_buffer buffer(sec_opts.rsa_private_key.data(), sec_opts.rsa_private_key.size());
-                net.ssl_context.use_rsa_private_key(buffer, sec_opts.file_format);
-            }
-
-            if (!sec_opts.host_name_verification.empty()) {
-                net.ssl_context.set_verify_callback(asio::ssl::host_name_verification(sec_opts.host_name_verification));
-            }
-
-            switch (sec_opts.verify_mode) {
-                case none:
-                    net.ssl_context.set_verify_mode(asio::ssl::verify_none);
-                    break;
-                case verify_peer:
-                    net.ssl_context.set_verify_mode(asio::ssl::verify_peer);
-                    break;
-                case verify_fail_if_no_peer_cert:
-                    net.ssl_context.set_verify_mode(asio::ssl::verify_fail_if_no_peer_cert);
-                    break;
-                default:
-                    break;
-            }
-
-            net.ssl_socket = asio::ssl::stream<tcp::socket>(net.context, net.ssl_context);
+            init(sec_opts);
+        }
 
-            handshake.path = "/chat";
-            handshake.headers.insert_or_assign("Connection", "Upgrade");
-            handshake.headers.insert_or_assign("Sec-WebSocket-Key", "dGhlIHNhbXBsZSBub25jZQ==");
-            handshake.headers.insert_or_assign("Sec-WebSocket-Version", "13");
-            handshake.headers.insert_or_assign("Upgrade", "websocket");
+        /**
+         * Construct the client on a shared io_context instead of a private one.
+         * No runtime thread is reserved for this client, the owner of 'io_context' is responsible
+         * for running it, so many clients can be multiplexed over a few threads. Handlers of the
+         * client are serialized on its own strand.
+         * Keep the client alive until 'io_context' has run the handlers cancelled by 'close()'.
+         *
+         * @param io_context Shared io_context used by the socket, resolver and timers.
+         *
+         * @par Example
+         * @code
+         * asio::io_context io_context;
+         * ws_client_ssl_c client(io_context, {});
+         * client.connect({"localhost", "8080", v4});
+         * io_context.run();
+         * @endcode
+         */
+        ws_client_ssl_c(asio::io_context &io_context, const security_context_opts &sec_opts = {}): net(io_context) {
+            init(sec_opts);
         }
 
+        /**
+         * Construct the client on the io_context of a runtime, see the io_context constructor.
+         *
+         * @param runtime Runtime whose threads run the client handlers. Must outlive the client.
+         *
+         * @par Example
+         * @code
+         * runtime_c runtime({ 2, "client" });
+         * ws_client_ssl_c client(runtime, {});
+         * @endcode
+         */
+        ws_client_ssl_c(runtime_c &runtime, const security_context_opts &sec_opts = {}): ws_client_ssl_c(runtime.context(), sec_opts) {}
+
         ~ws_client_ssl_c() {
         }
         
@@ -812,12 +977,9 @@ namespace internetprotocol {
             dataframe_t frame = dataframe;
             frame.opcode = TEXT_FRAME;
             frame.mask = true;
-            std::string payload = encode_string_payload(message, frame);
-            asio::async_write(net.ssl_socket,
-                              asio::buffer(payload.data(), payload.size()),
-                              [&, callback](const asio::error_code &ec, const size_t bytes_sent) {
-                                  if (callback) callback(ec, bytes_sent);
-                              });
+            std::vector<uint8_t> payload = send_queue.acquire(frame_header_size(message.size(), frame) + message.size());
+            encode_payload(reinterpret_cast<const uint8_t *>(message.data()), message.size(), frame, payload);
+            send_queue.push(std::move(payload), callback);
             return true;
         }
 
@@ -846,12 +1008,9 @@ namespace internetprotocol {
             dataframe_t frame = dataframe;
             frame.opcode = BINARY_FRAME;
             frame.mask = true;
-            std::vector<uint8_t> payload = encode_buffer_payload(buffer, dataframe);
-            asio::async_write(net.ssl_socket,
-                              asio::buffer(payload.data(), payload.size()),
-                              [&](const asio::error_code &ec, const size_t bytes_sent) {
-                                  if (callback) callback(ec, bytes_sent);
-                              });
+            std::vector<uint8_t> payload = send_queue.acquire(frame_header_size(buffer.size(), dataframe) + buffer.size());
+            encode_payload(buffer.data(), buffer.size(), dataframe, payload);
+            send_queue.push(std::move(payload), callback);
             return true;
         }
 
@@ -871,12 +1030,9 @@ namespace internetprotocol {
 
             dataframe_t dataframe;
             dataframe.opcode = PING;
-            std::vector<uint8_t> payload = encode_buffer_payload({}, dataframe);
-            asio::async_write(net.ssl_socket,
-                              asio::buffer(payload.data(), payload.size()),
-                              [&](const asio::error_code &ec, const size_t bytes_sent) {
-                                  if (callback) callback(ec, bytes_sent);
-                              });
+            std::vector<uint8_t> payload = send_queue.acquire(frame_header_size(0, dataframe));
+            encode_payload(nullptr, 0, dataframe, payload);
+            send_queue.push(std::move(payload), callback);
             return true;
         }
 
@@ -896,12 +1052,9 @@ namespace internetprotocol {
 
             dataframe_t dataframe;
             dataframe.opcode = PONG;
-            std::vector<uint8_t> payload = encode_buffer_payload({}, dataframe);
-            asio::async_write(net.ssl_socket,
-                              asio::buffer(payload.data(), payload.size()),
-                              [&](const asio::error_code &ec, const size_t bytes_sent) {
-                                  if (callback) callback(ec, bytes_sent);
-                              });
+            std::vector<uint8_t> payload = send_queue.acquire(frame_header_size(0, dataframe));
+            encode_payload(nullptr, 0, dataframe, payload);
+            send_queue.push(std::move(payload), callback);
             return true;
         }
 
@@ -923,14 +1076,19 @@ namespace internetprotocol {
             if (net.ssl_socket.next_layer().is_open())
                 return false;
 
+            bind_options = bind_opts;
+            reading_paused.store(false);
+            read_parked = false;
+            parked_work.reset();
             close_state.store(OPEN);
-            net.resolver.async_resolve(bind_opts.protocol == v4 ? tcp::v4() : tcp::v6(),
-                                       bind_opts.address, bind_opts.port,
-                                       [&](const asio::error_code &ec, const tcp::resolver::results_type &results) {
-                                           resolve(ec, results);
-                                       });
-
-            asio::post(thread_pool, [&] { run_context_thread(); });
+            resolver_cache().async_resolve(net.resolver, resolve_protocol(bind_opts.protocol),
+                                           bind_opts.address, bind_opts.port,
+                                           [&](const asio::error_code &ec, const tcp::resolver::results_type &results) {
+                                               resolve(ec, results);
+                                           }, bind_opts.use_resolver_cache);
+
+            if (net.owned_context)
+                asio::post(default_runtime().get_executor(), [&]{ run_context_thread(); });
             return true;
         }
 
@@ -978,6 +1136,8 @@ namespace internetprotocol {
 
             close_state.store(CLOSED);
             wait_close_frame_response.store(true);
+            idle_timer.cancel();
+            connector.cancel();
 
             if (net.ssl_socket.next_layer().is_open()) {
                 bool is_locked = mutex_error.try_lock();
@@ -999,12 +1159,96 @@ namespace internetprotocol {
                 if (is_locked)
                     mutex_error.unlock();
             }
-            net.context.stop();
-            net.context.restart();
+            if (net.owned_context) {
+                net.context.stop();
+                net.context.restart();
+            }
             net.endpoint = tcp::endpoint();
-            net.ssl_socket = asio::ssl::stream<tcp::socket>(net.context, net.ssl_context);
+            net.ssl_socket = asio::ssl::stream<tcp::socket>(net.resolver.get_executor(), net.ssl_context);
+        }
+
+        /**
+         * Set the send queue watermarks in bytes. 'on_backpressure' is triggered when the bytes waiting to be sent
+         * reach 'high', and 'on_drain' once they fall back to 'low' or below. A 'high' of 0 disables them.
+         *
+         * @param high Queued bytes at which the peer is considered to be falling behind.
+         *
+         * @param low Queued bytes at which writing may resume.
+         *
+         * @par Example
+         * @code
+         * ws_client_ssl_c client;
+         * client.set_watermarks(1024 * 1024, 256 * 1024);
+         * @endcode
+         */
+        void set_watermarks(const size_t high, const size_t low) {
+            send_queue.set_watermarks(high, low,
+                                      [&]() {
+                                          if (on_backpressure)
+                                              on_backpressure();
+                                      },
+                                      [&]() {
+                                          if (on_drain)
+                                              on_drain();
+                                      });
+        }
+
+        /**
+         * Return the number of bytes written and not sent yet.
+         *
+         * @par Example
+         * @code
+         * ws_client_ssl_c client;
+         * size_t queued = client.get_queued_bytes();
+         * @endcode
+         */
+        size_t get_queued_bytes() { return send_queue.queued_bytes(); }
+
+        /**
+         * Stop reading from the socket. The read already in progress still completes,
+         * after that nothing more is received until 'resume_reading()' is called.
+         *
+         * @par Example
+         * @code
+         * ws_client_ssl_c client;
+         * client.pause_reading();
+         * @endcode
+         */
+        void pause_reading() { reading_paused.store(true); }
+
+        /**
+         * Start reading from the socket again after 'pause_reading()'.
+         *
+         * @par Example
+         * @code
+         * ws_client_ssl_c client;
+         * client.resume_reading();
+         * @endcode
+         */
+        void resume_reading() {
+            reading_paused.store(false);
+            asio::post(net.ssl_socket.get_executor(), [&]() {
+                if (!read_parked)
+                    return;
+
+                read_parked = false;
+                parked_work.reset();
+                if (close_state == OPEN)
+                    read_next();
+            });
         }
 
+        /**
+         * Return true if reading has been paused with 'pause_reading()'.
+         *
+         * @par Example
+         * @code
+         * ws_client_ssl_c client;
+         * bool paused = client.is_reading_paused();
+         * @endcode
+         */
+        bool is_reading_paused() const { return reading_paused.load(); }
+
         /**
          * Adds the listener function to 'on_connected'.
          * This event will be triggered when socket start to listening.
@@ -1090,6 +1334,35 @@ namespace internetprotocol {
          */
         std::function<void()> on_pong;
 
+        /**
+         * Adds the listener function to 'on_backpressure'.
+         * This event will be triggered when the bytes waiting to be sent reach the high watermark, see 'set_watermarks()'.
+         * It runs on the thread that wrote the message.
+         *
+         * @par Example
+         * @code
+         * ws_client_ssl_c client;
+         * client.on_backpressure = [&]() {
+         *      // stop writing until 'on_drain'...
+         * };
+         * @endcode
+         */
+        std::function<void()> on_backpressure;
+
+        /**
+         * Adds the listener function to 'on_drain'.
+         * This event will be triggered when the bytes waiting to be sent fall back to the low watermark after 'on_backpressure'.
+         *
+         * @par Example
+         * @code
+         * ws_client_ssl_c client;
+         * client.on_drain = [&]() {
+         *      // your code...
+         * };
+         * @endcode
+         */
+        std::function<void()> on_drain;
+
         /**
          * Adds the listener function to 'on_close'.
          * This event will be triggered when socket is closed.
@@ -1123,17 +1396,19 @@ namespace internetprotocol {
         std::mutex mutex_error;
         std::atomic<close_state_e> close_state = CLOSED;
         std::atomic<bool> wait_close_frame_response = true;
-        std::unique_ptr<asio::steady_timer> idle_timer;
+        std::atomic<bool> reading_paused = false;
+        bool read_parked = false;
+        std::optional<asio::executor_work_guard<asio::io_context::executor_type>> parked_work;
         tcp_client_ssl_t net;
+        tcp_connector_c connector;
+        send_queue_c<asio::ssl::stream<tcp::socket>> send_queue{net.ssl_socket, true};
+        wheel_timer_c idle_timer{net.context, net.resolver.get_executor()};
         asio::error_code error_code;
-        asio::streambuf recv_buffer;
+        client_bind_options_t bind_options;
+        pooled_streambuf_c recv_buffer{buffer_pool_c::get(net.ssl_socket.get_executor())};
 
         void start_idle_timer() {
-            idle_timer->expires_after(std::chrono::seconds(5));
-            idle_timer->async_wait([&](const asio::error_code &ec) {
-                if (ec == asio::error::operation_aborted)
-                    return;
-
+            idle_timer.start(std::chrono::seconds(5), [&]() {
                 if (close_state.load() == CLOSED)
                     return;
 
@@ -1165,12 +1440,12 @@ namespace internetprotocol {
             if (close_payload.capacity() > close_payload.size())
                 close_payload.shrink_to_fit();
 
-            std::vector<uint8_t> encoded_payload = encode_buffer_payload(close_payload, dataframe);
-            asio::async_write(net.ssl_socket,
-                              asio::buffer(encoded_payload.data(), encoded_payload.size()),
-                              [this, code, reason](const asio::error_code &ec, const size_t bytes_sent) {
-                                  close_frame_sent_cb(ec, bytes_sent, code, reason);
-                              });
+            std::vector<uint8_t> encoded_payload = send_queue.acquire(frame_header_size(close_payload.size(), dataframe) + close_payload.size());
+            encode_payload(close_payload.data(), close_payload.size(), dataframe, encoded_payload);
+            send_queue.push(std::move(encoded_payload),
+                            [this, code, reason](const asio::error_code &ec, const size_t bytes_sent) {
+                                close_frame_sent_cb(ec, bytes_sent, code, reason);
+                            });
         }
 
         // Callback for close frame
@@ -1188,12 +1463,10 @@ namespace internetprotocol {
                 return;
             }
             start_idle_timer();
-            asio::async_read(net.ssl_socket,
-                             recv_buffer,
-                             asio::transfer_at_least(1),
-                             [&](const asio::error_code &ec, const size_t bytes_recvd) {
-                                 read_cb(ec, bytes_recvd);
-                             });
+            async_read_pooled(net.ssl_socket, recv_buffer,
+                              [&](const asio::error_code &ec, const size_t bytes_recvd) {
+                                  read_cb(ec, bytes_recvd);
+                              });
         }
 
         // Handle close frame received
@@ -1235,44 +1508,108 @@ namespace internetprotocol {
                 if (error_code && on_error)
                     on_error(error_code);
             }
-            net.context.stop();
-            net.context.restart();
+            if (net.owned_context) {
+                net.context.stop();
+                net.context.restart();
+            }
             net.endpoint = tcp::endpoint();
-            net.ssl_socket = asio::ssl::stream<tcp::socket>(net.context, net.ssl_context);
+            net.ssl_socket = asio::ssl::stream<tcp::socket>(net.resolver.get_executor(), net.ssl_context);
+        }
+
+        void init(const security_context_opts &sec_opts) {
+            if (!sec_opts.private_key.empty()) {
+                const asio::const_buffer buffer(sec_opts.private_key.data(), sec_opts.private_key.size());
+                net.ssl_context.use_private_key(buffer, sec_opts.file_format);
+            }
+
+            if (!sec_opts.cert.empty()) {
+                const asio::const_buffer buffer(sec_opts.cert.data(), sec_opts.cert.size());
+                net.ssl_context.use_certificate(buffer, sec_opts.file_format);
+            }
+
+            if (!sec_opts.cert_chain.empty()) {
+                const asio::const_buffer buffer(sec_opts.cert_chain.data(), sec_opts.cert_chain.size());
+                net.ssl_context.use_certificate_chain(buffer);
+            }
+
+            if (!sec_opts.rsa_private_key.empty()) {
+                const asio::const_buffer buffer(sec_opts.rsa_private_key.data(), sec_opts.rsa_private_key.size());
+                net.ssl_context.use_rsa_private_key(buffer, sec_opts.file_format);
+            }
+
+            if (!sec_opts.host_name_verification.empty()) {
+                net.ssl_context.set_verify_callback(asio::ssl::host_name_verification(sec_opts.host_name_verification));
+            }
+
+            switch (sec_opts.verify_mode) {
+                case none:
+                    net.ssl_context.set_verify_mode(asio::ssl::verify_none);
+                    break;
+                case verify_peer:
+                    net.ssl_context.set_verify_mode(asio::ssl::verify_peer);
+                    break;
+                case verify_fail_if_no_peer_cert:
+                    net.ssl_context.set_verify_mode(asio::ssl::verify_fail_if_no_peer_cert);
+                    break;
+                default:
+                    break;
+            }
+
+            net.ssl_socket = asio::ssl::stream<tcp::socket>(net.resolver.get_executor(), net.ssl_context);
+
+            handshake.path = "/chat";
+            handshake.headers.insert_or_assign("Connection", "Upgrade");
+            handshake.headers.insert_or_assign("Sec-WebSocket-Key", "dGhlIHNhbXBsZSBub25jZQ==");
+            handshake.headers.insert_or_assign("Sec-WebSocket-Version", "13");
+            handshake.headers.insert_or_assign("Upgrade", "websocket");
         }
 
         void run_context_thread() {
             std::lock_guard guard(mutex_io);
             error_code.clear();
-            net.context.run();
+            run_context(net.context, bind_options.busy_poll_us);
             if (close_state.load() == OPEN) {
                 close(1006, "Abnormal closure");
             }
         }
 
+        void close_after_error(const asio::error_code &error) {
+            // Private io_contexts are closed by run_context_thread once they run out of work
+            if (!net.owned_context && error != asio::error::operation_aborted && close_state.load() != CLOSED)
+                close(1006, "Abnormal closure");
+        }
+
         void resolve(const asio::error_code &error, const tcp::resolver::results_type &results) {
             if (error) {
-                std::lock_guard guard(mutex_error);
-                error_code = error;
-                if (on_error) on_error(error);
+                {
+                    std::lock_guard guard(mutex_error);
+                    error_code = error;
+                    if (on_error) on_error(error);
+                }
+                close_after_error(error);
                 return;
             }
             net.endpoint = results.begin()->endpoint();
-            asio::async_connect(net.ssl_socket.lowest_layer(),
-                                results,
-                                [&](const asio::error_code &ec, const tcp::endpoint &ep) {
-                                    conn(ec);
-                                });
+            connector.async_connect(net.ssl_socket.next_layer(), results, std::chrono::milliseconds(bind_options.connect_attempt_delay_ms),
+                                    [&](const asio::error_code &ec, const tcp::endpoint &ep) {
+                                        conn(ec);
+                                    });
         }
 
         void conn(const asio::error_code &error) {
             if (error) {
-                std::lock_guard lock(mutex_error);
-                error_code = error;
-                if (on_error) on_error(error);
+                {
+                    std::lock_guard lock(mutex_error);
+                    error_code = error;
+                    if (on_error) on_error(error);
+                }
+                close_after_error(error);
                 return;
             }
 
+            set_busy_poll(net.ssl_socket.lowest_layer(), bind_options.so_busy_poll_us);
+            set_socket_options(net.ssl_socket.lowest_layer(), bind_options.socket_options);
+
             net.ssl_socket.async_handshake(asio::ssl::stream_base::client,
                                            [&](const asio::error_code &ec) {
                                                ssl_handshake(ec);
@@ -1281,9 +1618,12 @@ namespace internetprotocol {
 
         void ssl_handshake(const asio::error_code &error) {
             if (error) {
-                std::lock_guard lock(mutex_error);
-                error_code = error;
-                if (on_error) on_error(error);
+                {
+                    std::lock_guard lock(mutex_error);
+                    error_code = error;
+                    if (on_error) on_error(error);
+                }
+                close_after_error(error);
                 return;
             }
 
@@ -1307,7 +1647,7 @@ namespace internetprotocol {
             }
 
             asio::async_read_until(net.ssl_socket,
-                                   recv_buffer, "\r\n",
+                                   recv_buffer.dynamic(), "\r\n",
                                    [&](const asio::error_code &ec, const size_t bytes_received) {
                                        read_handshake_cb(ec, bytes_received);
                                    });
@@ -1349,7 +1689,7 @@ namespace internetprotocol {
             }
 
             asio::async_read_until(net.ssl_socket,
-                                   recv_buffer, "\r\n\r\n",
+                                   recv_buffer.dynamic(), "\r\n\r\n",
                                    std::bind(&ws_client_ssl_c::read_headers, this, asio::placeholders::error,
                                              response));
         }
@@ -1376,12 +1716,25 @@ namespace internetprotocol {
 
             if (on_connected) on_connected(response);
 
-            asio::async_read(net.ssl_socket,
-                             recv_buffer,
-                             asio::transfer_at_least(1),
-                             [&](const asio::error_code &ec, const size_t bytes_recvd) {
-                                 read_cb(ec, bytes_recvd);
-                             });
+            async_read_pooled(net.ssl_socket, recv_buffer,
+                              [&](const asio::error_code &ec, const size_t bytes_recvd) {
+                                  read_cb(ec, bytes_recvd);
+                              });
+        }
+
+        // Re-arm the read unless reading is paused, in which case 'resume_reading()' does it
+        void read_next() {
+            if (reading_paused.load()) {
+                read_parked = true;
+                // A private io_context would otherwise run out of work and close the connection
+                if (net.owned_context)
+                    parked_work.emplace(net.context.get_executor());
+                return;
+            }
+            async_read_pooled(net.ssl_socket, recv_buffer,
+                              [&](const asio::error_code &ec, const size_t bytes_received) {
+                                  read_cb(ec, bytes_received);
+                              });
         }
 
         void consume_recv_buffer() {
@@ -1448,12 +1801,7 @@ namespace internetprotocol {
             consume_recv_buffer();
 
             if (close_state == OPEN) {
-                asio::async_read(net.ssl_socket,
-                                 recv_buffer,
-                                 asio::transfer_at_least(1),
-                                 [&](const asio::error_code &ec, const size_t bytes_received) {
-                                     read_cb(ec, bytes_received);
-                                 });
+                read_next();
             }
         }
     };
@@ -14,7 +14,7 @@ using namespace asio::ip;
 namespace internetprotocol {
     class ws_remote_c {
     public:
-        explicit ws_remote_c(asio::io_context &io_context) : idle_timer(io_context), socket(io_context) {
+        explicit ws_remote_c(asio::io_context &io_context) : socket(asio::make_strand(io_context)), idle_timer(io_context, socket.get_executor()) {
             handshake.status_code = 101;
             handshake.status_message = "Switching Protocols";
             handshake.headers.insert_or_assign("Upgrade", "websocket");
@@ -38,6 +38,17 @@ namespace internetprotocol {
          */
         bool is_open() const { return socket.is_open(); }
 
+        /**
+         * Return true once the WebSocket handshake has been answered and frames can be exchanged.
+         *
+         * @par Example
+         * @code
+         * ws_remote_c client;
+         * bool is_upgraded = client.is_upgraded();
+         * @endcode
+         */
+        bool is_upgraded() const { return upgraded.load(); }
+
         /**
          * Get the local endpoint of the socket. Use this function only after open connection.
          *
@@ -63,6 +74,21 @@ namespace internetprotocol {
         /// Just ignore this function
         tcp::socket &get_socket() { return socket; }
 
+        /**
+         * Return the connection id the server gave this client, 0 until it has been accepted.
+         * Unlike the shared_ptr it can be stored anywhere, 'server.find(id)' returns the client while it is connected.
+         *
+         * @par Example
+         * @code
+         * ws_remote_c client;
+         * connection_id_t id = client.get_id();
+         * @endcode
+         */
+        connection_id_t get_id() const { return id; }
+
+        /// Set by the server when the connection is accepted.
+        void set_id(const connection_id_t connection_id) { id = connection_id; }
+
         /**
          * Return a const ref of the latest error code returned by asio.
          *
@@ -98,12 +124,9 @@ namespace internetprotocol {
             dataframe_t frame = dataframe;
             frame.opcode = TEXT_FRAME;
             frame.mask = false;
-            std::string payload = encode_string_payload(message, frame);
-            asio::async_write(socket,
-                              asio::buffer(payload.data(), payload.size()),
-                              [&](const asio::error_code &ec, const size_t bytes_sent) {
-                                  if (callback) callback(ec, bytes_sent);
-                              });
+            std::vector<uint8_t> payload = send_queue.acquire(frame_header_size(message.size(), frame) + message.size());
+            encode_payload(reinterpret_cast<const uint8_t *>(message.data()), message.size(), frame, payload);
+            send_queue.push(std::move(payload), callback);
             return true;
         }
 
@@ -131,12 +154,34 @@ namespace internetprotocol {
             dataframe_t frame = dataframe;
             frame.opcode = BINARY_FRAME;
             frame.mask = false;
-            std::vector<uint8_t> payload = encode_buffer_payload(buffer, frame);
-            asio::async_write(socket,
-                              asio::buffer(payload.data(), payload.size()),
-                              [&](const asio::error_code &ec, const size_t bytes_sent) {
-                                  if (callback) callback(ec, bytes_sent);
-                              });
+            std::vector<uint8_t> payload = send_queue.acquire(frame_header_size(buffer.size(), frame) + buffer.size());
+            encode_payload(buffer.data(), buffer.size(), frame, payload);
+            send_queue.push(std::move(payload), callback);
+            return true;
+        }
+
+        /**
+         * Sends a complete, already encoded frame shared with other connections, without copying it.
+         * Used by the server broadcast, which encodes the frame once for every client.
+         * It returns false if socket is closed or if buffer is empty.
+         *
+         * @param buffer Shared frame to be send. It must be unmasked and must not be modified while queued.
+         *
+         * @param callback An optional callback function may be specified to as a way of reporting DNS errors or for determining when it is safe to reuse the buf object.
+         *
+         * @par Example
+         * @code
+         * ws_remote_c client;
+         *
+         * std::vector<uint8_t> frame;
+         * encode_payload(data, size, dataframe, frame);
+         * client.write_shared(std::make_shared<const std::vector<uint8_t>>(std::move(frame)));
+         * @endcode
+         */
+        bool write_shared(const shared_buffer_t &buffer, const std::function<void(const asio::error_code &, const size_t)> &callback = nullptr) {
+            if (!is_open() || !buffer || buffer->empty() || close_state.load() != OPEN) return false;
+
+            send_queue.push(buffer, callback);
             return true;
         }
 
@@ -157,12 +202,9 @@ namespace internetprotocol {
             dataframe_t dataframe;
             dataframe.opcode = PING;
             dataframe.mask = false;
-            std::vector<uint8_t> payload = encode_buffer_payload({}, dataframe);
-            asio::async_write(socket,
-                              asio::buffer(payload.data(), payload.size()),
-                              [&](const asio::error_code &ec, const size_t bytes_sent) {
-                                  if (callback) callback(ec, bytes_sent);
-                              });
+            std::vector<uint8_t> payload = send_queue.acquire(frame_header_size(0, dataframe));
+            encode_payload(nullptr, 0, dataframe, payload);
+            send_queue.push(std::move(payload), callback);
             return true;
         }
 
@@ -183,12 +225,9 @@ namespace internetprotocol {
             dataframe_t dataframe;
             dataframe.opcode = PONG;
             dataframe.mask = false;
-            std::vector<uint8_t> payload = encode_buffer_payload({}, dataframe);
-            asio::async_write(socket,
-                              asio::buffer(payload.data(), payload.size()),
-                              [&](const asio::error_code &ec, const size_t bytes_sent) {
-                                  if (callback) callback(ec, bytes_sent);
-                              });
+            std::vector<uint8_t> payload = send_queue.acquire(frame_header_size(0, dataframe));
+            encode_payload(nullptr, 0, dataframe, payload);
+            send_queue.push(std::move(payload), callback);
             return true;
         }
 
@@ -196,7 +235,7 @@ namespace internetprotocol {
         void connect() {
             close_state.store(OPEN);
             asio::async_read_until(socket,
-                                   recv_buffer, "\r\n",
+                                   recv_buffer.dynamic(), "\r\n",
                                    [&](const asio::error_code &ec, const size_t bytes_received) {
                                        read_handshake_cb(ec, bytes_received);
                                    });
@@ -218,6 +257,12 @@ namespace internetprotocol {
         void end(const uint16_t code = 1000, const std::string &reason = "") {
             if (close_state.load() == CLOSED) return;
 
+            // A close frame is only valid once the upgrade has been answered
+            if (!upgraded.load()) {
+                close(code, reason);
+                return;
+            }
+
             if (close_state.load() == OPEN) {
                 // Server iniciating close
                 close_state.store(CLOSING);
@@ -246,6 +291,7 @@ namespace internetprotocol {
 
             close_state.store(CLOSED);
             wait_close_frame_response.store(true);
+            idle_timer.cancel();
 
             if (socket.is_open()) {
                 bool is_locked = mutex_error.try_lock();
@@ -267,6 +313,87 @@ namespace internetprotocol {
             }
         }
 
+        /**
+         * Set the send queue watermarks in bytes. 'on_backpressure' is triggered when the bytes waiting to be sent
+         * reach 'high', and 'on_drain' once they fall back to 'low' or below. A 'high' of 0 disables them.
+         *
+         * @param high Queued bytes at which the peer is considered to be falling behind.
+         *
+         * @param low Queued bytes at which writing may resume.
+         *
+         * @par Example
+         * @code
+         * ws_remote_c client;
+         * client.set_watermarks(1024 * 1024, 256 * 1024);
+         * @endcode
+         */
+        void set_watermarks(const size_t high, const size_t low) {
+            send_queue.set_watermarks(high, low,
+                                      [&]() {
+                                          if (on_backpressure)
+                                              on_backpressure();
+                                      },
+                                      [&]() {
+                                          if (on_drain)
+                                              on_drain();
+                                      });
+        }
+
+        /**
+         * Return the number of bytes written and not sent yet.
+         *
+         * @par Example
+         * @code
+         * ws_remote_c client;
+         * size_t queued = client.get_queued_bytes();
+         * @endcode
+         */
+        size_t get_queued_bytes() { return send_queue.queued_bytes(); }
+
+        /**
+         * Stop reading from the socket. The read already in progress still completes,
+         * after that nothing more is received until 'resume_reading()' is called.
+         *
+         * @par Example
+         * @code
+         * ws_remote_c client;
+         * client.pause_reading();
+         * @endcode
+         */
+        void pause_reading() { reading_paused.store(true); }
+
+        /**
+         * Start reading from the socket again after 'pause_reading()'.
+         *
+         * @par Example
+         * @code
+         * ws_remote_c client;
+         * client.resume_reading();
+         * @endcode
+         */
+        void resume_reading() {
+            reading_paused.store(false);
+            asio::post(socket.get_executor(), [&]() {
+                if (!read_parked)
+                    return;
+
+                read_parked = false;
+                if (close_state.load() != CLOSED)
+                    read_next();
+            });
+        }
+
+        /**
+         * Return true if reading has been paused with 'pause_reading()'.
+         *
+         * @par Example
+         * @code
+         * ws_remote_c client;
+         * bool paused = client.is_reading_paused();
+         * @endcode
+         */
+        bool is_reading_paused() const { return reading_paused.load(); }
+
         /**
          * Adds the listener function to 'on_connected'.
          * This event will be triggered when socket start to listening.
@@ -337,6 +464,35 @@ namespace internetprotocol {
          */
         std::function<void()> on_pong;
 
+        /**
+         * Adds the listener function to 'on_backpressure'.
+         * This event will be triggered when the bytes waiting to be sent reach the high watermark, see 'set_watermarks()'.
+         * It runs on the thread that wrote the message.
+         *
+         * @par Example
+         * @code
+         * ws_remote_c client;
+         * client.on_backpressure = [&]() {
+         *      // stop writing until 'on_drain'...
+         * };
+         * @endcode
+         */
+        std::function<void()> on_backpressure;
+
+        /**
+         * Adds the listener function to 'on_drain'.
+         * This event will be triggered when the bytes waiting to be sent fall back to the low watermark after 'on_backpressure'.
+         *
+         * @par Example
+         * @code
+         * ws_remote_c client;
+         * client.on_drain = [&]() {
+         *      // your code...
+         * };
+         * @endcode
+         */
+        std::function<void()> on_drain;
+
         /**
          * Adds the listener function to 'on_close'.
          * This event will be triggered when socket is closed.
@@ -366,22 +522,26 @@ namespace internetprotocol {
         std::function<void(const asio::error_code &)> on_error;
 
     private:
+        connection_id_t id = 0;
         std::mutex mutex_error;
         std::atomic<close_state_e> close_state = CLOSED;
         std::atomic<bool> wait_close_frame_response = true;
-        asio::steady_timer idle_timer;
+        std::atomic<bool> reading_paused = false;
+        bool read_parked = false;
         tcp::socket socket;
+        send_queue_c<tcp::socket> send_queue{socket};
+        wheel_timer_c idle_timer;
         asio::error_code error_code;
-        asio::streambuf recv_buffer;
+        pooled_streambuf_c recv_buffer{buffer_pool_c::get(socket.get_executor())};
         http_response_t handshake;
         bool close_frame_sent = false;
+        // Set once the 101 response has been sent
+        std::atomic<bool> upgraded = false;
+        // A read of the frame loop is in flight
+        bool read_pending = false;
 
         void start_idle_timer() {
-            idle_timer.expires_after(std::chrono::seconds(5));
-            idle_timer.async_wait([&](const asio::error_code &ec) {
-                if (ec == asio::error::operation_aborted)
-                    return;
-
+            idle_timer.start(std::chrono::seconds(5), [&]() {
                 if (close_state.load() == CLOSED)
                     return;
 
@@ -411,12 +571,12 @@ namespace internetprotocol {
                 close_payload.insert(close_payload.end(), reason.begin(), reason.end());
             }
 
-            std::vector<uint8_t> encoded_payload = encode_buffer_payload(close_payload, dataframe);
-            asio::async_write(socket,
-                              asio::buffer(encoded_payload.data(), encoded_payload.size()),
-                              [this, code, reason](const asio::error_code &ec, const size_t bytes_sent) {
-                                  close_frame_sent_cb(ec, bytes_sent, code, reason);
-                              });
+            std::vector<uint8_t> encoded_payload = send_queue.acquire(frame_header_size(close_payload.size(), dataframe) + close_payload.size());
+            encode_payload(close_payload.data(), close_payload.size(), dataframe, encoded_payload);
+            send_queue.push(std::move(encoded_payload),
+                            [this, code, reason](const asio::error_code &ec, const size_t bytes_sent) {
+                                close_frame_sent_cb(ec, bytes_sent, code, reason);
+                            });
         }
 
         // Callback for close frame sent
@@ -426,7 +586,8 @@ namespace internetprotocol {
                 std::lock_guard lock(mutex_error);
                 error_code = error;
                 if (on_error) on_error(error);
-                close();
+                close(code, reason);
+                return;
             }
 
             if (!wait_close_frame_response.load()) {
@@ -434,12 +595,8 @@ namespace internetprotocol {
                 return;
             }
             start_idle_timer();
-            asio::async_read(socket,
-                                recv_buffer,
-                                asio::transfer_at_least(1),
-                                [&](const asio::error_code &ec, const size_t bytes_recvd) {
-                                    read_cb(ec, bytes_recvd);
-                                });
+            // The read loop may still have a read pending, a second one would race it
+            arm_read();
         }
 
         void read_handshake_cb(const asio::error_code &error, const size_t bytes_recvd) {
@@ -496,7 +653,7 @@ namespace internetprotocol {
 
             recv_buffer.consume(2);
             asio::async_read_until(socket,
-                                   recv_buffer, "\r\n\r\n",
+                                   recv_buffer.dynamic(), "\r\n\r\n",
                                    std::bind(&ws_remote_c::read_headers, this, asio::placeholders::error, request));
         }
 
@@ -552,14 +709,31 @@ namespace internetprotocol {
                 return;
             }
 
+            upgraded.store(true);
             if (on_connected) on_connected(request);
 
-            asio::async_read(socket,
-                             recv_buffer,
-                             asio::transfer_at_least(1),
-                             [&](const asio::error_code &ec, const size_t bytes_recvd) {
-                                 read_cb(ec, bytes_recvd);
-                             });
+            arm_read();
+        }
+
+        // Re-arm the read unless reading is paused, in which case 'resume_reading()' does it
+        void read_next() {
+            if (reading_paused.load()) {
+                read_parked = true;
+                return;
+            }
+            arm_read();
+        }
+
+        // Start the next read of the frame loop, unless one is already pending
+        void arm_read() {
+            if (read_pending)
+                return;
+
+            read_pending = true;
+            async_read_pooled(socket, recv_buffer,
+                              [&](const asio::error_code &ec, const size_t bytes_recvd) {
+                                  read_cb(ec, bytes_recvd);
+                              });
         }
 
         void consume_recv_buffer() {
@@ -569,6 +743,7 @@ namespace internetprotocol {
         }
 
         void read_cb(const asio::error_code &error, std::size_t bytes_recvd) {
+            read_pending = false;
             if (error) {
                 std::lock_guard lock(mutex_error);
                 consume_recv_buffer();
@@ -633,13 +808,9 @@ namespace internetprotocol {
 
             consume_recv_buffer();
 
-            if (close_state == OPEN) {
-                asio::async_read(socket,
-                                 recv_buffer,
-                                 asio::transfer_at_least(1),
-                                 [&](const asio::error_code &ec, const size_t bytes_received) {
-                                     read_cb(ec, bytes_received);
-                                 });
+            // Keep reading while closing, the peer answers the close frame
+            if (close_state.load() != CLOSED) {
+                read_next();
             }
         }
     };
@@ -647,7 +818,7 @@ namespace internetprotocol {
 #ifdef ENABLE_SSL
     class ws_remote_ssl_c {
     public:
-        explicit ws_remote_ssl_c(asio::io_context &io_context, asio::ssl::context &ssl_context) : ssl_socket(io_context, ssl_context), idle_timer(io_context) {
+        explicit ws_remote_ssl_c(asio::io_context &io_context, asio::ssl::context &ssl_context) : ssl_socket(asio::make_strand(io_context), ssl_context), idle_timer(io_context, ssl_socket.get_executor()) {
             handshake.status_code = 101;
             handshake.status_message = "Switching Protocols";
             handshake.headers.insert_or_assign("Upgrade", "websocket");
@@ -671,6 +842,17 @@ namespace internetprotocol {
          */
         bool is_open() const { return ssl_socket.next_layer().is_open(); }
 
+        /**
+         * Return true once the WebSocket handshake has been answered and frames can be exchanged.
+         *
+         * @par Example
+         * @code
+         * ws_remote_ssl_c client;
+         * bool is_upgraded = client.is_upgraded();
+         * @endcode
+         */
+        bool is_upgraded() const { return upgraded.load(); }
+
         /**
          * Get the local endpoint of the socket. Use this function only after open connection.
          *
@@ -696,6 +878,21 @@ namespace internetprotocol {
         /// Just ignore this function
         asio::ssl::stream<tcp::socket> &get_socket() { return ssl_socket; }
 
+        /**
+         * Return the connection id the server gave this client, 0 until it has been accepted.
+         * Unlike the shared_ptr it can be stored anywhere, 'server.find(id)' returns the client while it is connected.
+         *
+         * @par Example
+         * @code
+         * ws_remote_ssl_c client;
+         * connection_id_t id = client.get_id();
+         * @endcode
+         */
+        connection_id_t get_id() const { return id; }
+
+        /// Set by the server when the connection is accepted.
+        void set_id(const connection_id_t connection_id) { id = connection_id; }
+
         /**
          * Return a const ref of the latest error code returned by asio.
          *
@@ -731,12 +928,9 @@ namespace internetprotocol {
             dataframe_t frame = dataframe;
             frame.opcode = TEXT_FRAME;
             frame.mask = false;
-            std::string payload = encode_string_payload(message, frame);
-            asio::async_write(ssl_socket,
-                              asio::buffer(payload.data(), payload.size()),
-                              [&](const asio::error_code &ec, const size_t bytes_sent) {
-                                  if (callback) callback(ec, bytes_sent);
-                              });
+            std::vector<uint8_t> payload = send_queue.acquire(frame_header_size(message.size(), frame) + message.size());
+            encode_payload(reinterpret_cast<const uint8_t *>(message.data()), message.size(), frame, payload);
+            send_queue.push(std::move(payload), callback);
             return true;
         }
 
@@ -764,12 +958,34 @@ namespace internetprotocol {
             dataframe_t frame = dataframe;
             frame.opcode = BINARY_FRAME;
             frame.mask = false;
-            std::vector<uint8_t> payload = encode_buffer_payload(buffer, frame);
-            asio::async_write(ssl_socket,
-                              asio::buffer(payload.data(), payload.size()),
-                              [&](const asio::error_code &ec, const size_t bytes_sent) {
-                                  if (callback) callback(ec, bytes_sent);
-                              });
+            std::vector<uint8_t> payload = send_queue.acquire(frame_header_size(buffer.size(), frame) + buffer.size());
+            encode_payload(buffer.data(), buffer.size(), frame, payload);
+            send_queue.push(std::move(payload), callback);
+            return true;
+        }
+
+        /**
+         * Sends a complete, already encoded frame shared with other connections, without copying it.
+         * Used by the server broadcast, which encodes the frame once for every client.
+         * It returns false if socket is closed or if buffer is empty.
+         *
+         * @param buffer Shared frame to be send. It must be unmasked and must not be modified while queued.
+         *
+         * @param callback An optional callback function may be specified to as a way of reporting DNS errors or for determining when it is safe to reuse the buf object.
+         *
+         * @par Example
+         * @code
+         * ws_remote_ssl_c client;
+         *
+         * std::vector<uint8_t> frame;
+         * encode_payload(data, size, dataframe, frame);
+         * client.write_shared(std::make_shared<const std::vector<uint8_t>>(std::move(frame)));
+         * @endcode
+         */
+        bool write_shared(const shared_buffer_t &buffer, const std::function<void(const asio::error_code &, const size_t)> &callback = nullptr) {
+            if (!is_open() || !buffer || buffer->empty() || close_state.load() != OPEN) return false;
+
+            send_queue.push(buffer, callback);
             return true;
         }
 
@@ -790,12 +1006,9 @@ namespace internetprotocol {
             dataframe_t dataframe;
             dataframe.opcode = PING;
             dataframe.mask = false;
-            std::vector<uint8_t> payload = encode_buffer_payload({}, dataframe);
-            asio::async_write(ssl_socket,
-                              asio::buffer(payload.data(), payload.size()),
-                              [&](const asio::error_code &ec, const size_t bytes_sent) {
-                                  if (callback) callback(ec, bytes_sent);
-                              });
+            std::vector<uint8_t> payload = send_queue.acquire(frame_header_size(0, dataframe));
+            encode_payload(nullptr, 0, dataframe, payload);
+            send_queue.push(std::move(payload), callback);
             return true;
         }
 
@@ -816,12 +1029,9 @@ namespace internetprotocol {
             dataframe_t dataframe;
             dataframe.opcode = PONG;
             dataframe.mask = false;
-            std::vector<uint8_t> payload = encode_buffer_payload({}, dataframe);
-            asio::async_write(ssl_socket,
-                              asio::buffer(payload.data(), payload.size()),
-                              [&](const asio::error_code &ec, const size_t bytes_sent) {
-                                  if (callback) callback(ec, bytes_sent);
-                              });
+            std::vector<uint8_t> payload = send_queue.acquire(frame_header_size(0, dataframe));
+            encode_payload(nullptr, 0, dataframe, payload);
+            send_queue.push(std::move(payload), callback);
             return true;
         }
 
@@ -850,6 +1060,12 @@ namespace internetprotocol {
         void end(const uint16_t code = 1000, const std::string &reason = "") {
             if (close_state.load() == CLOSED) return;
 
+            // A close frame is only valid once the upgrade has been answered
+            if (!upgraded.load()) {
+                close(code, reason);
+                return;
+            }
+
             if (close_state.load() == OPEN) {
                 // Server iniciating close
                 close_state.store(CLOSING);
@@ -878,6 +1094,7 @@ namespace internetprotocol {
 
             close_state.store(CLOSED);
             wait_close_frame_response.store(true);
+            idle_timer.cancel();
 
             if (ssl_socket.next_layer().is_open()) {
                 bool is_locked = mutex_error.try_lock();
@@ -905,6 +1122,87 @@ namespace internetprotocol {
             }
         }
 
+        /**
+         * Set the send queue watermarks in bytes. 'on_backpressure' is triggered when the bytes waiting to be sent
+         * reach 'high', and 'on_drain' once they fall back to 'low' or below. A 'high' of 0 disables them.
+         *
+         * @param high Queued bytes at which the peer is considered to be falling behind.
+         *
+         * @param low Queued bytes at which writing may resume.
+         *
+         * @par Example
+         * @code
+         * ws_remote_ssl_c client;
+         * client.set_watermarks(1024 * 1024, 256 * 1024);
+         * @endcode
+         */
+        void set_watermarks(const size_t high, const size_t low) {
+            send_queue.set_watermarks(high, low,
+                                      [&]() {
+                                          if (on_backpressure)
+                                              on_backpressure();
+                                      },
+                                      [&]() {
+                                          if (on_drain)
+                                              on_drain();
+                                      });
+        }
+
+        /**
+         * Return the number of bytes written and not sent yet.
+         *
+         * @par Example
+         * @code
+         * ws_remote_ssl_c client;
+         * size_t queued = client.get_queued_bytes();
+         * @endcode
+         */
+        size_t get_queued_bytes() { return send_queue.queued_bytes(); }
+
+        /**
+         * Stop reading from the socket. The read already in progress still completes,
+         * after that nothing more is received until 'resume_reading()' is called.
+         *
+         * @par Example
+         * @code
+         * ws_remote_ssl_c client;
+         * client.pause_reading();
+         * @endcode
+         */
+        void pause_reading() { reading_paused.store(true); }
+
+        /**
+         * Start reading from the socket again after 'pause_reading()'.
+         *
+         * @par Example
+         * @code
+         * ws_remote_ssl_c client;
+         * client.resume_reading();
+         * @endcode
+         */
+        void resume_reading() {
+            reading_paused.store(false);
+            asio::post(ssl_socket.get_executor(), [&]() {
+                if (!read_parked)
+                    return;
+
+                read_parked = false;
+                if (close_state.load() != CLOSED)
+                    read_next();
+            });
+        }
+
+        /**
+         * Return true if reading has been paused with 'pause_reading()'.
+         *
+         * @par Example
+         * @code
+         * ws_remote_ssl_c client;
+         * bool paused = client.is_reading_paused();
+         * @endcode
+         */
+        bool is_reading_paused() const { return reading_paused.load(); }
+
         /**
          * Adds the listener function to 'on_connected'.
          * This event will be triggered when socket start to listening.
@@ -975,6 +1273,35 @@ namespace internetprotocol {
          */
         std::function<void()> on_pong;
 
+        /**
+         * Adds the listener function to 'on_backpressure'.
+         * This event will be triggered when the bytes waiting to be sent reach the high watermark, see 'set_watermarks()'.
+         * It runs on the thread that wrote the message.
+         *
+         * @par Example
+         * @code
+         * ws_remote_ssl_c client;
+         * client.on_backpressure = [&]() {
+         *      // stop writing until 'on_drain'...
+         * };
+         * @endcode
+         */
+        std::function<void()> on_backpressure;
+
+        /**
+         * Adds the listener function to 'on_drain'.
+         * This event will be triggered when the bytes waiting to be sent fall back to the low watermark after 'on_backpressure'.
+         *
+         * @par Example
+         * @code
+         * ws_remote_ssl_c client;
+         * client.on_drain = [&]() {
+         *      // your code...
+         * };
+         * @endcode
+         */
+        std::function<void()> on_drain;
+
         /**
          * Adds the listener function to 'on_close'.
          * This event will be triggered when socket is closed.
@@ -1004,22 +1331,26 @@ namespace internetprotocol {
         std::function<void(const asio::error_code &)> on_error;
 
     private:
+        connection_id_t id = 0;
         std::mutex mutex_error;
         std::atomic<close_state_e> close_state = CLOSED;
         std::atomic<bool> wait_close_frame_response = true;
-        asio::steady_timer idle_timer;
+        std::atomic<bool> reading_paused = false;
+        bool read_parked = false;
         asio::ssl::stream<tcp::socket> ssl_socket;
+        send_queue_c<asio::ssl::stream<tcp::socket>> send_queue{ssl_socket, true};
+        wheel_timer_c idle_timer;
         asio::error_code error_code;
-        asio::streambuf recv_buffer;
+        pooled_streambuf_c recv_buffer{buffer_pool_c::get(ssl_socket.get_executor())};
         http_response_t handshake;
         bool close_frame_sent = false;
+        // Set once the 101 response has been sent
+        std::atomic<bool> upgraded = false;
+        // A read of the frame loop is in flight
+        bool read_pending = false;
 
         void start_idle_timer() {
-            idle_timer.expires_after(std::chrono::seconds(5));
-            idle_timer.async_wait([&](const asio::error_code &ec) {
-                if (ec == asio::error::operation_aborted)
-                    return;
-
+            idle_timer.start(std::chrono::seconds(5), [&]() {
                 if (close_state.load() == CLOSED)
                     return;
 
@@ -1049,12 +1380,12 @@ namespace internetprotocol {
                 close_payload.insert(close_payload.end(), reason.begin(), reason.end());
             }
 
-            std::vector<uint8_t> encoded_payload = encode_buffer_payload(close_payload, dataframe);
-            asio::async_write(ssl_socket,
-                              asio::buffer(encoded_payload.data(), encoded_payload.size()),
-                              [this, code, reason](const asio::error_code &ec, const size_t bytes_sent) {
-                                  close_frame_sent_cb(ec, bytes_sent, code, reason);
-                              });
+            std::vector<uint8_t> encoded_payload = send_queue.acquire(frame_header_size(close_payload.size(), dataframe) + close_payload.size());
+            encode_payload(close_payload.data(), close_payload.size(), dataframe, encoded_payload);
+            send_queue.push(std::move(encoded_payload),
+                            [this, code, reason](const asio::error_code &ec, const size_t bytes_sent) {
+                                close_frame_sent_cb(ec, bytes_sent, code, reason);
+                            });
         }
 
         // Callback for close frame sent
@@ -1064,6 +1395,8 @@ namespace internetprotocol {
                 std::lock_guard lock(mutex_error);
                 error_code = error;
                 if (on_error) on_error(error);
+                close(code, reason);
+                return;
             }
 
             if (!wait_close_frame_response.load()) {
@@ -1071,12 +1404,8 @@ namespace internetprotocol {
                 return;
             }
             start_idle_timer();
-            asio::async_read(ssl_socket,
-                                recv_buffer,
-                                asio::transfer_at_least(1),
-                                [&](const asio::error_code &ec, const size_t bytes_recvd) {
-                                    read_cb(ec, bytes_recvd);
-                                });
+            // The read loop may still have a read pending, a second one would race it
+            arm_read();
         }
 
         void ssl_handshake(const asio::error_code &error) {
@@ -1089,7 +1418,7 @@ namespace internetprotocol {
             }
 
             asio::async_read_until(ssl_socket,
-                                   recv_buffer, "\r\n",
+                                   recv_buffer.dynamic(), "\r\n",
                                    [&](const asio::error_code &ec, const size_t bytes_received) {
                                        read_handshake_cb(ec, bytes_received);
                                    });
@@ -1149,7 +1478,7 @@ namespace internetprotocol {
 
             recv_buffer.consume(2);
             asio::async_read_until(ssl_socket,
-                                   recv_buffer, "\r\n\r\n",
+                                   recv_buffer.dynamic(), "\r\n\r\n",
                                    std::bind(&ws_remote_ssl_c::read_headers, this, asio::placeholders::error, request));
         }
 
@@ -1205,14 +1534,31 @@ namespace internetprotocol {
                 return;
             }
 
+            upgraded.store(true);
             if (on_connected) on_connected(request);
 
-            asio::async_read(ssl_socket,
-                             recv_buffer,
-                             asio::transfer_at_least(1),
-                             [&](const asio::error_code &ec, const size_t bytes_recvd) {
-                                 read_cb(ec, bytes_recvd);
-                             });
+            arm_read();
+        }
+
+        // Re-arm the read unless reading is paused, in which case 'resume_reading()' does it
+        void read_next() {
+            if (reading_paused.load()) {
+                read_parked = true;
+                return;
+            }
+            arm_read();
+        }
+
+        // Start the next read of the frame loop, unless one is already pending
+        void arm_read() {
+            if (read_pending)
+                return;
+
+            read_pending = true;
+            async_read_pooled(ssl_socket, recv_buffer,
+                              [&](const asio::error_code &ec, const size_t bytes_recvd) {
+                                  read_cb(ec, bytes_recvd);
+                              });
         }
 
         void consume_recv_buffer() {
@@ -1222,6 +1568,7 @@ namespace internetprotocol {
         }
 
         void read_cb(const asio::error_code &error, std::size_t bytes_recvd) {
+            read_pending = false;
             if (error) {
                 std::lock_guard lock(mutex_error);
                 consume_recv_buffer();
@@ -1286,13 +1633,9 @@ namespace internetprotocol {
 
             consume_recv_buffer();
 
-            if (close_state == OPEN) {
-                asio::async_read(ssl_socket,
-                                 recv_buffer,
-                                 asio::transfer_at_least(1),
-                                 [&](const asio::error_code &ec, const size_t bytes_received) {
-                                     read_cb(ec, bytes_received);
-                                 });
+            // Keep reading while closing, the peer answers the close frame
+            if (close_state.load() != CLOSED) {
+                read_next();
             }
         }
     };
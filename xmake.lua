@@ -1,20 +1,36 @@
 add_rules("mode.debug", "mode.release")
 set_languages("c++17")
 
+option("io_uring")
+    set_default(false)
+    set_showmenu(true)
+    set_description("Use the asio io_uring backend for all socket I/O (Linux only, requires liburing)")
+option_end()
+
 add_requires("asio")
 add_requires("openssl3")
+if has_config("io_uring") then
+    add_requires("liburing")
+end
 
 target("InternetProtocol")
     set_kind("headeronly")
     add_includedirs("include/", {public = true})
     add_headerfiles("include/**.hpp")
     add_packages("asio", "openssl3")
+    if has_config("io_uring") then
+        add_defines("ASIO_HAS_IO_URING", "ASIO_DISABLE_EPOLL", {public = true})
+        add_packages("liburing", {public = true})
+    end
 
 target("example")
     set_kind("binary")
     add_files("src/*.cpp")
     add_deps("InternetProtocol")
     add_packages("asio", "openssl3")
+    if has_config("io_uring") then
+        add_packages("liburing")
+    end
 
 --
 -- If you want to known more usage about xmake, please see https://xmake.io